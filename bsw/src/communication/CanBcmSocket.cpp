@@ -0,0 +1,206 @@
+/**
+ * \file      CanBcmSocket.cpp
+ * \author    dtuchscherer <daniel.tuchscherer@gmail.com>
+ * \brief     SocketCAN broadcast manager (CAN_BCM)
+ * \details   These are the methods of class CanBcmSocket to set up cyclic
+ *            transmissions and content filters in the Linux kernel.
+ * \copyright Copyright (c) 2018, Daniel Tuchscherer.
+ *            All rights reserved.
+ *
+ *            Redistributions and use in source and binary forms, with
+ *            or without modifications, are permitted provided that the
+ *            following conditions are met: Redistributions of source code must
+ *            retain the above copyright notice, this list of conditions and the
+ *            following disclaimer.
+ *
+ *            Redistributions in binary form must reproduce the above copyright
+ *            notice, this list of conditions and the following disclaimer in
+ *            the documentation and/or other materials provided with the
+ *            distribution.
+ *
+ *            Neither the name of the Heilbronn University nor the name of its
+ *            contributors may be used to endorse or promote products derived
+ *            from this software without specific prior written permission.
+ *
+ *            THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS “AS IS”
+ *            AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ *            TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ *            PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE REGENTS
+ *            OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *            SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *            LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *            USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *            AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *            LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *            ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *            POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef _WIN32
+#error "SocketCAN for Linux OS only."
+#endif
+#include "CanBcmSocket.h"
+
+////////////////////////////////////////////////////////////////////////////////
+bool CanBcmSocket::create() noexcept
+{
+    bool socket_created{false};
+    socket_ = socket(PF_CAN, SOCK_DGRAM, CAN_BCM);
+
+    // check here if the socket was opened.
+    if (get_socket_handle() > 0)
+    {
+        socket_created = true;
+    }
+    else
+    {
+        last_error_ = errno;
+        socket_created = false;
+    }
+
+    return socket_created;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool CanBcmSocket::stop_cyclic(const CanIDType can_id, const bool canfd) noexcept
+{
+    struct bcm_msg_head head = make_head(TX_DELETE, can_id, 0U);
+    head.flags = canfd ? CAN_FD_FRAME : 0U;
+    return write_message(head, nullptr, 0U);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool CanBcmSocket::unwatch(const CanIDType can_id, const bool canfd) noexcept
+{
+    struct bcm_msg_head head = make_head(RX_DELETE, can_id, 0U);
+    head.flags = canfd ? CAN_FD_FRAME : 0U;
+    return write_message(head, nullptr, 0U);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::int8_t CanBcmSocket::receive(CanIDType& can_id, CanFDData& data,
+                                  BcmEvent& event) noexcept
+{
+    std::int8_t received{-1};
+
+    if (is_bcm_initialized())
+    {
+        MessageBuffer buffer;
+        const auto socket = get_socket_handle();
+        const ssize_t nbytes = read(socket, buffer.data(), buffer.size());
+
+        if (nbytes >= static_cast< ssize_t >(sizeof(struct bcm_msg_head)))
+        {
+            struct bcm_msg_head head;
+            std::memcpy(&head, buffer.data(), sizeof(head));
+            can_id = head.can_id;
+            received = 0;
+
+            switch (head.opcode)
+            {
+            case RX_CHANGED:
+                event = BcmEvent::CHANGED;
+                break;
+            case RX_TIMEOUT:
+                event = BcmEvent::TIMEOUT;
+                break;
+            case TX_EXPIRED:
+                event = BcmEvent::EXPIRED;
+                break;
+            default:
+                event = BcmEvent::OTHER;
+                break;
+            }
+
+            const auto frame_bytes =
+                static_cast< std::size_t >(nbytes) - sizeof(head);
+
+            if ((head.nframes > 0U) &&
+                (frame_bytes >= sizeof(struct can_frame)))
+            {
+                // a standard CAN frame has the same layout as the beginning
+                // of a CAN FD frame.
+                struct canfd_frame frame;
+                std::memset(&frame, 0, sizeof(frame));
+                std::memcpy(&frame, buffer.data() + sizeof(head),
+                            std::min(frame_bytes, sizeof(frame)));
+                const auto available =
+                    frame_bytes - offsetof(struct canfd_frame, data);
+                const auto len = std::min(
+                    {static_cast< std::size_t >(frame.len), data.size(),
+                     available});
+                std::copy(frame.data, frame.data + len, data.begin());
+                received = static_cast< std::int8_t >(len);
+            }
+        }
+        else
+        {
+            last_error_ = errno;
+            received = -1;
+        }
+    }
+
+    return received;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool CanBcmSocket::write_message(const struct bcm_msg_head& head,
+                                 const struct canfd_frame* frame,
+                                 const std::size_t frame_size) noexcept
+{
+    bool written{false};
+
+    if (is_bcm_initialized())
+    {
+        MessageBuffer buffer;
+        std::memcpy(buffer.data(), &head, sizeof(head));
+
+        if (frame != nullptr)
+        {
+            std::memcpy(buffer.data() + sizeof(head), frame, frame_size);
+        }
+
+        const auto size = sizeof(head) + ((frame != nullptr) ? frame_size : 0U);
+        const auto socket = get_socket_handle();
+        const ssize_t nbytes = write(socket, buffer.data(), size);
+
+        if (nbytes == static_cast< ssize_t >(size))
+        {
+            written = true;
+        }
+        else
+        {
+            last_error_ = errno;
+            written = false;
+        }
+    }
+
+    return written;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool CanBcmSocket::connect_if_socket(const unsigned int ifindex) noexcept
+{
+    bool connected{false};
+    struct sockaddr_can address;
+    std::memset(&address, 0, sizeof(address));
+    address.can_family = AF_CAN;
+    address.can_ifindex = static_cast< int >(ifindex);
+
+    const auto handle = get_socket_handle();
+    const int connect_res =
+        connect(handle, (struct sockaddr*)&address, sizeof(address));
+
+    if (connect_res < 0)
+    {
+        last_error_ = errno;
+        connected = false;
+        std::cerr << "Connecting the BCM socket to the interface failed.\n";
+    }
+    else
+    {
+        connected = true;
+    }
+
+    return connected;
+}
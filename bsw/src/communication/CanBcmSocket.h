@@ -0,0 +1,366 @@
+/**
+ * \file      CanBcmSocket.h
+ * \author    dtuchscherer <daniel.tuchscherer@gmail.com>
+ * \brief     SocketCAN broadcast manager (CAN_BCM)
+ * \details   Hands cyclic transmissions and content-change filters of CAN
+ *            frames over to the Linux kernel.
+ * \copyright Copyright (c) 2018, Daniel Tuchscherer.
+ *            All rights reserved.
+ *
+ *            Redistributions and use in source and binary forms, with
+ *            or without modifications, are permitted provided that the
+ *            following conditions are met: Redistributions of source code must
+ *            retain the above copyright notice, this list of conditions and the
+ *            following disclaimer.
+ *
+ *            Redistributions in binary form must reproduce the above copyright
+ *            notice, this list of conditions and the following disclaimer in
+ *            the documentation and/or other materials provided with the
+ *            distribution.
+ *
+ *            Neither the name of the Heilbronn University nor the name of its
+ *            contributors may be used to endorse or promote products derived
+ *            from this software without specific prior written permission.
+ *
+ *            THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS “AS IS”
+ *            AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ *            TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ *            PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE REGENTS
+ *            OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *            SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *            LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *            USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *            AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *            LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *            ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *            POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CANBCMSOCKET_H_
+#define CANBCMSOCKET_H_
+#ifndef _WIN32
+
+#include "CanSocket.h" // CAN data types
+#include "Socket.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <linux/can.h>
+#include <linux/can/bcm.h>
+#include <net/if.h>
+#include <type_traits>
+#include <unistd.h>
+#include <utility>
+
+/**
+ * \brief What the broadcast manager reports for a watched CAN identifier.
+ */
+enum class BcmEvent
+{
+    /// the content of the frame changed (RX_CHANGED).
+    CHANGED,
+    /// the cyclic frame was not received in time (RX_TIMEOUT).
+    TIMEOUT,
+    /// a transmission of start_counted() has finished (TX_EXPIRED).
+    EXPIRED,
+    /// any other message of the broadcast manager.
+    OTHER
+};
+
+/**
+ * \brief CAN broadcast manager socket.
+ * \details Cyclic frames are sent by the kernel with its high resolution
+ * timers, no thread has to wake up for that. The content of a cyclic frame
+ * can be updated at any time and goes out with the next cycle.
+ * Receivers subscribe to identifiers with a mask of the relevant data bits.
+ * The kernel wakes them up only if these bits change or if the frame is
+ * missing for longer than a timeout, not on every repetition.
+ */
+class CanBcmSocket : public Socket< CanBcmSocket >
+{
+  public:
+    /**
+     * \brief Opens a broadcast manager socket on the interface.
+     * \param[in] interface_str interface name, e.g. "can0", "vcan0"
+     */
+    template < std::size_t N >
+    explicit CanBcmSocket(const char (&interface_str)[N]) noexcept
+        : Socket{}, bcm_init_{false}
+    {
+        if (is_socket_initialized())
+        {
+            const auto ifindex = if_nametoindex(interface_str);
+
+            if (ifindex != 0U)
+            {
+                bcm_init_ = connect_if_socket(ifindex);
+            }
+            else
+            {
+                std::cerr << "CAN interface " << interface_str
+                          << " you've specified is not found!\n";
+            }
+        }
+    }
+
+    /**
+     * \brief Create the BCM socket; this is called by the base class.
+     * \return true if the socket is opened or false if there was an error.
+     */
+    bool create() noexcept;
+
+    /**
+     * \brief Checks if the socket is connected to the interface.
+     */
+    bool is_bcm_initialized() const noexcept { return bcm_init_; }
+
+    /**
+     * \brief Starts sending a frame cyclically by the kernel. Calling this
+     * again for the same identifier replaces the frame and the interval.
+     * \tparam CANData standard CAN or CAN FD data.
+     * \param[in] can_id CAN identifier of the frame.
+     * \param[in] data the payload.
+     * \param[in] len the length of the payload.
+     * \param[in] interval the cycle time.
+     * \return true if the kernel accepted the job.
+     */
+    template < typename CANData, typename Duration >
+    bool start_cyclic(const CanIDType can_id, const CANData& data,
+                      const std::uint8_t len, const Duration& interval) noexcept
+    {
+        struct bcm_msg_head head = make_head(TX_SETUP, can_id, 1U);
+        head.flags = SETTIMER | STARTTIMER | TX_ANNOUNCE;
+        head.ival2 = to_bcm_timeval(interval);
+        return write_message< CANData >(head, can_id, data.data(),
+                                        std::min< std::size_t >(len,
+                                                                data.size()));
+    }
+
+    /**
+     * \brief Sends a frame a limited number of times by the kernel, e.g. a
+     * burst on a wake-up. Once the last frame is sent, receive() on this
+     * socket reports BcmEvent::EXPIRED for the identifier.
+     * \tparam CANData standard CAN or CAN FD data.
+     * \param[in] can_id CAN identifier of the frame.
+     * \param[in] data the payload.
+     * \param[in] len the length of the payload.
+     * \param[in] count the number of frames to send.
+     * \param[in] interval the time between two frames.
+     * \return true if the kernel accepted the job.
+     */
+    template < typename CANData, typename Duration >
+    bool start_counted(const CanIDType can_id, const CANData& data,
+                       const std::uint8_t len, const std::uint32_t count,
+                       const Duration& interval) noexcept
+    {
+        struct bcm_msg_head head = make_head(TX_SETUP, can_id, 1U);
+        head.flags = SETTIMER | STARTTIMER | TX_COUNTEVT;
+        head.count = count;
+        head.ival1 = to_bcm_timeval(interval);
+        return write_message< CANData >(head, can_id, data.data(),
+                                        std::min< std::size_t >(len,
+                                                                data.size()));
+    }
+
+    /**
+     * \brief Replaces the payload of a cyclic frame. It goes out with the
+     * next cycle, the timing does not change.
+     * \return true if the kernel accepted the new content.
+     */
+    template < typename CANData >
+    bool update_cyclic(const CanIDType can_id, const CANData& data,
+                       const std::uint8_t len) noexcept
+    {
+        const struct bcm_msg_head head = make_head(TX_SETUP, can_id, 1U);
+        return write_message< CANData >(head, can_id, data.data(),
+                                        std::min< std::size_t >(len,
+                                                                data.size()));
+    }
+
+    /**
+     * \brief Stops a cyclic transmission.
+     * \param[in] can_id CAN identifier of the frame.
+     * \param[in] canfd true if it was started with CAN FD data.
+     * \return true if the job was removed.
+     */
+    bool stop_cyclic(const CanIDType can_id, const bool canfd = false) noexcept;
+
+    /**
+     * \brief Subscribes to a CAN identifier. receive() returns the frame
+     * only if one of the bits set in mask or the length changes.
+     * \param[in] can_id CAN identifier to watch.
+     * \param[in] mask the relevant bits of the payload.
+     * \param[in] len the number of bytes of the mask.
+     * \return true if the subscription is set up.
+     */
+    template < typename CANData >
+    bool watch(const CanIDType can_id, const CANData& mask,
+               const std::uint8_t len) noexcept
+    {
+        return watch(can_id, mask, len, std::chrono::microseconds{0});
+    }
+
+    /**
+     * \brief Subscribes to a CAN identifier and additionally reports a
+     * timeout if the frame is not received within the given time, e.g. to
+     * supervise a cyclic sender.
+     * \param[in] can_id CAN identifier to watch.
+     * \param[in] mask the relevant bits of the payload.
+     * \param[in] len the number of bytes of the mask.
+     * \param[in] timeout the supervision time, zero disables it.
+     * \return true if the subscription is set up.
+     */
+    template < typename CANData, typename Duration >
+    bool watch(const CanIDType can_id, const CANData& mask,
+               const std::uint8_t len, const Duration& timeout) noexcept
+    {
+        struct bcm_msg_head head = make_head(RX_SETUP, can_id, 1U);
+        head.flags = RX_CHECK_DLC;
+
+        if (timeout.count() > 0)
+        {
+            head.flags |= SETTIMER | STARTTIMER;
+            head.ival1 = to_bcm_timeval(timeout);
+        }
+
+        return write_message< CANData >(head, can_id, mask.data(),
+                                        std::min< std::size_t >(len,
+                                                                mask.size()));
+    }
+
+    /**
+     * \brief Ends a subscription.
+     * \param[in] can_id CAN identifier watched.
+     * \param[in] canfd true if it was set up with CAN FD data.
+     * \return true if the subscription was removed.
+     */
+    bool unwatch(const CanIDType can_id, const bool canfd = false) noexcept;
+
+    /**
+     * \brief Receives the next notification of the broadcast manager
+     * (blocking read).
+     * \param[out] can_id CAN identifier of the frame.
+     * \param[out] data the payload of a changed frame.
+     * \param[out] event what happened.
+     * \return the length of the payload, zero if there is none (timeout) or
+     * -1 on error.
+     */
+    std::int8_t receive(CanIDType& can_id, CanFDData& data,
+                        BcmEvent& event) noexcept;
+
+    /**
+     * \brief Receives the next notification of the broadcast manager
+     * (non-blocking read / timeout / polling possible).
+     * \param[in] deadline Time to wait for a notification.
+     * \return the length of the payload, zero if there is none or on
+     * timeout, -1 on error.
+     */
+    template < typename Duration >
+    std::int8_t receive(CanIDType& can_id, CanFDData& data, BcmEvent& event,
+                        const Duration&& deadline) noexcept
+    {
+        std::int8_t received{-1};
+
+        if (is_bcm_initialized())
+        {
+            const bool notified = wait_for(std::move(deadline));
+
+            if (notified)
+            {
+                received = receive(can_id, data, event);
+            }
+            else
+            {
+                event = BcmEvent::OTHER;
+                received = 0;
+            }
+        }
+
+        return received;
+    }
+
+  private:
+    /// a message head followed by one CAN FD frame. The head ends with a
+    /// flexible array, thus the message is assembled in a byte buffer.
+    using MessageBuffer =
+        std::array< std::uint8_t, sizeof(struct bcm_msg_head) +
+                                      sizeof(struct canfd_frame) >;
+
+    /**
+     * \brief Converts a duration into the interval of the broadcast manager.
+     */
+    template < typename Duration >
+    static struct bcm_timeval to_bcm_timeval(const Duration& interval) noexcept
+    {
+        using namespace std::chrono;
+        const auto usec = duration_cast< microseconds >(interval).count();
+        struct bcm_timeval timeval;
+        timeval.tv_sec = static_cast< long >(usec / 1000000);
+        timeval.tv_usec = static_cast< long >(usec % 1000000);
+        return timeval;
+    }
+
+    /**
+     * \brief A message head without flags and timers.
+     */
+    static struct bcm_msg_head make_head(const std::uint32_t opcode,
+                                         const CanIDType can_id,
+                                         const std::uint32_t nframes) noexcept
+    {
+        struct bcm_msg_head head;
+        std::memset(&head, 0, sizeof(head));
+        head.opcode = opcode;
+        head.can_id = can_id;
+        head.nframes = nframes;
+        return head;
+    }
+
+    /**
+     * \brief Writes a message head with one frame of the selected type.
+     */
+    template < typename CANData >
+    bool write_message(struct bcm_msg_head head, const CanIDType can_id,
+                       const std::uint8_t* data, const std::size_t len) noexcept
+    {
+        static_assert(std::is_same< CanStdData, CANData >::value ||
+                          std::is_same< CanFDData, CANData >::value,
+                      "Must be a standard CAN frame or CAN FD frame.");
+        constexpr bool canfd = std::is_same< CanFDData, CANData >::value;
+        struct canfd_frame frame;
+        std::memset(&frame, 0, sizeof(frame));
+        frame.can_id = can_id;
+        frame.len = static_cast< std::uint8_t >(len);
+        std::memcpy(frame.data, data, len);
+
+        if (canfd)
+        {
+            head.flags |= CAN_FD_FRAME;
+        }
+
+        return write_message(head, &frame,
+                             canfd ? sizeof(struct canfd_frame)
+                                   : sizeof(struct can_frame));
+    }
+
+    /**
+     * \brief Writes a message head followed by a frame to the kernel.
+     * \param[in] frame the frame, nullptr if the message has none.
+     * \param[in] frame_size the size of the frame on the socket.
+     */
+    bool write_message(const struct bcm_msg_head& head,
+                       const struct canfd_frame* frame,
+                       const std::size_t frame_size) noexcept;
+
+    /**
+     * \brief Connects the socket to the interface.
+     */
+    bool connect_if_socket(const unsigned int ifindex) noexcept;
+
+    /// the socket is connected to the interface.
+    bool bcm_init_;
+};
+
+#endif // WIN32 detection
+#endif /* CANBCMSOCKET_H_ */
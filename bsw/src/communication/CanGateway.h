@@ -0,0 +1,624 @@
+/**
+ * \file      CanGateway.h
+ * \author    dtuchscherer <daniel.tuchscherer@gmail.com>
+ * \brief     Routing CAN frames between busses
+ * \details   A routing table matched by identifier and mask forwards batches
+ *            of frames between CanSockets or offloads routes to CAN_GW.
+ * \copyright Copyright (c) 2018, Daniel Tuchscherer.
+ *            All rights reserved.
+ *
+ *            Redistributions and use in source and binary forms, with
+ *            or without modifications, are permitted provided that the
+ *            following conditions are met: Redistributions of source code must
+ *            retain the above copyright notice, this list of conditions and the
+ *            following disclaimer.
+ *
+ *            Redistributions in binary form must reproduce the above copyright
+ *            notice, this list of conditions and the following disclaimer in
+ *            the documentation and/or other materials provided with the
+ *            distribution.
+ *
+ *            Neither the name of the Heilbronn University nor the name of its
+ *            contributors may be used to endorse or promote products derived
+ *            from this software without specific prior written permission.
+ *
+ *            THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS “AS IS”
+ *            AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ *            TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ *            PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE REGENTS
+ *            OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *            SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *            LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *            USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *            AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *            LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *            ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *            POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CANGATEWAY_H_
+#define CANGATEWAY_H_
+#ifndef _WIN32
+
+#include "CanGwSocket.h" // kernel offload
+#include "CanSocket.h"
+#include "EventLoop.h"
+#include <algorithm> // sorting and searching the routes
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility> // forwarding the deadline
+
+/**
+ * \brief One entry of a routing table: frames received on bus "from" whose
+ * identifier matches are sent on bus "to".
+ * \details A frame matches if (can_id & mask) == (id & mask). The identifier
+ * sent is (can_id & ~rewrite_mask) | (new_id & rewrite_mask), a rewrite_mask
+ * of 0 forwards the identifier unchanged.
+ */
+struct CanRoute
+{
+    /// index of the receiving and the transmitting bus of the gateway.
+    std::size_t from;
+    std::size_t to;
+    /// the identifier and the bits of it that must match.
+    CanIDType id;
+    CanIDType mask;
+    /// the identifier bits set on the bus "to".
+    CanIDType new_id;
+    CanIDType rewrite_mask;
+    /// true if the route is handed over to the kernel (CAN_GW).
+    bool kernel;
+
+    /**
+     * \brief The same route sending the frames with another identifier.
+     * \param[in] id_to the identifier to send with.
+     * \param[in] bits the bits of the identifier replaced, all by default.
+     */
+    constexpr CanRoute
+    remap(const CanIDType id_to,
+          const CanIDType bits = CAN_EFF_FLAG | CAN_EFF_MASK) const noexcept
+    {
+        return CanRoute{from, to, id, mask, id_to, bits, kernel};
+    }
+
+    /**
+     * \brief The same route forwarded by the kernel instead of the gateway.
+     */
+    constexpr CanRoute offload() const noexcept
+    {
+        return CanRoute{from, to, id, mask, new_id, rewrite_mask, true};
+    }
+
+    /**
+     * \brief Checks if a received identifier takes this route.
+     */
+    constexpr bool matches(const CanIDType can_id) const noexcept
+    {
+        return (can_id & mask) == (id & mask);
+    }
+
+    /**
+     * \brief The identifier a frame is forwarded with.
+     */
+    constexpr CanIDType apply(const CanIDType can_id) const noexcept
+    {
+        return (can_id & ~rewrite_mask) | (new_id & rewrite_mask);
+    }
+};
+
+/**
+ * \brief The mask matching exactly one identifier, including its format and
+ * the remote request flag.
+ */
+constexpr CanIDType exact_can_mask(const CanIDType can_id) noexcept
+{
+    return CAN_EFF_FLAG | CAN_RTR_FLAG |
+           (((can_id & CAN_EFF_FLAG) != 0U) ? CAN_EFF_MASK : CAN_SFF_MASK);
+}
+
+/**
+ * \brief Creates a route at compile-time.
+ * \param[in] from the bus the frames are received on.
+ * \param[in] to the bus the frames are sent on.
+ * \param[in] can_id the identifier to forward. Set CAN_EFF_FLAG for extended
+ * identifiers.
+ * \param[in] can_mask the bits that must match, exactly the identifier by
+ * default.
+ * \return the route forwarding the identifier unchanged.
+ */
+constexpr CanRoute make_route(const std::size_t from, const std::size_t to,
+                              const CanIDType can_id,
+                              const CanIDType can_mask) noexcept
+{
+    return CanRoute{from, to, can_id, can_mask, 0U, 0U, false};
+}
+
+constexpr CanRoute make_route(const std::size_t from, const std::size_t to,
+                              const CanIDType can_id) noexcept
+{
+    return make_route(from, to, can_id, exact_can_mask(can_id));
+}
+
+/**
+ * \brief The routes of a gateway compiled into a flat lookup structure.
+ * \details Routes matching exactly one identifier are sorted by bus and
+ * identifier and found by binary search; every route of an identifier is
+ * found at once to fan out. Routes with a mask are grouped by bus and
+ * scanned after that. Routes offloaded to the kernel are not looked up.
+ * Everything is built once at construction without any allocation.
+ * \tparam Buses the number of busses.
+ * \tparam Routes the number of routes.
+ */
+template < std::size_t Buses, std::size_t Routes > class CanRoutingTable
+{
+  public:
+    /**
+     * \brief Compiles the routes into the lookup structure.
+     * \param[in] routes the routing table, usually a constexpr array of
+     * make_route(). Routes with a bus out of range are ignored.
+     */
+    explicit CanRoutingTable(
+        const std::array< CanRoute, Routes >& routes) noexcept
+        : m_routes(routes), m_exact_size{0U}, m_masked_size{0U},
+          m_masked_begin{}
+    {
+        static_assert(Buses > 0U, "The gateway must connect at least one bus.");
+
+        for (const auto& route : m_routes)
+        {
+            if ((route.kernel == false) && (route.from < Buses) &&
+                (route.to < Buses))
+            {
+                if (route.mask == exact_can_mask(route.id))
+                {
+                    m_exact[m_exact_size] = Entry{key(route.from, route.id),
+                                                  &route};
+                    ++m_exact_size;
+                }
+                else
+                {
+                    m_masked[m_masked_size] = &route;
+                    ++m_masked_size;
+                }
+            }
+        }
+
+        std::stable_sort(m_exact.begin(), m_exact.begin() + m_exact_size,
+                         [](const Entry& lhs, const Entry& rhs) {
+                             return lhs.key < rhs.key;
+                         });
+        std::stable_sort(m_masked.begin(), m_masked.begin() + m_masked_size,
+                         [](const CanRoute* lhs, const CanRoute* rhs) {
+                             return lhs->from < rhs->from;
+                         });
+
+        // the masked routes of bus b are [m_masked_begin[b], [b + 1]).
+        std::size_t pos{0U};
+
+        for (std::size_t bus = 0U; bus <= Buses; ++bus)
+        {
+            while ((pos < m_masked_size) && (m_masked[pos]->from < bus))
+            {
+                ++pos;
+            }
+
+            m_masked_begin[bus] = pos;
+        }
+    }
+
+    /// the lookup points into this object. Copying is not allowed.
+    CanRoutingTable(const CanRoutingTable&) = delete;
+    CanRoutingTable& operator=(const CanRoutingTable&) = delete;
+
+    /**
+     * \brief Calls the function for every route a frame takes.
+     * \tparam Function callable as fn(const CanRoute&).
+     * \param[in] from the bus the frame was received on.
+     * \param[in] can_id the identifier received.
+     * \param[in] fn called once per route.
+     * \return the number of routes taken.
+     */
+    template < typename Function >
+    std::size_t for_each(const std::size_t from, const CanIDType can_id,
+                         Function&& fn) const noexcept
+    {
+        std::size_t taken{0U};
+
+        if (from < Buses)
+        {
+            const auto* const first = m_exact.data();
+            const auto* const last = first + m_exact_size;
+            const auto range =
+                std::equal_range(first, last, Entry{key(from, can_id), nullptr},
+                                 [](const Entry& lhs, const Entry& rhs) {
+                                     return lhs.key < rhs.key;
+                                 });
+
+            for (auto* entry = range.first; entry != range.second; ++entry)
+            {
+                fn(*entry->route);
+                ++taken;
+            }
+
+            const auto end = m_masked_begin[from + 1U];
+
+            for (auto pos = m_masked_begin[from]; pos < end; ++pos)
+            {
+                if (m_masked[pos]->matches(can_id))
+                {
+                    fn(*m_masked[pos]);
+                    ++taken;
+                }
+            }
+        }
+
+        return taken;
+    }
+
+    /**
+     * \brief All routes as given at construction, including those offloaded.
+     */
+    const std::array< CanRoute, Routes >& routes() const noexcept
+    {
+        return m_routes;
+    }
+
+  private:
+    /**
+     * \brief An exactly matching route by bus and identifier.
+     */
+    struct Entry
+    {
+        std::uint64_t key;
+        const CanRoute* route;
+    };
+
+    /**
+     * \brief The sort key: the bus and the identifier without error flag.
+     * The format flag keeps standard and extended identifiers apart.
+     */
+    static constexpr std::uint64_t key(const std::size_t bus,
+                                       const CanIDType can_id) noexcept
+    {
+        return (static_cast< std::uint64_t >(bus) << 32U) |
+               (can_id & (CAN_EFF_FLAG | CAN_RTR_FLAG | CAN_EFF_MASK));
+    }
+
+    /// the routes the entries point to.
+    const std::array< CanRoute, Routes > m_routes;
+
+    /// the exact routes sorted by key.
+    std::array< Entry, Routes > m_exact;
+    std::size_t m_exact_size;
+
+    /// the routes with a mask grouped by bus.
+    std::array< const CanRoute*, Routes > m_masked;
+    std::size_t m_masked_size;
+
+    /// start of the masked routes of every bus.
+    std::array< std::size_t, Buses + 1U > m_masked_begin;
+};
+
+/**
+ * \brief Forwards CAN frames between busses by a routing table.
+ * \details The frames of a bus are received in batches (recvmmsg), routed
+ * and staged per target bus, and the staged frames of every bus are sent
+ * with one system call (sendmmsg) per tick. Routes marked offload() are
+ * installed in the kernel with offload() and never reach user space.
+ *
+ * \code
+ * static constexpr std::array< CanRoute, 2 > routes{{
+ *     make_route(0U, 1U, 0x100U).remap(0x200U),
+ *     make_route(1U, 0U, 0x300U, 0x700U).offload(),
+ * }};
+ * CanSocket vcan0{"vcan0"};
+ * CanSocket can1{"can1"};
+ * CanGateway< 2, 2 > gateway{routes, {{&vcan0, &can1}}};
+ * EventLoop< 2 > loop;
+ * gateway.attach(loop);
+ * while (running) { gateway.run_once(loop, std::chrono::milliseconds(10)); }
+ * \endcode
+ * \tparam Buses the number of busses.
+ * \tparam Routes the number of routes.
+ * \tparam Batch the number of frames received and staged per bus at once.
+ */
+template < std::size_t Buses, std::size_t Routes, std::size_t Batch = 32U >
+class CanGateway
+{
+  public:
+    /**
+     * \brief Compiles the routing table.
+     * \param[in] routes the routing table.
+     * \param[in] buses the sockets of the busses. The index of a socket is the
+     * bus index used in the routes.
+     */
+    CanGateway(const std::array< CanRoute, Routes >& routes,
+               const std::array< CanSocket*, Buses >& buses) noexcept
+        : m_table{routes}, m_buses(buses), m_forwarded{0U}, m_dropped{0U},
+          m_unrouted{0U}
+    {
+        static_assert(Batch <= CanSocket::MAX_BATCH,
+                      "A batch is received with one call of receive_batch().");
+
+        for (std::size_t bus = 0U; bus < Buses; ++bus)
+        {
+            m_contexts[bus] = Context{this, bus};
+        }
+    }
+
+    /// the event loop holds pointers into this object.
+    CanGateway(const CanGateway&) = delete;
+    CanGateway& operator=(const CanGateway&) = delete;
+
+    /**
+     * \brief Registers all busses on an event loop. The sockets are switched
+     * into non-blocking mode.
+     * \param[in] loop the loop calling forward() once a bus is readable.
+     * \return true if all busses are registered.
+     */
+    template < std::size_t Capacity >
+    bool attach(EventLoop< Capacity >& loop) noexcept
+    {
+        bool attached{true};
+
+        for (std::size_t bus = 0U; bus < Buses; ++bus)
+        {
+            auto* const context = &m_contexts[bus];
+            attached = (m_buses[bus] != nullptr) &&
+                       loop.add(*m_buses[bus], &on_readable, context) &&
+                       attached;
+        }
+
+        return attached;
+    }
+
+    /**
+     * \brief One tick: dispatches the readable busses and sends the staged
+     * frames.
+     * \param[in] loop the loop the gateway is attached to.
+     * \param[in] deadline the maximum time to wait for frames.
+     * \return the number of busses dispatched or -1 on error.
+     */
+    template < std::size_t Capacity, typename Duration >
+    std::int16_t run_once(EventLoop< Capacity >& loop,
+                          const Duration&& deadline) noexcept
+    {
+        const auto dispatched = loop.run_once(std::move(deadline));
+        flush();
+        return dispatched;
+    }
+
+    /**
+     * \brief Receives the frames pending on a bus and stages them on their
+     * target busses. A full batch is sent right away. The socket must be
+     * non-blocking, attach() takes care of that.
+     * \param[in] from the bus to read.
+     * \return the number of frames received or -1 if there was an error.
+     */
+    std::int16_t forward(const std::size_t from) noexcept
+    {
+        std::int16_t received{-1};
+        CanSocket* const socket = (from < Buses) ? m_buses[from] : nullptr;
+
+        if (socket != nullptr)
+        {
+            received = 0;
+            std::int16_t nframes{0};
+
+            // drain the socket, a short batch means the queue is empty.
+            do
+            {
+                nframes = socket->receive_batch(m_rx);
+
+                for (std::int16_t i = 0; i < nframes; ++i)
+                {
+                    route(from, m_rx[static_cast< std::size_t >(i)]);
+                }
+
+                received = static_cast< std::int16_t >(
+                    received + ((nframes > 0) ? nframes : 0));
+            } while (nframes == static_cast< std::int16_t >(Batch));
+        }
+
+        return received;
+    }
+
+    /**
+     * \brief Sends the frames staged on every bus.
+     * \return false if a bus failed to send. Frames the kernel did not accept
+     * stay staged for the next tick.
+     */
+    bool flush() noexcept
+    {
+        bool sent{true};
+
+        for (std::size_t bus = 0U; bus < Buses; ++bus)
+        {
+            sent = flush(bus) && sent;
+        }
+
+        return sent;
+    }
+
+    /**
+     * \brief Installs the routes marked offload() in the kernel gateway.
+     * Every route forwards standard CAN frames and CAN FD frames.
+     * \param[in] gw the netlink socket to the kernel gateway.
+     * \return true if all routes are installed.
+     */
+    bool offload(CanGwSocket& gw) noexcept
+    {
+        return for_each_rule([&gw](const CanGwRule& rule) {
+            return gw.add(rule);
+        });
+    }
+
+    /**
+     * \brief Removes the routes installed by offload() from the kernel.
+     * \param[in] gw the netlink socket to the kernel gateway.
+     * \return true if all routes are removed.
+     */
+    bool remove_offload(CanGwSocket& gw) noexcept
+    {
+        return for_each_rule([&gw](const CanGwRule& rule) {
+            return gw.remove(rule);
+        });
+    }
+
+    /**
+     * \brief The routing table of the gateway.
+     */
+    const CanRoutingTable< Buses, Routes >& table() const noexcept
+    {
+        return m_table;
+    }
+
+    /**
+     * \brief Number of frames staged for transmission on a target bus.
+     */
+    std::uint64_t forwarded() const noexcept { return m_forwarded; }
+
+    /**
+     * \brief Number of frames lost because the batch of the target bus was
+     * full and could not be sent.
+     */
+    std::uint64_t dropped() const noexcept { return m_dropped; }
+
+    /**
+     * \brief Number of frames received that took no route.
+     */
+    std::uint64_t unrouted() const noexcept { return m_unrouted; }
+
+  private:
+    /**
+     * \brief The context given to the event loop per bus.
+     */
+    struct Context
+    {
+        CanGateway* gateway;
+        std::size_t bus;
+    };
+
+    static void on_readable(std::uint32_t, void* context) noexcept
+    {
+        auto* const bus = static_cast< Context* >(context);
+        bus->gateway->forward(bus->bus);
+    }
+
+    /**
+     * \brief Stages a received frame on all target busses of its routes.
+     */
+    void route(const std::size_t from, const CanFrame& frame) noexcept
+    {
+        // the frame type is not reported by recvmmsg. Newer kernels mark CAN
+        // FD frames, otherwise a frame is CAN FD if it is longer than 8 bytes.
+#ifdef CANFD_FDF
+        const bool canfd = ((frame.flags & CANFD_FDF) != 0U) ||
+                           (frame.len > CAN_STD::DATA_LEN);
+#else
+        const bool canfd = (frame.len > CAN_STD::DATA_LEN);
+#endif
+        const auto taken = m_table.for_each(
+            from, frame.can_id, [this, &frame, canfd](const CanRoute& route) {
+                stage(route, frame, canfd);
+            });
+
+        if (taken == 0U)
+        {
+            ++m_unrouted;
+        }
+    }
+
+    void stage(const CanRoute& route, const CanFrame& frame,
+               const bool canfd) noexcept
+    {
+        auto& batch = m_tx[route.to];
+
+        if (batch.full())
+        {
+            flush(route.to);
+        }
+
+        CanFrame* const out = batch.stage(canfd);
+
+        if (out != nullptr)
+        {
+            out->can_id = route.apply(frame.can_id);
+            out->len = frame.len;
+            out->flags = frame.flags;
+            std::memcpy(out->data, frame.data, frame.len);
+            ++m_forwarded;
+        }
+        else
+        {
+            ++m_dropped;
+        }
+    }
+
+    bool flush(const std::size_t bus) noexcept
+    {
+        bool sent{true};
+
+        if ((m_buses[bus] != nullptr) && (m_tx[bus].empty() == false))
+        {
+            sent = (m_buses[bus]->send_batch(m_tx[bus]) >= 0);
+        }
+
+        return sent;
+    }
+
+    /**
+     * \brief Calls the function with the kernel rules of all offloaded
+     * routes, one for standard CAN and one for CAN FD.
+     */
+    template < typename Function > bool for_each_rule(Function&& fn) noexcept
+    {
+        bool done{true};
+
+        for (const auto& route : m_table.routes())
+        {
+            if ((route.kernel == true) && (route.from < Buses) &&
+                (route.to < Buses) && (m_buses[route.from] != nullptr) &&
+                (m_buses[route.to] != nullptr))
+            {
+                CanGwRule rule{m_buses[route.from]->get_interface_index(),
+                               m_buses[route.to]->get_interface_index(),
+                               route.id,
+                               route.mask,
+                               route.new_id,
+                               route.rewrite_mask,
+                               false};
+                done = fn(rule) && done;
+                rule.canfd = true;
+                done = fn(rule) && done;
+            }
+        }
+
+        return done;
+    }
+
+    /// the compiled routes.
+    CanRoutingTable< Buses, Routes > m_table;
+
+    /// the sockets of the busses.
+    std::array< CanSocket*, Buses > m_buses;
+
+    /// the event loop context of every bus.
+    std::array< Context, Buses > m_contexts;
+
+    /// the frames received from one bus.
+    std::array< CanFrame, Batch > m_rx;
+
+    /// the frames staged per target bus.
+    std::array< CanTxBatch< Batch >, Buses > m_tx;
+
+    /// statistics.
+    std::uint64_t m_forwarded;
+    std::uint64_t m_dropped;
+    std::uint64_t m_unrouted;
+};
+
+#endif /* _WIN32 */
+#endif /* CANGATEWAY_H_ */
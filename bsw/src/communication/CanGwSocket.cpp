@@ -0,0 +1,217 @@
+/**
+ * \file      CanGwSocket.cpp
+ * \author    dtuchscherer <daniel.tuchscherer@gmail.com>
+ * \brief     SocketCAN gateway rules (CAN_GW)
+ * \details   These are the methods of class CanGwSocket to add and remove
+ *            routing rules of the can-gw kernel module with netlink.
+ * \copyright Copyright (c) 2018, Daniel Tuchscherer.
+ *            All rights reserved.
+ *
+ *            Redistributions and use in source and binary forms, with
+ *            or without modifications, are permitted provided that the
+ *            following conditions are met: Redistributions of source code must
+ *            retain the above copyright notice, this list of conditions and the
+ *            following disclaimer.
+ *
+ *            Redistributions in binary form must reproduce the above copyright
+ *            notice, this list of conditions and the following disclaimer in
+ *            the documentation and/or other materials provided with the
+ *            distribution.
+ *
+ *            Neither the name of the Heilbronn University nor the name of its
+ *            contributors may be used to endorse or promote products derived
+ *            from this software without specific prior written permission.
+ *
+ *            THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS “AS IS”
+ *            AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ *            TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ *            PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE REGENTS
+ *            OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *            SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *            LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *            USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *            AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *            LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *            ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *            POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef _WIN32
+#error "SocketCAN for Linux OS only."
+#endif
+#include "CanGwSocket.h"
+#include <cstring>
+#include <linux/can/gw.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+
+constexpr std::size_t CanGwSocket::MESSAGE_SIZE;
+
+////////////////////////////////////////////////////////////////////////////////
+/**
+ * \brief Appends a netlink attribute to the message.
+ * \return false if the attribute does not fit.
+ */
+static bool add_attribute(struct nlmsghdr* message, const std::size_t size,
+                          const std::uint16_t type, const void* data,
+                          const std::size_t len) noexcept
+{
+    const auto attr_len = RTA_LENGTH(len);
+    const auto offset = NLMSG_ALIGN(message->nlmsg_len);
+    const bool fits = (offset + RTA_ALIGN(attr_len)) <= size;
+
+    if (fits)
+    {
+        auto attr = reinterpret_cast< struct rtattr* >(
+            reinterpret_cast< std::uint8_t* >(message) + offset);
+        attr->rta_type = type;
+        attr->rta_len = static_cast< unsigned short >(attr_len);
+        std::memcpy(RTA_DATA(attr), data, len);
+        message->nlmsg_len = static_cast< std::uint32_t >(offset +
+                                                          RTA_ALIGN(attr_len));
+    }
+
+    return fits;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool CanGwSocket::create() noexcept
+{
+    bool socket_created{false};
+    socket_ = socket(PF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+
+    // check here if the socket was opened.
+    if (get_socket_handle() > 0)
+    {
+        socket_created = true;
+    }
+    else
+    {
+        last_error_ = errno;
+        socket_created = false;
+    }
+
+    return socket_created;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool CanGwSocket::add(const CanGwRule& rule) noexcept
+{
+    return request(RTM_NEWROUTE, &rule);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool CanGwSocket::remove(const CanGwRule& rule) noexcept
+{
+    return request(RTM_DELROUTE, &rule);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool CanGwSocket::flush() noexcept
+{
+    // deleting without interfaces removes all rules.
+    return request(RTM_DELROUTE, nullptr);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool CanGwSocket::request(const std::uint16_t type,
+                          const CanGwRule* rule) noexcept
+{
+    bool acknowledged{false};
+    alignas(struct nlmsghdr) std::array< std::uint8_t, MESSAGE_SIZE > buffer{};
+    auto message = reinterpret_cast< struct nlmsghdr* >(buffer.data());
+    message->nlmsg_len = NLMSG_LENGTH(sizeof(struct rtcanmsg));
+    message->nlmsg_type = type;
+    message->nlmsg_flags = NLM_F_REQUEST | NLM_F_ACK;
+    message->nlmsg_seq = ++sequence_;
+
+    auto can_msg = static_cast< struct rtcanmsg* >(NLMSG_DATA(message));
+    can_msg->can_family = AF_CAN;
+    can_msg->gwtype = CGW_TYPE_CAN_CAN;
+
+    bool complete{true};
+
+    if (rule != nullptr)
+    {
+        can_msg->flags = rule->canfd ? CGW_FLAGS_CAN_FD : 0U;
+        const std::uint32_t src = rule->src_ifindex;
+        const std::uint32_t dst = rule->dst_ifindex;
+        struct can_filter filter;
+        filter.can_id = rule->id;
+        filter.can_mask = rule->mask;
+        complete = add_attribute(message, buffer.size(), CGW_SRC_IF, &src,
+                                 sizeof(src)) &&
+                   add_attribute(message, buffer.size(), CGW_DST_IF, &dst,
+                                 sizeof(dst)) &&
+                   add_attribute(message, buffer.size(), CGW_FILTER, &filter,
+                                 sizeof(filter));
+
+        if (complete && (rule->rewrite_mask != 0U))
+        {
+            // clear the rewritten bits, then set them from the new id.
+            const CanIDType and_id = ~rule->rewrite_mask;
+            const CanIDType or_id = rule->new_id & rule->rewrite_mask;
+
+            if (rule->canfd)
+            {
+                struct cgw_fdframe_mod mod_and;
+                struct cgw_fdframe_mod mod_or;
+                std::memset(&mod_and, 0, sizeof(mod_and));
+                std::memset(&mod_or, 0, sizeof(mod_or));
+                mod_and.cf.can_id = and_id;
+                mod_and.modtype = CGW_MOD_ID;
+                mod_or.cf.can_id = or_id;
+                mod_or.modtype = CGW_MOD_ID;
+                complete = add_attribute(message, buffer.size(), CGW_FDMOD_AND,
+                                         &mod_and, CGW_FDMODATTR_LEN) &&
+                           add_attribute(message, buffer.size(), CGW_FDMOD_OR,
+                                         &mod_or, CGW_FDMODATTR_LEN);
+            }
+            else
+            {
+                struct cgw_frame_mod mod_and;
+                struct cgw_frame_mod mod_or;
+                std::memset(&mod_and, 0, sizeof(mod_and));
+                std::memset(&mod_or, 0, sizeof(mod_or));
+                mod_and.cf.can_id = and_id;
+                mod_and.modtype = CGW_MOD_ID;
+                mod_or.cf.can_id = or_id;
+                mod_or.modtype = CGW_MOD_ID;
+                complete = add_attribute(message, buffer.size(), CGW_MOD_AND,
+                                         &mod_and, CGW_MODATTR_LEN) &&
+                           add_attribute(message, buffer.size(), CGW_MOD_OR,
+                                         &mod_or, CGW_MODATTR_LEN);
+            }
+        }
+    }
+
+    const auto handle = get_socket_handle();
+
+    if (complete && (send(handle, message, message->nlmsg_len, 0) >= 0))
+    {
+        alignas(struct nlmsghdr) std::array< std::uint8_t, MESSAGE_SIZE > ack;
+        const ssize_t received = recv(handle, ack.data(), ack.size(), 0);
+        const auto reply = reinterpret_cast< struct nlmsghdr* >(ack.data());
+
+        if ((received >= static_cast< ssize_t >(NLMSG_LENGTH(
+                             sizeof(struct nlmsgerr)))) &&
+            (reply->nlmsg_type == NLMSG_ERROR))
+        {
+            const auto error =
+                static_cast< const struct nlmsgerr* >(NLMSG_DATA(reply));
+            // an error code of 0 is the acknowledgement.
+            acknowledged = (error->error == 0);
+            last_error_ = -error->error;
+        }
+        else
+        {
+            last_error_ = (received < 0) ? errno : EPROTO;
+        }
+    }
+    else
+    {
+        last_error_ = complete ? errno : EMSGSIZE;
+    }
+
+    return acknowledged;
+}
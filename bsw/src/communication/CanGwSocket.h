@@ -0,0 +1,126 @@
+/**
+ * \file      CanGwSocket.h
+ * \author    dtuchscherer <daniel.tuchscherer@gmail.com>
+ * \brief     SocketCAN gateway rules (CAN_GW)
+ * \details   Installs routing rules into the can-gw module of the Linux kernel
+ *            via netlink, so frames are forwarded without user space.
+ * \copyright Copyright (c) 2018, Daniel Tuchscherer.
+ *            All rights reserved.
+ *
+ *            Redistributions and use in source and binary forms, with
+ *            or without modifications, are permitted provided that the
+ *            following conditions are met: Redistributions of source code must
+ *            retain the above copyright notice, this list of conditions and the
+ *            following disclaimer.
+ *
+ *            Redistributions in binary form must reproduce the above copyright
+ *            notice, this list of conditions and the following disclaimer in
+ *            the documentation and/or other materials provided with the
+ *            distribution.
+ *
+ *            Neither the name of the Heilbronn University nor the name of its
+ *            contributors may be used to endorse or promote products derived
+ *            from this software without specific prior written permission.
+ *
+ *            THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS “AS IS”
+ *            AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ *            TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ *            PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE REGENTS
+ *            OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *            SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *            LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *            USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *            AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *            LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *            ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *            POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CANGWSOCKET_H_
+#define CANGWSOCKET_H_
+#ifndef _WIN32
+
+#include "CanSocket.h" // CAN data types
+#include "Socket.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * \brief A rule of the kernel gateway: frames of the source interface that
+ * match the filter are sent on the destination interface.
+ * \details The identifier is rewritten by
+ * (can_id & ~rewrite_mask) | (new_id & rewrite_mask).
+ */
+struct CanGwRule
+{
+    /// interface index of the source and destination.
+    unsigned int src_ifindex;
+    unsigned int dst_ifindex;
+    /// frames match if (can_id & mask) == (id & mask).
+    CanIDType id;
+    CanIDType mask;
+    /// the bits of rewrite_mask are taken from new_id, 0 keeps the id.
+    CanIDType new_id;
+    CanIDType rewrite_mask;
+    /// true for CAN FD frames, false for standard CAN frames.
+    bool canfd;
+};
+
+/**
+ * \brief Netlink socket to the can-gw kernel module.
+ * \details Frames of a rule are forwarded in the kernel's receive path; no
+ * thread wakes up and no frame is copied to user space. Rules stay active
+ * until they are removed or flushed, even after the process exits.
+ * Needs CAP_NET_ADMIN and the module can-gw.
+ */
+class CanGwSocket : public Socket< CanGwSocket >
+{
+  public:
+    CanGwSocket() noexcept : Socket{} {}
+
+    /**
+     * \brief Create the netlink socket; this is called by the base class.
+     * \return true if the socket is opened or false if there was an error.
+     */
+    bool create() noexcept;
+
+    /**
+     * \brief Installs a rule.
+     * \param[in] rule the rule to add.
+     * \return true if the kernel accepted the rule.
+     */
+    bool add(const CanGwRule& rule) noexcept;
+
+    /**
+     * \brief Removes a rule added before with the same values.
+     * \param[in] rule the rule to remove.
+     * \return true if the kernel removed the rule.
+     */
+    bool remove(const CanGwRule& rule) noexcept;
+
+    /**
+     * \brief Removes all rules of the kernel gateway, also those of other
+     * processes.
+     * \return true if the rules are removed.
+     */
+    bool flush() noexcept;
+
+  private:
+    /// space for the netlink header, rtcanmsg and all attributes.
+    static constexpr std::size_t MESSAGE_SIZE{256U};
+
+    /**
+     * \brief Sends a request and waits for the acknowledgement.
+     * \param[in] type RTM_NEWROUTE or RTM_DELROUTE.
+     * \param[in] rule the rule or nullptr for all rules.
+     * \return true if the kernel acknowledged without error.
+     */
+    bool request(const std::uint16_t type, const CanGwRule* rule) noexcept;
+
+    /// sequence number of the requests.
+    std::uint32_t sequence_{0U};
+};
+
+#endif /* _WIN32 */
+#endif /* CANGWSOCKET_H_ */
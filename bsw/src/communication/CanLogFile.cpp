@@ -0,0 +1,284 @@
+/**
+ * \file      CanLogFile.cpp
+ * \author    dtuchscherer <daniel.tuchscherer@gmail.com>
+ * \brief     Binary CAN log files
+ * \details   These are the methods of the classes CanLogFile and CanLogReader
+ *            to write and read memory mapped CAN log files.
+ * \copyright Copyright (c) 2018, Daniel Tuchscherer.
+ *            All rights reserved.
+ *
+ *            Redistributions and use in source and binary forms, with
+ *            or without modifications, are permitted provided that the
+ *            following conditions are met: Redistributions of source code must
+ *            retain the above copyright notice, this list of conditions and the
+ *            following disclaimer.
+ *
+ *            Redistributions in binary form must reproduce the above copyright
+ *            notice, this list of conditions and the following disclaimer in
+ *            the documentation and/or other materials provided with the
+ *            distribution.
+ *
+ *            Neither the name of the Heilbronn University nor the name of its
+ *            contributors may be used to endorse or promote products derived
+ *            from this software without specific prior written permission.
+ *
+ *            THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS “AS IS”
+ *            AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ *            TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ *            PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE REGENTS
+ *            OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *            SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *            LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *            USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *            AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *            LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *            ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *            POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef _WIN32
+#error "CAN log files for Linux OS only."
+#endif
+#include "CanLogFile.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+constexpr std::size_t CanLogFile::MAX_PREFIX;
+
+/// identifies a CAN log file.
+static constexpr std::array< char, 8U > CAN_LOG_MAGIC{
+    {'B', 'S', 'W', 'C', 'A', 'N', 'L', 'G'}};
+
+/// the format version written.
+static constexpr std::uint32_t CAN_LOG_VERSION{1U};
+
+////////////////////////////////////////////////////////////////////////////////
+CanLogFile::CanLogFile(const char* prefix, const std::size_t records_per_file,
+                       const std::uint32_t max_files) noexcept
+    : prefix_{}, capacity_{records_per_file}, max_files_{max_files}, fd_{-1},
+      map_{nullptr}, header_{nullptr}, records_{nullptr}, count_{0U},
+      sequence_{0U}, total_{0U}, last_error_{0}
+{
+    if ((prefix != nullptr) && (std::strlen(prefix) < MAX_PREFIX) &&
+        (capacity_ > 0U))
+    {
+        std::strcpy(prefix_.data(), prefix);
+        open_file();
+    }
+    else
+    {
+        last_error_ = EINVAL;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+CanLogFile::~CanLogFile() noexcept { close_file(); }
+
+////////////////////////////////////////////////////////////////////////////////
+bool CanLogFile::append(const CanLogRecord& record) noexcept
+{
+    if ((records_ != nullptr) && (count_ == capacity_))
+    {
+        // rotate to the next file.
+        close_file();
+        ++sequence_;
+        open_file();
+    }
+
+    const bool appended = (records_ != nullptr);
+
+    if (appended)
+    {
+        std::memcpy(&records_[count_], &record, sizeof(CanLogRecord));
+        ++count_;
+        ++total_;
+    }
+
+    return appended;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void CanLogFile::flush() noexcept
+{
+    if (header_ != nullptr)
+    {
+        // a reader of a crashed log trusts this count only.
+        __atomic_store_n(&header_->count, static_cast< std::uint64_t >(count_),
+                         __ATOMIC_RELEASE);
+        msync(map_, sizeof(CanLogHeader) + (count_ * sizeof(CanLogRecord)),
+              MS_ASYNC);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool CanLogFile::file_name(char* path, const std::size_t size,
+                           const char* prefix,
+                           const std::uint64_t index) noexcept
+{
+    const int length =
+        std::snprintf(path, size, "%s.%llu.canlog", prefix,
+                      static_cast< unsigned long long >(index));
+    return (length > 0) && (static_cast< std::size_t >(length) < size);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool CanLogFile::open_file() noexcept
+{
+    bool opened{false};
+    std::array< char, MAX_PREFIX + 32U > path;
+    const auto index =
+        (max_files_ == 0U) ? sequence_ : (sequence_ % max_files_);
+    const std::size_t length =
+        sizeof(CanLogHeader) + (capacity_ * sizeof(CanLogRecord));
+
+    if (file_name(path.data(), path.size(), prefix_.data(), index))
+    {
+        fd_ = ::open(path.data(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    }
+
+    if (fd_ >= 0)
+    {
+        // reserve the blocks on disk now, a full disk must not raise SIGBUS
+        // while appending to the mapping.
+        int result = posix_fallocate(fd_, 0, static_cast< off_t >(length));
+
+        if ((result == EOPNOTSUPP) || (result == EINVAL))
+        {
+            result = (ftruncate(fd_, static_cast< off_t >(length)) == 0)
+                         ? 0
+                         : errno;
+        }
+
+        if (result == 0)
+        {
+            map_ = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED,
+                        fd_, 0);
+            opened = (map_ != MAP_FAILED);
+            result = opened ? 0 : errno;
+        }
+
+        last_error_ = result;
+    }
+    else
+    {
+        last_error_ = errno;
+    }
+
+    if (opened)
+    {
+        madvise(map_, length, MADV_SEQUENTIAL);
+        header_ = static_cast< CanLogHeader* >(map_);
+        std::memset(header_, 0, sizeof(CanLogHeader));
+        header_->magic = CAN_LOG_MAGIC;
+        header_->version = CAN_LOG_VERSION;
+        header_->record_size = sizeof(CanLogRecord);
+        header_->capacity = capacity_;
+        header_->sequence = sequence_;
+        records_ = reinterpret_cast< CanLogRecord* >(
+            static_cast< std::uint8_t* >(map_) + sizeof(CanLogHeader));
+        count_ = 0U;
+    }
+    else
+    {
+        map_ = nullptr;
+
+        if (fd_ >= 0)
+        {
+            ::close(fd_);
+            fd_ = -1;
+        }
+    }
+
+    return opened;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void CanLogFile::close_file() noexcept
+{
+    if (map_ != nullptr)
+    {
+        flush();
+        const std::size_t used =
+            sizeof(CanLogHeader) + (count_ * sizeof(CanLogRecord));
+        munmap(map_, sizeof(CanLogHeader) + (capacity_ * sizeof(CanLogRecord)));
+        // give back the preallocated space that was not used.
+        if (ftruncate(fd_, static_cast< off_t >(used)) != 0)
+        {
+            last_error_ = errno;
+        }
+        ::close(fd_);
+    }
+
+    fd_ = -1;
+    map_ = nullptr;
+    header_ = nullptr;
+    records_ = nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+CanLogReader::CanLogReader(const char* path) noexcept
+    : map_{nullptr}, length_{0U}, header_{nullptr}, records_{nullptr}
+{
+    const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    struct stat info;
+
+    if ((fd >= 0) && (fstat(fd, &info) == 0) &&
+        (static_cast< std::size_t >(info.st_size) >= sizeof(CanLogHeader)))
+    {
+        length_ = static_cast< std::size_t >(info.st_size);
+        void* map = mmap(nullptr, length_, PROT_READ, MAP_SHARED, fd, 0);
+
+        if (map != MAP_FAILED)
+        {
+            map_ = map;
+            const auto header = static_cast< const CanLogHeader* >(map_);
+
+            if ((header->magic == CAN_LOG_MAGIC) &&
+                (header->version == CAN_LOG_VERSION) &&
+                (header->record_size == sizeof(CanLogRecord)))
+            {
+                header_ = header;
+                records_ = reinterpret_cast< const CanLogRecord* >(
+                    static_cast< const std::uint8_t* >(map_) +
+                    sizeof(CanLogHeader));
+            }
+        }
+    }
+
+    if (fd >= 0)
+    {
+        ::close(fd);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+CanLogReader::~CanLogReader() noexcept
+{
+    if (map_ != nullptr)
+    {
+        munmap(map_, length_);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::size_t CanLogReader::size() const noexcept
+{
+    std::size_t count{0U};
+
+    if (header_ != nullptr)
+    {
+        // the file may be truncated or still being written.
+        const std::size_t stored =
+            (length_ - sizeof(CanLogHeader)) / sizeof(CanLogRecord);
+        const auto valid = static_cast< std::size_t >(
+            __atomic_load_n(&header_->count, __ATOMIC_ACQUIRE));
+        count = (valid < stored) ? valid : stored;
+    }
+
+    return count;
+}
@@ -0,0 +1,269 @@
+/**
+ * \file      CanLogFile.h
+ * \author    dtuchscherer <daniel.tuchscherer@gmail.com>
+ * \brief     Binary CAN log files
+ * \details   Fixed-size records of CAN frames in preallocated, memory mapped
+ *            files with rotation, and a reader for offline export.
+ * \copyright Copyright (c) 2018, Daniel Tuchscherer.
+ *            All rights reserved.
+ *
+ *            Redistributions and use in source and binary forms, with
+ *            or without modifications, are permitted provided that the
+ *            following conditions are met: Redistributions of source code must
+ *            retain the above copyright notice, this list of conditions and the
+ *            following disclaimer.
+ *
+ *            Redistributions in binary form must reproduce the above copyright
+ *            notice, this list of conditions and the following disclaimer in
+ *            the documentation and/or other materials provided with the
+ *            distribution.
+ *
+ *            Neither the name of the Heilbronn University nor the name of its
+ *            contributors may be used to endorse or promote products derived
+ *            from this software without specific prior written permission.
+ *
+ *            THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS “AS IS”
+ *            AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ *            TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ *            PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE REGENTS
+ *            OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *            SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *            LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *            USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *            AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *            LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *            ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *            POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CANLOGFILE_H_
+#define CANLOGFILE_H_
+#ifndef _WIN32
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <linux/can.h>
+
+/// the record marks a CAN FD frame.
+constexpr std::uint8_t CAN_LOG_FD{0x80U};
+
+/**
+ * \brief One CAN frame in a log file.
+ * \details All records have the same size, so the n-th record is found
+ * without parsing. Values are stored in host byte order.
+ */
+struct CanLogRecord
+{
+    /// receive time in nanoseconds since the epoch (CLOCK_REALTIME).
+    std::uint64_t timestamp_ns;
+    /// CAN identifier including the EFF/RTR/ERR flags.
+    std::uint32_t can_id;
+    /// CANFD_BRS and CANFD_ESI of the frame, CAN_LOG_FD for CAN FD frames.
+    std::uint8_t flags;
+    /// length of the payload in bytes.
+    std::uint8_t len;
+    /// the bus the frame was received on.
+    std::uint8_t channel;
+    std::uint8_t reserved;
+    /// the payload, bytes beyond len are zero.
+    std::array< std::uint8_t, CANFD_MAX_DLEN > data;
+};
+
+static_assert(sizeof(CanLogRecord) == 80U, "Records must not have padding.");
+
+/**
+ * \brief The header at the beginning of each log file.
+ */
+struct CanLogHeader
+{
+    /// "BSWCANLG"
+    std::array< char, 8U > magic;
+    /// format version.
+    std::uint32_t version;
+    /// sizeof(CanLogRecord).
+    std::uint32_t record_size;
+    /// records that fit into the file.
+    std::uint64_t capacity;
+    /// records that are valid, updated by every flush().
+    std::uint64_t count;
+    /// number of the file since the logger was started.
+    std::uint64_t sequence;
+    std::array< std::uint8_t, 24U > reserved;
+};
+
+static_assert(sizeof(CanLogHeader) == 64U, "The header must be 64 bytes.");
+
+/**
+ * \brief Appends records to preallocated, memory mapped files.
+ * \details The file is allocated on disk at once and mapped, so appending a
+ * record is a copy into memory: there is no system call and no iostream.
+ * The number of valid records in the header is updated by flush(), thus a
+ * crash loses only records since the last flush. When a file is full the
+ * next one is opened. Files are named "<prefix>.<n>.canlog"; with a limit of
+ * files the oldest one is overwritten.
+ * Only one thread may append.
+ */
+class CanLogFile
+{
+  public:
+    /// the longest path prefix accepted.
+    static constexpr std::size_t MAX_PREFIX{200U};
+
+    /**
+     * \brief Opens the first log file.
+     * \param[in] prefix path and base name of the files.
+     * \param[in] records_per_file capacity of each file.
+     * \param[in] max_files files to rotate through, 0 for no limit.
+     */
+    CanLogFile(const char* prefix, const std::size_t records_per_file,
+               const std::uint32_t max_files = 0U) noexcept;
+
+    /**
+     * \brief Flushes and closes the current file.
+     */
+    ~CanLogFile() noexcept;
+
+    CanLogFile(const CanLogFile&) = delete;
+    CanLogFile& operator=(const CanLogFile&) = delete;
+
+    /**
+     * \brief Checks if a file is open for appending.
+     */
+    bool is_open() const noexcept { return records_ != nullptr; }
+
+    /**
+     * \brief Copies the record to the end of the current file. Opens the next
+     * file if the current one is full.
+     * \param[in] record the record to append.
+     * \return true if appended, false if no file could be opened.
+     */
+    bool append(const CanLogRecord& record) noexcept;
+
+    /**
+     * \brief Publishes the appended records in the header of the file and
+     * starts writing them back to disk without waiting.
+     */
+    void flush() noexcept;
+
+    /**
+     * \brief The number of records appended to all files.
+     */
+    std::uint64_t records() const noexcept { return total_; }
+
+    /**
+     * \brief The number of the current file, starting at 0.
+     */
+    std::uint64_t sequence() const noexcept { return sequence_; }
+
+    /**
+     * \brief Writes the name of a log file.
+     * \param[out] path buffer for the name.
+     * \param[in] size the size of the buffer.
+     * \param[in] prefix path and base name of the files.
+     * \param[in] index the number of the file.
+     * \return true if the name fit into the buffer.
+     */
+    static bool file_name(char* path, const std::size_t size,
+                          const char* prefix,
+                          const std::uint64_t index) noexcept;
+
+    /**
+     * \brief The error number of the last failed operation.
+     */
+    int get_last_error() const noexcept { return last_error_; }
+
+  private:
+    bool open_file() noexcept;
+
+    void close_file() noexcept;
+
+    /// path and base name of the files.
+    std::array< char, MAX_PREFIX > prefix_;
+
+    /// capacity of each file.
+    std::size_t capacity_;
+
+    /// files to rotate through, 0 for no limit.
+    std::uint32_t max_files_;
+
+    /// file descriptor of the current file.
+    int fd_;
+
+    /// the mapping of the current file.
+    void* map_;
+
+    /// header of the current file.
+    CanLogHeader* header_;
+
+    /// first record of the current file.
+    CanLogRecord* records_;
+
+    /// records in the current file.
+    std::size_t count_;
+
+    /// number of the current file.
+    std::uint64_t sequence_;
+
+    /// records in all files.
+    std::uint64_t total_;
+
+    /// errno of the last failed operation.
+    int last_error_;
+};
+
+/**
+ * \brief Reads a log file for offline analysis or export.
+ */
+class CanLogReader
+{
+  public:
+    /**
+     * \brief Maps the file read-only and checks its header.
+     * \param[in] path the log file.
+     */
+    explicit CanLogReader(const char* path) noexcept;
+
+    ~CanLogReader() noexcept;
+
+    CanLogReader(const CanLogReader&) = delete;
+    CanLogReader& operator=(const CanLogReader&) = delete;
+
+    /**
+     * \brief Checks if the file is open and valid.
+     */
+    bool is_open() const noexcept { return header_ != nullptr; }
+
+    /**
+     * \brief The number of valid records.
+     */
+    std::size_t size() const noexcept;
+
+    /**
+     * \brief The records, size() in total.
+     */
+    const CanLogRecord* begin() const noexcept { return records_; }
+
+    const CanLogRecord* end() const noexcept { return records_ + size(); }
+
+    /**
+     * \brief The header of the file or nullptr.
+     */
+    const CanLogHeader* header() const noexcept { return header_; }
+
+  private:
+    /// the mapping of the file.
+    void* map_;
+
+    /// length of the mapping.
+    std::size_t length_;
+
+    /// header of the file if it is valid.
+    const CanLogHeader* header_;
+
+    /// first record.
+    const CanLogRecord* records_;
+};
+
+#endif /* _WIN32 */
+#endif /* CANLOGFILE_H_ */
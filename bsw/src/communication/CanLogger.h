@@ -0,0 +1,225 @@
+/**
+ * \file      CanLogger.h
+ * \author    dtuchscherer <daniel.tuchscherer@gmail.com>
+ * \brief     CAN bus logger pipeline
+ * \details   Receive threads hand batches of CAN frames over lock-free queues
+ *            to one writer appending them to a CanLogFile.
+ * \copyright Copyright (c) 2018, Daniel Tuchscherer.
+ *            All rights reserved.
+ *
+ *            Redistributions and use in source and binary forms, with
+ *            or without modifications, are permitted provided that the
+ *            following conditions are met: Redistributions of source code must
+ *            retain the above copyright notice, this list of conditions and the
+ *            following disclaimer.
+ *
+ *            Redistributions in binary form must reproduce the above copyright
+ *            notice, this list of conditions and the following disclaimer in
+ *            the documentation and/or other materials provided with the
+ *            distribution.
+ *
+ *            Neither the name of the Heilbronn University nor the name of its
+ *            contributors may be used to endorse or promote products derived
+ *            from this software without specific prior written permission.
+ *
+ *            THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS “AS IS”
+ *            AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ *            TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ *            PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE REGENTS
+ *            OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *            SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *            LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *            USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *            AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *            LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *            ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *            POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CANLOGGER_H_
+#define CANLOGGER_H_
+#ifndef _WIN32
+
+#include "CanLogFile.h"
+#include "CanSocket.h"
+#include "SpscQueue.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <time.h>
+#include <utility>
+
+/**
+ * \brief Logs all frames of several CAN busses into a CanLogFile.
+ * \details The pipeline has two stages. One receive thread per bus calls
+ * receive(), which takes all pending frames with one recvmmsg() and converts
+ * them in place into the slots of the queue of its bus. One writer thread
+ * calls write(), which moves the records of all queues into the file. Neither
+ * stage locks or allocates. A full queue is counted per bus in dropped().
+ * Enable timestamps on the sockets, frames without one are stamped when
+ * they are converted.
+ * \tparam Channels the number of busses.
+ * \tparam Capacity queue length per bus in frames, a power of two.
+ */
+template < std::size_t Channels, std::size_t Capacity = 8192U > class CanLogger
+{
+  public:
+    /**
+     * \brief Creates the queues of the busses.
+     * \param[in] file the file the writer appends to.
+     */
+    explicit CanLogger(CanLogFile& file) noexcept : file_(file)
+    {
+        for (auto& dropped : dropped_)
+        {
+            dropped.store(0U, std::memory_order_relaxed);
+        }
+    }
+
+    CanLogger(const CanLogger&) = delete;
+    CanLogger& operator=(const CanLogger&) = delete;
+
+    /**
+     * \brief Receive stage: waits for frames on the bus and queues all
+     * pending frames. Call it in a loop from the receive thread of the bus.
+     * \param[in] channel the bus, smaller than Channels.
+     * \param[in] can the socket of the bus.
+     * \param[in] deadline time to wait for the first frame.
+     * \return the number of frames received, 0 on timeout or -1 on error.
+     */
+    template < typename Duration >
+    std::int16_t receive(const std::uint8_t channel, CanSocket& can,
+                         const Duration&& deadline) noexcept
+    {
+        std::int16_t received{-1};
+
+        if (channel < Channels)
+        {
+            received = 0;
+
+            if (can.wait_for(std::move(deadline)))
+            {
+                received = can.receive_batch(frames_[channel].data(),
+                                             stamps_[channel].data(),
+                                             CanSocket::MAX_BATCH);
+            }
+
+            for (std::int16_t i = 0; i < received; ++i)
+            {
+                enqueue(channel, frames_[channel][i], stamps_[channel][i]);
+            }
+        }
+
+        return received;
+    }
+
+    /**
+     * \brief Writer stage: appends all queued records to the file and
+     * publishes them. Call it in a loop from the writer thread.
+     * \return the number of records written.
+     */
+    std::size_t write() noexcept
+    {
+        std::size_t written{0U};
+
+        for (auto& queue : queues_)
+        {
+            const CanLogRecord* record{nullptr};
+
+            while ((record = queue.front()) != nullptr)
+            {
+                if (file_.append(*record) == false)
+                {
+                    break;
+                }
+
+                queue.pop();
+                ++written;
+            }
+        }
+
+        if (written > 0U)
+        {
+            file_.flush();
+        }
+
+        return written;
+    }
+
+    /**
+     * \brief The number of frames lost on a bus because its queue was full.
+     */
+    std::uint64_t dropped(const std::uint8_t channel) const noexcept
+    {
+        return (channel < Channels)
+                   ? dropped_[channel].load(std::memory_order_relaxed)
+                   : 0U;
+    }
+
+    /**
+     * \brief The number of frames waiting for the writer on a bus.
+     */
+    std::size_t pending(const std::uint8_t channel) const noexcept
+    {
+        return (channel < Channels) ? queues_[channel].size() : 0U;
+    }
+
+  private:
+    void enqueue(const std::uint8_t channel, const CanFrame& frame,
+                 const RxTimestamp& stamp) noexcept
+    {
+        CanLogRecord* record = queues_[channel].prepare();
+
+        if (record != nullptr)
+        {
+            struct timespec time = stamp;
+
+            if ((time.tv_sec == 0) && (time.tv_nsec == 0))
+            {
+                clock_gettime(CLOCK_REALTIME, &time);
+            }
+
+            const std::uint8_t len =
+                (frame.len <= CANFD_MAX_DLEN) ? frame.len : CANFD_MAX_DLEN;
+            record->timestamp_ns =
+                (static_cast< std::uint64_t >(time.tv_sec) * 1000000000ULL) +
+                static_cast< std::uint64_t >(time.tv_nsec);
+            record->can_id = frame.can_id;
+            // classic frames carry no flags; a CAN FD frame of up to 8 bytes
+            // without BRS is only recognized on kernels setting CANFD_FDF.
+            record->flags = frame.flags & (CANFD_BRS | CANFD_ESI);
+            record->flags |=
+                ((len > CAN_MAX_DLEN) || (frame.flags != 0U)) ? CAN_LOG_FD : 0U;
+            record->len = len;
+            record->channel = channel;
+            record->reserved = 0U;
+            record->data.fill(0U);
+            std::memcpy(record->data.data(), frame.data, len);
+            queues_[channel].commit();
+        }
+        else
+        {
+            dropped_[channel].fetch_add(1U, std::memory_order_relaxed);
+        }
+    }
+
+    /// the file the writer appends to.
+    CanLogFile& file_;
+
+    /// one queue per bus between its receive thread and the writer.
+    std::array< SpscQueue< CanLogRecord, Capacity >, Channels > queues_;
+
+    /// receive buffers, used by the receive thread of each bus only.
+    std::array< std::array< CanFrame, CanSocket::MAX_BATCH >, Channels >
+        frames_;
+    std::array< std::array< RxTimestamp, CanSocket::MAX_BATCH >, Channels >
+        stamps_;
+
+    /// frames lost per bus.
+    std::array< std::atomic< std::uint64_t >, Channels > dropped_;
+};
+
+#endif /* _WIN32 */
+#endif /* CANLOGGER_H_ */
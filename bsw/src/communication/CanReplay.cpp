@@ -0,0 +1,208 @@
+/**
+ * \file      CanReplay.cpp
+ * \author    dtuchscherer <daniel.tuchscherer@gmail.com>
+ * \brief     Timing-accurate replay of CAN logs
+ * \details   These are the methods of class CanReplay to schedule and send
+ *            the records of a CAN log.
+ * \copyright Copyright (c) 2018, Daniel Tuchscherer.
+ *            All rights reserved.
+ *
+ *            Redistributions and use in source and binary forms, with
+ *            or without modifications, are permitted provided that the
+ *            following conditions are met: Redistributions of source code must
+ *            retain the above copyright notice, this list of conditions and the
+ *            following disclaimer.
+ *
+ *            Redistributions in binary form must reproduce the above copyright
+ *            notice, this list of conditions and the following disclaimer in
+ *            the documentation and/or other materials provided with the
+ *            distribution.
+ *
+ *            Neither the name of the Heilbronn University nor the name of its
+ *            contributors may be used to endorse or promote products derived
+ *            from this software without specific prior written permission.
+ *
+ *            THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS “AS IS”
+ *            AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ *            TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ *            PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE REGENTS
+ *            OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *            SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *            LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *            USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *            AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *            LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *            ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *            POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef _WIN32
+#error "SocketCAN for Linux OS only."
+#endif
+#include "CanReplay.h"
+#include <cstring>
+#include <time.h>
+
+constexpr double CanReplay::AS_FAST_AS_POSSIBLE;
+constexpr std::size_t CanReplay::BATCH;
+
+/// lead time between the call of play() and the first frame.
+static constexpr std::int64_t REPLAY_LEAD_NS{1000000};
+
+////////////////////////////////////////////////////////////////////////////////
+static std::int64_t monotonic_ns() noexcept
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (static_cast< std::int64_t >(t.tv_sec) * 1000000000LL) + t.tv_nsec;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+static void sleep_until(const std::int64_t time_ns) noexcept
+{
+    struct timespec t;
+    t.tv_sec = static_cast< time_t >(time_ns / 1000000000LL);
+    t.tv_nsec = static_cast< long >(time_ns % 1000000000LL);
+
+    // restart if a signal interrupted the sleep.
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &t, NULL) == EINTR)
+    {
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+CanReplay::CanReplay(CanSocket& can, const std::int64_t bucket_ns) noexcept
+    : can_(can), batch_{}, bucket_ns_{(bucket_ns > 0) ? bucket_ns : 1},
+      speed_{1.0}, channel_{-1}, running_{false}, start_ns_{0}, first_ns_{0U},
+      lateness_{}, frames_sent_{0U}, batches_sent_{0U}
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void CanReplay::set_speed(const double factor) noexcept
+{
+    speed_ = (factor > 0.0) ? factor : AS_FAST_AS_POSSIBLE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool CanReplay::play(const CanLogRecord* begin,
+                     const CanLogRecord* end) noexcept
+{
+    lateness_.reset();
+    frames_sent_ = 0U;
+    batches_sent_ = 0U;
+    batch_.clear();
+    running_.store(true, std::memory_order_relaxed);
+    const bool timed = (speed_ != AS_FAST_AS_POSSIBLE);
+    bool sent_all{true};
+
+    if ((begin != nullptr) && (begin < end))
+    {
+        first_ns_ = begin->timestamp_ns;
+        start_ns_ = monotonic_ns() + REPLAY_LEAD_NS;
+    }
+
+    const CanLogRecord* record = begin;
+
+    while ((record != nullptr) && (record < end) && sent_all &&
+           running_.load(std::memory_order_relaxed))
+    {
+        // the bucket starts with the release time of its first frame.
+        const std::int64_t release = timed ? release_time(*record) : 0;
+        const CanLogRecord* first = record;
+
+        while ((record < end) && (!batch_.full()) &&
+               ((!timed) || (release_time(*record) < (release + bucket_ns_))))
+        {
+            if ((channel_ < 0) || (record->channel == channel_))
+            {
+                stage(*record);
+            }
+
+            ++record;
+        }
+
+        if (timed)
+        {
+            sleep_until(release);
+        }
+
+        const std::size_t frames = batch_.pending();
+        sent_all = flush();
+
+        if (timed && sent_all)
+        {
+            const std::int64_t sent_ns = monotonic_ns();
+
+            for (const CanLogRecord* r = first; r < record; ++r)
+            {
+                if ((channel_ < 0) || (r->channel == channel_))
+                {
+                    lateness_.record(sent_ns - release_time(*r));
+                }
+            }
+        }
+
+        if (sent_all && (frames > 0U))
+        {
+            frames_sent_ += frames;
+            ++batches_sent_;
+        }
+    }
+
+    return sent_all && (record == end);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool CanReplay::stage(const CanLogRecord& record) noexcept
+{
+    const bool canfd = (record.flags & CAN_LOG_FD) != 0U;
+    CanFrame* frame = batch_.stage(canfd);
+
+    if (frame != nullptr)
+    {
+        const std::uint8_t max_len = canfd ? CANFD_MAX_DLEN : CAN_MAX_DLEN;
+        frame->can_id = record.can_id;
+        frame->len = (record.len < max_len) ? record.len : max_len;
+        frame->flags = canfd ? (record.flags & (CANFD_BRS | CANFD_ESI)) : 0U;
+        std::memcpy(frame->data, record.data.data(), frame->len);
+    }
+
+    return (frame != nullptr);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool CanReplay::flush() noexcept
+{
+    bool sent{true};
+
+    while (sent && (batch_.empty() == false))
+    {
+        // zero frames are sent while the transmit queue is full.
+        const auto frames = can_.send_batch(batch_);
+
+        if (frames < 0)
+        {
+            sent = false;
+            batch_.clear();
+        }
+        else if (frames == 0)
+        {
+            // wait for the interface to drain its queue.
+            sleep_until(monotonic_ns() + 50000);
+        }
+    }
+
+    return sent;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::int64_t CanReplay::release_time(const CanLogRecord& record) const noexcept
+{
+    // records older than the first one are released immediately.
+    const auto delta = (record.timestamp_ns > first_ns_)
+                           ? (record.timestamp_ns - first_ns_)
+                           : 0U;
+    const auto offset = static_cast< double >(delta) / speed_;
+    return start_ns_ + static_cast< std::int64_t >(offset);
+}
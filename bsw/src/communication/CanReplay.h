@@ -0,0 +1,177 @@
+/**
+ * \file      CanReplay.h
+ * \author    dtuchscherer <daniel.tuchscherer@gmail.com>
+ * \brief     Timing-accurate replay of CAN logs
+ * \details   Sends the records of a CAN log file at their recorded times
+ *            relative to the start, optionally faster.
+ * \copyright Copyright (c) 2018, Daniel Tuchscherer.
+ *            All rights reserved.
+ *
+ *            Redistributions and use in source and binary forms, with
+ *            or without modifications, are permitted provided that the
+ *            following conditions are met: Redistributions of source code must
+ *            retain the above copyright notice, this list of conditions and the
+ *            following disclaimer.
+ *
+ *            Redistributions in binary form must reproduce the above copyright
+ *            notice, this list of conditions and the following disclaimer in
+ *            the documentation and/or other materials provided with the
+ *            distribution.
+ *
+ *            Neither the name of the Heilbronn University nor the name of its
+ *            contributors may be used to endorse or promote products derived
+ *            from this software without specific prior written permission.
+ *
+ *            THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS “AS IS”
+ *            AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ *            TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ *            PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE REGENTS
+ *            OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *            SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *            LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *            USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *            AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *            LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *            ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *            POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CANREPLAY_H_
+#define CANREPLAY_H_
+#ifndef _WIN32
+
+#include "CanLogFile.h"
+#include "CanSocket.h"
+#include "TaskStatistics.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * \brief Replays recorded CAN traffic with the timing of the recording.
+ * \details The records are scheduled on absolute times of CLOCK_MONOTONIC
+ * with clock_nanosleep(TIMER_ABSTIME) like the real-time tasks, so the jitter
+ * does not accumulate. Frames whose release times fall into the same bucket
+ * are sent together with one sendmmsg(). The lateness of every frame, the
+ * time it was sent after its requested time, is recorded in a histogram.
+ * Frames within a bucket are sent up to one bucket early; this is not counted
+ * as lateness.
+ * Call play() from a real-time thread for the best timing.
+ */
+class CanReplay
+{
+  public:
+    /// replay without waiting between frames.
+    static constexpr double AS_FAST_AS_POSSIBLE{0.0};
+
+    /// frames sent with one system call at most.
+    static constexpr std::size_t BATCH{64U};
+
+    /// histogram of the lateness: 1000 buckets of 1 us.
+    using Lateness = LatencyHistogram< 1000U, 1000 >;
+
+    /**
+     * \brief Creates a replay on a socket.
+     * \param[in] can the socket frames are sent to.
+     * \param[in] bucket_ns frames released within this time are sent
+     * together, at least 1 ns: values of 0 or less only group frames of the
+     * same release time.
+     */
+    explicit CanReplay(CanSocket& can,
+                       const std::int64_t bucket_ns = 100000) noexcept;
+
+    /**
+     * \brief Sets the speed of the replay.
+     * \param[in] factor 1.0 for the recorded timing, 10.0 for ten times
+     * faster or AS_FAST_AS_POSSIBLE.
+     */
+    void set_speed(const double factor) noexcept;
+
+    /**
+     * \brief Replays the records of one bus only.
+     * \param[in] channel the bus or -1 for all busses.
+     */
+    void set_channel(const int channel) noexcept { channel_ = channel; }
+
+    /**
+     * \brief Sends the records at their recorded times relative to the
+     * first record. Returns when all records are sent or stop() was called.
+     * \param[in] begin the first record.
+     * \param[in] end behind the last record.
+     * \return true if all records were sent, false if stopped or if sending
+     * failed.
+     */
+    bool play(const CanLogRecord* begin, const CanLogRecord* end) noexcept;
+
+    /**
+     * \brief Sends all records of a log file.
+     */
+    bool play(const CanLogReader& reader) noexcept
+    {
+        return play(reader.begin(), reader.end());
+    }
+
+    /**
+     * \brief Stops a running play(); may be called from any thread.
+     */
+    void stop() noexcept { running_.store(false, std::memory_order_relaxed); }
+
+    /**
+     * \brief The lateness of the frames sent by the last play().
+     */
+    const Lateness& lateness() const noexcept { return lateness_; }
+
+    /**
+     * \brief The number of frames sent by the last play().
+     */
+    std::uint64_t frames_sent() const noexcept { return frames_sent_; }
+
+    /**
+     * \brief The number of sendmmsg() batches of the last play().
+     */
+    std::uint64_t batches_sent() const noexcept { return batches_sent_; }
+
+  private:
+    /// stages the frame of a record.
+    bool stage(const CanLogRecord& record) noexcept;
+
+    /// sends all staged frames, retrying while the transmit queue is full.
+    bool flush() noexcept;
+
+    /// the release time of a record in ns of CLOCK_MONOTONIC.
+    std::int64_t release_time(const CanLogRecord& record) const noexcept;
+
+    /// the socket frames are sent to.
+    CanSocket& can_;
+
+    /// the frames of the current bucket.
+    CanTxBatch< BATCH > batch_;
+
+    /// length of a bucket in ns.
+    std::int64_t bucket_ns_;
+
+    /// the speed factor, AS_FAST_AS_POSSIBLE for no waiting.
+    double speed_;
+
+    /// bus to replay or -1 for all.
+    int channel_;
+
+    /// false if play() shall return.
+    std::atomic< bool > running_;
+
+    /// start of the replay in ns of CLOCK_MONOTONIC.
+    std::int64_t start_ns_;
+
+    /// timestamp of the first record.
+    std::uint64_t first_ns_;
+
+    /// lateness of each frame sent.
+    Lateness lateness_;
+
+    /// frames and batches sent.
+    std::uint64_t frames_sent_;
+    std::uint64_t batches_sent_;
+};
+
+#endif /* _WIN32 */
+#endif /* CANREPLAY_H_ */
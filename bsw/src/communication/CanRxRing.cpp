@@ -0,0 +1,271 @@
+/**
+ * \file      CanRxRing.cpp
+ * \author    dtuchscherer <daniel.tuchscherer@gmail.com>
+ * \brief     Zero-copy CAN receive ring
+ * \details   These are the methods of class CanRxRing to set up and
+ *            consume the memory mapped receive ring of a CAN interface.
+ * \copyright Copyright (c) 2018, Daniel Tuchscherer.
+ *            All rights reserved.
+ *
+ *            Redistributions and use in source and binary forms, with
+ *            or without modifications, are permitted provided that the
+ *            following conditions are met: Redistributions of source code must
+ *            retain the above copyright notice, this list of conditions and the
+ *            following disclaimer.
+ *
+ *            Redistributions in binary form must reproduce the above copyright
+ *            notice, this list of conditions and the following disclaimer in
+ *            the documentation and/or other materials provided with the
+ *            distribution.
+ *
+ *            Neither the name of the Heilbronn University nor the name of its
+ *            contributors may be used to endorse or promote products derived
+ *            from this software without specific prior written permission.
+ *
+ *            THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS “AS IS”
+ *            AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ *            TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ *            PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE REGENTS
+ *            OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *            SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *            LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *            USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *            AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *            LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *            ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *            POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef _WIN32
+#error "SocketCAN for Linux OS only."
+#endif
+#include "CanRxRing.h"
+#include <arpa/inet.h>      // htons
+#include <linux/filter.h>   // drop all but CAN and CAN FD frames
+#include <linux/if_ether.h> // ETH_P_ALL, ETH_P_CAN
+#include <sys/mman.h>
+
+constexpr std::uint32_t CanRxRing::BLOCK_SIZE;
+constexpr std::uint32_t CanRxRing::FRAME_SIZE;
+
+////////////////////////////////////////////////////////////////////////////////
+CanRxFrame CanRxRing::Block::Iterator::operator*() const noexcept
+{
+    const auto header = reinterpret_cast< const struct tpacket3_hdr* >(header_);
+    CanRxFrame rx;
+    rx.frame =
+        reinterpret_cast< const struct canfd_frame* >(header_ + header->tp_mac);
+    rx.mtu = (header->tp_snaplen >= CANFD_MTU) ? CANFD_MTU : CAN_MTU;
+    rx.stamp.tv_sec = static_cast< time_t >(header->tp_sec);
+    rx.stamp.tv_nsec = static_cast< long >(header->tp_nsec);
+    return rx;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+CanRxRing::Block::Iterator& CanRxRing::Block::Iterator::operator++() noexcept
+{
+    const auto header = reinterpret_cast< const struct tpacket3_hdr* >(header_);
+    header_ += header->tp_next_offset;
+    --remaining_;
+    return *this;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+CanRxRing::Block::Iterator CanRxRing::Block::begin() const noexcept
+{
+    const std::uint8_t* first{nullptr};
+
+    if (desc_ != nullptr)
+    {
+        const auto desc = reinterpret_cast< struct tpacket_block_desc* >(desc_);
+        first = desc_ + desc->hdr.bh1.offset_to_first_pkt;
+    }
+
+    return Iterator{first, size()};
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::uint32_t CanRxRing::Block::size() const noexcept
+{
+    std::uint32_t frames{0U};
+
+    if (desc_ != nullptr)
+    {
+        frames = reinterpret_cast< struct tpacket_block_desc* >(desc_)
+                     ->hdr.bh1.num_pkts;
+    }
+
+    return frames;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+CanRxRing::~CanRxRing() noexcept
+{
+    if (ring_ != nullptr)
+    {
+        munmap(ring_, ring_size_);
+        ring_ = nullptr;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool CanRxRing::create() noexcept
+{
+    bool socket_created{false};
+    // the protocol is set by bind(), nothing is queued before.
+    socket_ = socket(AF_PACKET, SOCK_RAW, 0);
+
+    // check here if the socket was opened.
+    if (get_socket_handle() > 0)
+    {
+        socket_created = true;
+    }
+    else
+    {
+        last_error_ = errno;
+        socket_created = false;
+        std::cerr << "Opening the packet socket failed, CAP_NET_RAW missing?\n";
+    }
+
+    return socket_created;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool CanRxRing::next_block(Block& block) noexcept
+{
+    bool taken{false};
+    block.desc_ = nullptr;
+
+    if (is_ring_initialized())
+    {
+        const auto desc = reinterpret_cast< struct tpacket_block_desc* >(
+            ring_ + (static_cast< std::size_t >(current_) * BLOCK_SIZE));
+        const auto status = __atomic_load_n(&desc->hdr.bh1.block_status,
+                                            __ATOMIC_ACQUIRE);
+
+        if ((status & TP_STATUS_USER) != 0U)
+        {
+            block.desc_ = reinterpret_cast< std::uint8_t* >(desc);
+            current_ = (current_ + 1U) % block_count_;
+            taken = true;
+        }
+    }
+
+    return taken;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void CanRxRing::release(Block& block) noexcept
+{
+    if (block.desc_ != nullptr)
+    {
+        const auto desc =
+            reinterpret_cast< struct tpacket_block_desc* >(block.desc_);
+        __atomic_store_n(&desc->hdr.bh1.block_status, TP_STATUS_KERNEL,
+                         __ATOMIC_RELEASE);
+        block.desc_ = nullptr;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::uint32_t CanRxRing::drops() noexcept
+{
+    std::uint32_t dropped{0U};
+    struct tpacket_stats_v3 stats;
+    socklen_t len = sizeof(stats);
+    const auto handle = get_socket_handle();
+
+    if (getsockopt(handle, SOL_PACKET, PACKET_STATISTICS, &stats, &len) == 0)
+    {
+        dropped = stats.tp_drops;
+    }
+    else
+    {
+        last_error_ = errno;
+    }
+
+    return dropped;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool CanRxRing::map_ring(const unsigned int ifindex,
+                         const std::uint32_t retire_ms) noexcept
+{
+    bool mapped{false};
+    const auto handle = get_socket_handle();
+    int version = TPACKET_V3;
+
+    struct tpacket_req3 request;
+    std::memset(&request, 0, sizeof(request));
+    request.tp_block_size = BLOCK_SIZE;
+    request.tp_block_nr = block_count_;
+    request.tp_frame_size = FRAME_SIZE;
+    request.tp_frame_nr = (BLOCK_SIZE / FRAME_SIZE) * block_count_;
+    request.tp_retire_blk_tov = retire_ms;
+
+    // CAN and CAN FD frames arrive with different protocols, a packet socket
+    // binds to one or to all. The kernel drops everything else, e.g. CAN XL
+    // frames, which do not have the layout of struct canfd_frame.
+    std::array< struct sock_filter, 5U > program{
+        {BPF_STMT(BPF_LD | BPF_H | BPF_ABS,
+                  static_cast< std::uint32_t >(SKF_AD_OFF + SKF_AD_PROTOCOL)),
+         BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, ETH_P_CAN, 1U, 0U),
+         BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, ETH_P_CANFD, 0U, 1U),
+         BPF_STMT(BPF_RET | BPF_K, 0xFFFFFFFFU),
+         BPF_STMT(BPF_RET | BPF_K, 0U)}};
+    struct sock_fprog filter;
+    filter.len = static_cast< unsigned short >(program.size());
+    filter.filter = program.data();
+
+    struct sockaddr_ll address;
+    std::memset(&address, 0, sizeof(address));
+    address.sll_family = AF_PACKET;
+    address.sll_protocol = htons(ETH_P_ALL);
+    address.sll_ifindex = static_cast< int >(ifindex);
+
+    if ((block_count_ == 0U) ||
+        (setsockopt(handle, SOL_PACKET, PACKET_VERSION, &version,
+                    sizeof(version)) < 0) ||
+        (setsockopt(handle, SOL_PACKET, PACKET_RX_RING, &request,
+                    sizeof(request)) < 0) ||
+        (setsockopt(handle, SOL_SOCKET, SO_ATTACH_FILTER, &filter,
+                    sizeof(filter)) < 0))
+    {
+        last_error_ = errno;
+        std::cerr << "Setting up the CAN receive ring failed.\n";
+    }
+    else
+    {
+#ifdef PACKET_IGNORE_OUTGOING
+        // frames sent by this host are not received; older kernels lack
+        // this. It is set before bind() so no such frame is queued.
+        int ignore_outgoing = 1;
+        setsockopt(handle, SOL_PACKET, PACKET_IGNORE_OUTGOING, &ignore_outgoing,
+                   sizeof(ignore_outgoing));
+#endif
+        // the ring is locked by the mlockall() of a real-time task, locking
+        // it here fails as soon as it exceeds RLIMIT_MEMLOCK.
+        ring_size_ = static_cast< std::size_t >(BLOCK_SIZE) * block_count_;
+        void* ring = mmap(nullptr, ring_size_, PROT_READ | PROT_WRITE,
+                          MAP_SHARED, handle, 0);
+
+        if (ring == MAP_FAILED)
+        {
+            last_error_ = errno;
+            std::cerr << "Mapping the CAN receive ring failed.\n";
+        }
+        else if (bind(handle, (struct sockaddr*)&address, sizeof(address)) < 0)
+        {
+            last_error_ = errno;
+            munmap(ring, ring_size_);
+            std::cerr << "Binding the CAN receive ring failed.\n";
+        }
+        else
+        {
+            ring_ = static_cast< std::uint8_t* >(ring);
+            mapped = true;
+        }
+    }
+
+    return mapped;
+}
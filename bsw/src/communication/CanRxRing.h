@@ -0,0 +1,264 @@
+/**
+ * \file      CanRxRing.h
+ * \author    dtuchscherer <daniel.tuchscherer@gmail.com>
+ * \brief     Zero-copy CAN receive ring
+ * \details   Maps a PACKET_RX_RING of a CAN interface and exposes the
+ *            received frames in place, without a copy or syscall per frame.
+ * \copyright Copyright (c) 2018, Daniel Tuchscherer.
+ *            All rights reserved.
+ *
+ *            Redistributions and use in source and binary forms, with
+ *            or without modifications, are permitted provided that the
+ *            following conditions are met: Redistributions of source code must
+ *            retain the above copyright notice, this list of conditions and the
+ *            following disclaimer.
+ *
+ *            Redistributions in binary form must reproduce the above copyright
+ *            notice, this list of conditions and the following disclaimer in
+ *            the documentation and/or other materials provided with the
+ *            distribution.
+ *
+ *            Neither the name of the Heilbronn University nor the name of its
+ *            contributors may be used to endorse or promote products derived
+ *            from this software without specific prior written permission.
+ *
+ *            THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS “AS IS”
+ *            AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ *            TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ *            PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE REGENTS
+ *            OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *            SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *            LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *            USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *            AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *            LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *            ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *            POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CANRXRING_H_
+#define CANRXRING_H_
+#ifndef _WIN32
+
+#include "CanSocket.h" // CAN data types
+#include "Socket.h"
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <linux/can.h>
+#include <linux/if_packet.h> // PACKET_RX_RING, TPACKET_V3
+#include <net/if.h>
+
+/**
+ * \brief A CAN frame in the receive ring.
+ * \details The frame points into the ring and is valid until its block is
+ * released. Standard frames share the layout of struct canfd_frame up to
+ * the length of the payload.
+ */
+struct CanRxFrame
+{
+    /// the frame, standard CAN or CAN FD.
+    const struct canfd_frame* frame;
+    /// CAN_MTU for standard CAN frames, CANFD_MTU for CAN FD frames.
+    std::uint8_t mtu;
+    /// the time the kernel received the frame.
+    RxTimestamp stamp;
+
+    /// the CAN identifier including the EFF/RTR/ERR flags.
+    CanIDType can_id() const noexcept { return frame->can_id; }
+    /// the length of the payload.
+    std::uint8_t len() const noexcept { return frame->len; }
+    /// the payload.
+    const std::uint8_t* data() const noexcept { return frame->data; }
+    /// true if this is a CAN FD frame.
+    bool is_fd() const noexcept { return mtu == CANFD_MTU; }
+};
+
+/**
+ * \brief Receives CAN frames through a memory mapped TPACKET_V3 ring.
+ * \details The kernel writes the frames of one interface into blocks of a
+ * ring shared with the process. A block is handed over when it is full or
+ * after the retire timeout, so a bus at full load costs one wakeup per block
+ * instead of one read() per frame. The frames are read in place; releasing
+ * the block gives its memory back to the kernel.
+ * Copies of outgoing frames are ignored, echoed frames of the interface are
+ * received like frames of other nodes. The socket handle can be waited
+ * for like any other socket, e.g. by wait_for() or an EventLoop.
+ * Opening the ring needs CAP_NET_RAW. If it is not possible, use CanSocket
+ * with receive_batch() instead.
+ */
+class CanRxRing : public Socket< CanRxRing >
+{
+  public:
+    /// size of one block, a multiple of the page size.
+    static constexpr std::uint32_t BLOCK_SIZE{1U << 16U};
+
+    /// space for one frame including the headers of the ring.
+    static constexpr std::uint32_t FRAME_SIZE{256U};
+
+    /**
+     * \brief A block of frames owned by the process until it is released.
+     */
+    class Block
+    {
+      public:
+        /**
+         * \brief Iterates over the frames of a block.
+         */
+        class Iterator
+        {
+          public:
+            Iterator(const std::uint8_t* header,
+                     const std::uint32_t remaining) noexcept
+                : header_{header}, remaining_{remaining}
+            {
+            }
+
+            CanRxFrame operator*() const noexcept;
+
+            Iterator& operator++() noexcept;
+
+            bool operator!=(const Iterator& other) const noexcept
+            {
+                return remaining_ != other.remaining_;
+            }
+
+          private:
+            /// the struct tpacket3_hdr of the current frame.
+            const std::uint8_t* header_;
+            /// frames left including the current one.
+            std::uint32_t remaining_;
+        };
+
+        Block() noexcept = default;
+
+        Iterator begin() const noexcept;
+
+        Iterator end() const noexcept { return Iterator{nullptr, 0U}; }
+
+        /// the number of frames in the block.
+        std::uint32_t size() const noexcept;
+
+        /// true if the block holds no frames or none was taken.
+        bool empty() const noexcept { return size() == 0U; }
+
+      private:
+        friend class CanRxRing;
+
+        /// the struct tpacket_block_desc or nullptr.
+        std::uint8_t* desc_{nullptr};
+    };
+
+    /**
+     * \brief Opens and maps the receive ring of the interface.
+     * \param[in] interface_str interface name, e.g. "can0", "vcan0"
+     * \param[in] block_count number of blocks of BLOCK_SIZE bytes.
+     * \param[in] retire_ms the kernel hands over a block that is not full
+     * after this time in milliseconds.
+     */
+    template < std::size_t N >
+    explicit CanRxRing(const char (&interface_str)[N],
+                       const std::uint32_t block_count = 32U,
+                       const std::uint32_t retire_ms = 10U) noexcept
+        : Socket{}, ring_{nullptr}, ring_size_{0U}, block_count_{block_count},
+          current_{0U}
+    {
+        if (is_socket_initialized())
+        {
+            const auto ifindex = if_nametoindex(interface_str);
+
+            if (ifindex != 0U)
+            {
+                map_ring(ifindex, retire_ms);
+            }
+            else
+            {
+                std::cerr << "CAN interface " << interface_str
+                          << " you've specified is not found!\n";
+            }
+        }
+    }
+
+    /**
+     * \brief Unmaps the ring, the socket is closed by the base class.
+     */
+    ~CanRxRing() noexcept;
+
+    CanRxRing(const CanRxRing&) = delete;
+    CanRxRing& operator=(const CanRxRing&) = delete;
+
+    /**
+     * \brief Create the packet socket; this is called by the base class.
+     * \return true if the socket is opened or false if there was an error.
+     */
+    bool create() noexcept;
+
+    /**
+     * \brief Checks if the ring is mapped and bound to the interface.
+     */
+    bool is_ring_initialized() const noexcept { return ring_ != nullptr; }
+
+    /**
+     * \brief Takes the next block the kernel has handed over. Does not block.
+     * \param[out] block the block, it must be released before the next one
+     * can be taken.
+     * \return true if a block was taken, false if none is ready.
+     */
+    bool next_block(Block& block) noexcept;
+
+    /**
+     * \brief Gives the memory of a block back to the kernel.
+     * \param[in,out] block a block taken by next_block(), empty afterwards.
+     */
+    void release(Block& block) noexcept;
+
+    /**
+     * \brief Calls f(const CanRxFrame&) for every frame of all blocks that
+     * are ready and releases them.
+     * \return the number of frames.
+     */
+    template < typename F > std::size_t for_each(F&& f) noexcept
+    {
+        std::size_t frames{0U};
+        Block block;
+
+        while (next_block(block))
+        {
+            for (const auto& frame : block)
+            {
+                f(frame);
+            }
+
+            frames += block.size();
+            release(block);
+        }
+
+        return frames;
+    }
+
+    /**
+     * \brief Reads and resets the statistics of the kernel.
+     * \return the number of frames dropped because the ring was full since
+     * the last call.
+     */
+    std::uint32_t drops() noexcept;
+
+  private:
+    bool map_ring(const unsigned int ifindex,
+                  const std::uint32_t retire_ms) noexcept;
+
+    /// the mapped ring.
+    std::uint8_t* ring_;
+
+    /// length of the mapping in bytes.
+    std::size_t ring_size_;
+
+    /// number of blocks in the ring.
+    std::uint32_t block_count_;
+
+    /// index of the block to take next.
+    std::uint32_t current_;
+};
+
+#endif /* _WIN32 */
+#endif /* CANRXRING_H_ */
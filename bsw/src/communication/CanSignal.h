@@ -0,0 +1,496 @@
+/**
+ * \file      CanSignal.h
+ * \author    dtuchscherer <daniel.tuchscherer@gmail.com>
+ * \brief     CAN signal codec
+ * \details   Describes the signals of CAN messages by bit position, length,
+ *            byte order, factor and offset and packs or unpacks them with
+ *            kernels generated at compile-time.
+ * \copyright Copyright (c) 2018, dtuchscherer.
+ *            All rights reserved.
+ *
+ *            Redistributions and use in source and binary forms, with
+ *            or without modifications, are permitted provided that the
+ *            following conditions are met: Redistributions of source code must
+ *            retain the above copyright notice, this list of conditions and the
+ *            following disclaimer.
+ *
+ *            Redistributions in binary form must reproduce the above copyright
+ *            notice, this list of conditions and the following disclaimer in
+ *            the documentation and/or other materials provided with the
+ *            distribution.
+ *
+ *            Neither the name of the Heilbronn University nor the name of its
+ *            contributors may be used to endorse or promote products derived
+ *            from this software without specific prior written permission.
+ *
+ *            THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS “AS IS”
+ *            AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ *            TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ *            PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE REGENTS
+ *            OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *            SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *            LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *            USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *            AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *            LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *            ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *            POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CANSIGNAL_H_
+#define CANSIGNAL_H_
+
+#include "CanSocket.h"
+#include <algorithm>
+#include <cmath>
+#include <ratio>
+#include <type_traits>
+
+/**
+ * \brief The byte order of a signal as it is defined in a CAN database.
+ */
+enum class ByteOrder
+{
+    INTEL,   ///< little endian, start bit is the least significant bit.
+    MOTOROLA ///< big endian, start bit is the most significant bit.
+};
+
+/**
+ * \brief One signal of a CAN message with bit-level position.
+ * \details The bit position, the length and the byte order are template
+ * parameters, thus the bytes touched, the shift and the mask are computed at
+ * compile-time and every pack and unpack is a short straight-line kernel.
+ * The bits are numbered like in a DBC file: bit n is bit (n % 8) of byte
+ * (n / 8), where bit 0 is the least significant bit of the byte.
+ * \tparam StartBit the start bit as given in the DBC file.
+ * \tparam Length the signal length in bits.
+ * \tparam Order the byte order of the signal.
+ * \tparam Signed true if the raw value is two's complement.
+ * \tparam Factor the scaling factor as std::ratio, e.g. std::ratio< 1, 10 >.
+ * \tparam Offset the offset as std::ratio, e.g. std::ratio< -40 >.
+ */
+template < std::size_t StartBit, std::size_t Length,
+           ByteOrder Order = ByteOrder::INTEL, bool Signed = false,
+           typename Factor = std::ratio< 1 >,
+           typename Offset = std::ratio< 0 > >
+class CanSignal
+{
+  public:
+    static_assert((Length > 0U) && (Length <= 64U),
+                  "The signal length must be between 1 and 64 bits.");
+
+    /// type of the raw (unscaled) value.
+    using RawType =
+        typename std::conditional< Signed, std::int64_t, std::uint64_t >::type;
+
+  private:
+    /// position of the start bit within its byte.
+    static constexpr std::size_t start_bit_in_byte = StartBit % 8U;
+
+    /// Motorola: number of bits in front of the signal within the first byte.
+    static constexpr std::size_t leading_bits =
+        (Order == ByteOrder::INTEL) ? start_bit_in_byte
+                                    : (7U - start_bit_in_byte);
+
+  public:
+    /// first byte of the payload the signal occupies.
+    static constexpr std::size_t first_byte = StartBit / 8U;
+
+    /// number of bytes the signal occupies.
+    static constexpr std::size_t byte_count = (leading_bits + Length + 7U) / 8U;
+
+    /// one past the last byte of the payload the signal occupies.
+    static constexpr std::size_t end_byte = first_byte + byte_count;
+
+    static_assert(byte_count <= 8U,
+                  "A signal must not span more than 8 bytes.");
+
+    /**
+     * \brief Extracts the raw value of the signal.
+     * \param[in] data the payload of the message. Must hold end_byte bytes.
+     * \return the raw value, sign-extended if the signal is signed.
+     */
+    static RawType unpack(const std::uint8_t* data) noexcept
+    {
+        const std::uint64_t word = load(data);
+        std::uint64_t raw = (word >> shift) & mask;
+
+        if (Signed == true)
+        {
+            // sign-extend the value to 64 bits
+            raw = (raw ^ sign_bit) - sign_bit;
+        }
+
+        return static_cast< RawType >(raw);
+    }
+
+    /**
+     * \brief Inserts the raw value of the signal. Other signals in the same
+     * bytes are not modified.
+     * \param[out] data the payload of the message. Must hold end_byte bytes.
+     * \param[in] raw the raw value. Bits exceeding the length are dropped.
+     */
+    static void pack(std::uint8_t* data, const RawType raw) noexcept
+    {
+        std::uint64_t word = load(data);
+        word &= ~(mask << shift);
+        word |= (static_cast< std::uint64_t >(raw) & mask) << shift;
+        store(data, word);
+    }
+
+    /**
+     * \brief Extracts the physical value: raw * factor + offset.
+     * \tparam N the size of the payload.
+     * \param[in] data the payload of the message.
+     * \return the physical value of the signal.
+     */
+    template < std::size_t N >
+    static double decode(const std::array< std::uint8_t, N >& data) noexcept
+    {
+        static_assert(end_byte <= N, "The signal exceeds the payload.");
+        return to_physical(unpack(data.data()));
+    }
+
+    /**
+     * \brief Inserts the physical value: raw = (physical - offset) / factor.
+     * \tparam N the size of the payload.
+     * \param[out] data the payload of the message.
+     * \param[in] physical the physical value of the signal.
+     */
+    template < std::size_t N >
+    static void encode(std::array< std::uint8_t, N >& data,
+                       const double physical) noexcept
+    {
+        static_assert(end_byte <= N, "The signal exceeds the payload.");
+        pack(data.data(), to_raw(physical));
+    }
+
+    /**
+     * \brief Scales a raw value to the physical value.
+     */
+    static constexpr double to_physical(const RawType raw) noexcept
+    {
+        return (static_cast< double >(raw) * factor) + offset;
+    }
+
+    /**
+     * \brief Scales a physical value to the nearest raw value.
+     */
+    static RawType to_raw(const double physical) noexcept
+    {
+        const double raw = (physical - offset) / factor;
+        return static_cast< RawType >(std::llround(raw));
+    }
+
+    /// the scaling factor of the signal.
+    static constexpr double factor =
+        static_cast< double >(Factor::num) / static_cast< double >(Factor::den);
+
+    /// the offset of the signal.
+    static constexpr double offset =
+        static_cast< double >(Offset::num) / static_cast< double >(Offset::den);
+
+  private:
+    /// bits to shift the loaded word to get the signal's least significant bit.
+    static constexpr std::size_t shift =
+        (Order == ByteOrder::INTEL)
+            ? start_bit_in_byte
+            : ((byte_count * 8U) - leading_bits - Length);
+
+    /// mask of the signal's bits after shifting.
+    static constexpr std::uint64_t mask =
+        (Length == 64U) ? ~0ULL : ((1ULL << (Length % 64U)) - 1ULL);
+
+    /// the most significant bit of the signal after shifting.
+    static constexpr std::uint64_t sign_bit = 1ULL << (Length - 1U);
+
+    /**
+     * \brief Loads the bytes of the signal into one word in the signal's byte
+     * order. The loop bound is a compile-time constant and unrolled.
+     */
+    static std::uint64_t load(const std::uint8_t* data) noexcept
+    {
+        std::uint64_t word{0U};
+
+        for (std::size_t i = 0U; i < byte_count; ++i)
+        {
+            const std::uint64_t byte = data[first_byte + i];
+
+            if (Order == ByteOrder::INTEL)
+            {
+                word |= byte << (8U * i);
+            }
+            else
+            {
+                word = (word << 8U) | byte;
+            }
+        }
+
+        return word;
+    }
+
+    /**
+     * \brief Stores the word back into the bytes of the signal.
+     */
+    static void store(std::uint8_t* data, const std::uint64_t word) noexcept
+    {
+        for (std::size_t i = 0U; i < byte_count; ++i)
+        {
+            const std::size_t byte_shift = (Order == ByteOrder::INTEL)
+                                               ? (8U * i)
+                                               : (8U * (byte_count - 1U - i));
+            data[first_byte + i] =
+                static_cast< std::uint8_t >(word >> byte_shift);
+        }
+    }
+};
+
+/**
+ * \brief Determines the payload bytes a set of signals occupies.
+ */
+template < typename... Signals > constexpr std::size_t signals_end() noexcept
+{
+    std::size_t max_end{0U};
+    const std::size_t ends[] = {0U, Signals::end_byte...};
+
+    for (const auto end : ends)
+    {
+        max_end = (end > max_end) ? end : max_end;
+    }
+
+    return max_end;
+}
+
+/**
+ * \brief A CAN message composed of signals, as it is defined in a CAN
+ * database.
+ * \details All signals are decoded or encoded in one unrolled pass. The
+ * length of the payload is checked once per message, not once per signal.
+ * \tparam Id the CAN identifier of the message.
+ * \tparam Dlc the data length of the message in bytes.
+ * \tparam Signals the signals of the message.
+ */
+template < CanIDType Id, std::size_t Dlc, typename... Signals > class CanMessage
+{
+  public:
+    static_assert(Dlc <= CAN_FD::DATA_LEN,
+                  "The message exceeds a CAN FD frame.");
+    static_assert(signals_end< Signals... >() <= Dlc,
+                  "A signal exceeds the data length of the message.");
+
+    /// the CAN identifier of the message.
+    static constexpr CanIDType id = Id;
+
+    /// the data length of the message in bytes.
+    static constexpr std::size_t dlc = Dlc;
+
+    /// one physical value per signal in the order of the signals.
+    using Physical = std::array< double, sizeof...(Signals) >;
+
+    /**
+     * \brief Decodes all signals of the payload.
+     * \param[in] data the payload of the message. Must hold dlc bytes.
+     * \param[out] values one physical value per signal.
+     */
+    static void decode(const std::uint8_t* data, Physical& values) noexcept
+    {
+        std::size_t i{0U};
+        const int expand[] = {
+            0,
+            (values[i++] = Signals::to_physical(Signals::unpack(data)), 0)...};
+        static_cast< void >(expand);
+    }
+
+    /**
+     * \brief Decodes all signals of a received frame.
+     * \param[in] frame the frame received.
+     * \param[out] values one physical value per signal.
+     * \return true if the frame holds the message, false if it is too short.
+     */
+    static bool decode(const CanFrame& frame, Physical& values) noexcept
+    {
+        const bool complete = (frame.len >= Dlc);
+
+        if (complete == true)
+        {
+            decode(frame.data, values);
+        }
+
+        return complete;
+    }
+
+    /**
+     * \brief Encodes all signals into the payload.
+     * \param[out] data the payload of the message. Must hold dlc bytes.
+     * \param[in] values one physical value per signal.
+     */
+    static void encode(std::uint8_t* data, const Physical& values) noexcept
+    {
+        std::size_t i{0U};
+        const int expand[] = {
+            0, (Signals::pack(data, Signals::to_raw(values[i++])), 0)...};
+        static_cast< void >(expand);
+    }
+
+    /**
+     * \brief Encodes all signals into a frame ready to send.
+     * \param[out] frame the frame to set up with id, length and payload.
+     * \param[in] values one physical value per signal.
+     */
+    static void encode(CanFrame& frame, const Physical& values) noexcept
+    {
+        frame.can_id = Id;
+        frame.len = static_cast< std::uint8_t >(Dlc);
+        std::fill(std::begin(frame.data), std::end(frame.data), 0U);
+        encode(frame.data, values);
+    }
+
+    /**
+     * \brief Decoder function to register in a CanDecoderTable.
+     * \param[in] frame the frame received.
+     * \param[out] context points to the Physical values to decode into.
+     */
+    static void decode_to(const CanFrame& frame, void* context) noexcept
+    {
+        decode(frame, *static_cast< Physical* >(context));
+    }
+};
+
+/// Decoder function called for a received frame with a user context.
+using CanDecoderFn = void (*)(const CanFrame& frame, void* context);
+
+/**
+ * \brief One entry of a CanDecoderTable.
+ */
+struct CanDecoder
+{
+    /// the identifier of the message (incl. CAN_EFF_FLAG for extended ids).
+    CanIDType can_id;
+
+    /// the function decoding the message.
+    CanDecoderFn decode;
+
+    /// the context given to the decoder, e.g. the destination of the values.
+    void* context;
+};
+
+/**
+ * \brief Dispatches received frames to the decoder of their CAN identifier.
+ * \details The decoders are kept in a flat array sorted by identifier. Adding
+ * a decoder is done once at start-up, finding the decoder of a frame is a
+ * binary search on contiguous memory without any allocation.
+ * \tparam Capacity the maximum number of messages.
+ */
+template < std::size_t Capacity > class CanDecoderTable
+{
+  public:
+    CanDecoderTable() noexcept : m_size{0U} {}
+
+    /**
+     * \brief Registers the decoder of a message.
+     * \param[in] can_id the identifier of the message.
+     * \param[in] decode the function decoding the message.
+     * \param[in] context the context given to the decoder.
+     * \return true if registered, false if the table is full or the identifier
+     * is registered already.
+     */
+    bool add(const CanIDType can_id, const CanDecoderFn decode,
+             void* context) noexcept
+    {
+        bool added{false};
+        const CanIDType key = to_key(can_id);
+        auto* const first = m_decoders.data();
+        auto* const last = first + m_size;
+        auto* const pos = std::lower_bound(first, last, key, less_than);
+
+        if ((m_size < Capacity) && ((pos == last) || (pos->can_id != key)))
+        {
+            // keep the table sorted: move the following entries by one.
+            std::move_backward(pos, last, last + 1);
+            *pos = CanDecoder{key, decode, context};
+            ++m_size;
+            added = true;
+        }
+
+        return added;
+    }
+
+    /**
+     * \brief Registers the decoder of a CanMessage.
+     * \tparam Message the CanMessage type.
+     * \param[out] values the destination of the decoded values.
+     * \return true if registered, false if not.
+     */
+    template < typename Message >
+    bool add(typename Message::Physical& values) noexcept
+    {
+        return add(Message::id, &Message::decode_to, &values);
+    }
+
+    /**
+     * \brief Looks up the decoder of a CAN identifier.
+     * \param[in] can_id the identifier as received.
+     * \return the decoder or nullptr if the identifier is unknown.
+     */
+    const CanDecoder* find(const CanIDType can_id) const noexcept
+    {
+        const CanDecoder* found{nullptr};
+        const CanIDType key = to_key(can_id);
+        const auto* const first = m_decoders.data();
+        const auto* const last = first + m_size;
+        const auto* const pos = std::lower_bound(first, last, key, less_than);
+
+        if ((pos != last) && (pos->can_id == key))
+        {
+            found = pos;
+        }
+
+        return found;
+    }
+
+    /**
+     * \brief Decodes a received frame with the decoder of its identifier.
+     * \param[in] frame the frame received.
+     * \return true if a decoder was called, false if the identifier is
+     * unknown.
+     */
+    bool dispatch(const CanFrame& frame) const noexcept
+    {
+        const CanDecoder* decoder = find(frame.can_id);
+
+        if (decoder != nullptr)
+        {
+            decoder->decode(frame, decoder->context);
+        }
+
+        return (decoder != nullptr);
+    }
+
+    /**
+     * \brief The number of registered decoders.
+     */
+    std::size_t size() const noexcept { return m_size; }
+
+  private:
+    /**
+     * \brief Drops the RTR and error flags from the identifier.
+     */
+    static constexpr CanIDType to_key(const CanIDType can_id) noexcept
+    {
+        return can_id & (CAN_EFF_FLAG | CAN_EFF_MASK);
+    }
+
+    static bool less_than(const CanDecoder& decoder,
+                          const CanIDType key) noexcept
+    {
+        return decoder.can_id < key;
+    }
+
+    /// the decoders sorted by identifier.
+    std::array< CanDecoder, Capacity > m_decoders;
+
+    /// number of decoders registered.
+    std::size_t m_size;
+};
+
+#endif /* CANSIGNAL_H_ */
@@ -49,6 +49,7 @@ std::int8_t CanSocket::receive(CanIDType& can_id, CanFDData& data_ref) noexcept
 {
     // Complete length of the CAN frame received
     std::int8_t can_received{-1};
+    BSW_TRACE_SCOPE("CanSocket::receive");
 
     if (is_can_initialized() == true)
     {
@@ -86,61 +87,109 @@ std::int8_t CanSocket::receive(CanIDType& can_id, CanFDData& data_ref) noexcept
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-template < typename Duration >
 std::int8_t CanSocket::receive(CanIDType& can_id, CanFDData& data_ref,
-                               const Duration&& deadline) noexcept
+                               RxTimestamp& stamp) noexcept
 {
     // Complete length of the CAN frame received
     std::int8_t can_received{-1};
+    BSW_TRACE_SCOPE("CanSocket::receive");
 
-    if (is_can_initialized())
+    if (is_can_initialized() == true)
     {
-        // before we go in a blocking read, we will check if there is
-        // activity on the socket.
-        bool event = wait_for(deadline);
+        struct canfd_frame frame;
+        std::array< std::uint8_t, TIMESTAMP_CONTROL_LEN > control;
+        struct iovec iov;
+        iov.iov_base = &frame;
+        iov.iov_len = can_mtu_;
+        struct msghdr msg;
+        std::memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1U;
+        msg.msg_control = control.data();
+        msg.msg_controllen = control.size();
+
+        const auto socket = get_socket_handle();
+        const ssize_t nbytes = recvmsg(socket, &msg, 0);
 
-        // check the return value of the select. if there is data to read the
-        // return value of select will be greater than zero.
-        if (event > 0)
+        if (nbytes > 0)
+        {
+            read_timestamp(msg, stamp);
+            can_id = frame.can_id;
+            can_received = static_cast< std::int8_t >(frame.len);
+            const auto data_len = std::min(
+                static_cast< std::size_t >(frame.len), data_ref.size());
+            std::copy(frame.data, frame.data + data_len, data_ref.begin());
+        }
+        else
         {
-            struct can_frame frame;
-            const auto handle = get_socket_handle();
-            const auto nbytes = read(handle, &frame, can_mtu_);
-            can_received = static_cast< std::int8_t >(nbytes);
+            // Error or timeout.
+            can_received = -1;
+            last_error_ = errno;
+        }
+    }
 
-            // check if the read from the socket was successful
-            if (can_received > 0)
-            {
-                // The id is stored in the var given by ref.
-                can_id = frame.can_id;
-                // Set the DLC of the CAN frame as return.
-                can_received = (std::int8_t)frame.can_dlc;
-
-                // Transfer the byte stream into the data structure given by
-                // ref.
-                for (std::uint8_t i = 0U; i < frame.can_dlc; ++i)
-                {
-                    // Obviously copying data.
-                    data_ref[i] = frame.data[i];
-                }
-            }
-            else if (can_received == 0)
+    return can_received;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::int16_t CanSocket::receive_batch(CanFrame* frames, RxTimestamp* stamps,
+                                      const std::size_t count) noexcept
+{
+    std::int16_t frames_received{-1};
+
+    if ((is_can_initialized() == true) && (frames != nullptr))
+    {
+        // limit the batch to the message headers we're able to hold.
+        const auto batch = (count < MAX_BATCH) ? count : MAX_BATCH;
+        std::array< struct mmsghdr, MAX_BATCH > msgs;
+        std::array< struct iovec, MAX_BATCH > iovs;
+        // one control buffer per frame to receive its timestamp.
+        std::array< std::array< std::uint8_t, TIMESTAMP_CONTROL_LEN >,
+                    MAX_BATCH >
+            controls;
+
+        // every message header points directly to one frame of the caller,
+        // thus the kernel copies the frames in place.
+        for (std::size_t i = 0U; i < batch; ++i)
+        {
+            iovs[i].iov_base = &frames[i];
+            iovs[i].iov_len = sizeof(CanFrame);
+            std::memset(&msgs[i], 0, sizeof(struct mmsghdr));
+            msgs[i].msg_hdr.msg_iov = &iovs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1U;
+
+            if (stamps != nullptr)
             {
-                // Timeout on zero return
-                std::cerr << "Timeout reached\n";
-                last_error_ = errno;
-                can_received = 0;
+                msgs[i].msg_hdr.msg_control = controls[i].data();
+                msgs[i].msg_hdr.msg_controllen = controls[i].size();
             }
-            else
+        }
+
+        const auto socket = get_socket_handle();
+        // wait for the first frame only (if blocking) and then take all frames
+        // that are pending.
+        const int nframes =
+            recvmmsg(socket, msgs.data(), static_cast< unsigned int >(batch),
+                     MSG_WAITFORONE, nullptr);
+
+        if (nframes >= 0)
+        {
+            frames_received = static_cast< std::int16_t >(nframes);
+
+            for (int i = 0; (stamps != nullptr) && (i < nframes); ++i)
             {
-                std::cerr << "Receive failed: " << errno << "\n";
-                last_error_ = errno;
-                can_received = -1;
+                read_timestamp(msgs[i].msg_hdr, stamps[i]);
             }
         }
+        else
+        {
+            // Error or nothing to receive on a non-blocking socket.
+            frames_received = -1;
+            last_error_ = errno;
+        }
     }
 
-    return can_received;
+    return frames_received;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -199,6 +248,79 @@ bool CanSocket::enable_canfd() noexcept
     return enabled;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+bool CanSocket::set_filters(const CanFilter* filters,
+                            const std::size_t count) noexcept
+{
+    bool filters_set{false};
+    const auto socket = get_socket_handle();
+    // no filter at all makes the kernel drop every frame for this socket.
+    const void* filter_list = (count > 0U) ? filters : nullptr;
+    const auto filter_size =
+        static_cast< socklen_t >(count * sizeof(CanFilter));
+    const auto option_set = setsockopt(socket, SOL_CAN_RAW, CAN_RAW_FILTER,
+                                       filter_list, filter_size);
+
+    if (option_set >= 0)
+    {
+        filters_set = true;
+    }
+    else
+    {
+        last_error_ = errno;
+        filters_set = false;
+    }
+
+    return filters_set;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool CanSocket::reject_all() noexcept { return set_filters(nullptr, 0U); }
+
+////////////////////////////////////////////////////////////////////////////////
+bool CanSocket::set_error_filter(const can_err_mask_t err_mask) noexcept
+{
+    bool mask_set{false};
+    const auto socket = get_socket_handle();
+    const auto option_set = setsockopt(socket, SOL_CAN_RAW, CAN_RAW_ERR_FILTER,
+                                       &err_mask, sizeof(err_mask));
+
+    if (option_set >= 0)
+    {
+        mask_set = true;
+    }
+    else
+    {
+        last_error_ = errno;
+        mask_set = false;
+    }
+
+    return mask_set;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool CanSocket::join_filters(const bool join) noexcept
+{
+    bool joined{false};
+    const int join_flag = static_cast< int >(join);
+    const auto socket = get_socket_handle();
+    const auto option_set =
+        setsockopt(socket, SOL_CAN_RAW, CAN_RAW_JOIN_FILTERS, &join_flag,
+                   sizeof(join_flag));
+
+    if (option_set >= 0)
+    {
+        joined = true;
+    }
+    else
+    {
+        last_error_ = errno;
+        joined = false;
+    }
+
+    return joined;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 bool CanSocket::bind_if_socket() noexcept
 {
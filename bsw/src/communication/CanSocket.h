@@ -42,6 +42,8 @@
 #ifndef _WIN32
 
 #include "Socket.h" // uses sockets under Linux
+#include "Trace.h"  // probes of send and receive
+#include <algorithm> // limit lengths
 #include <array>    // rx, tx
 #include <cassert>
 #include <cstring>         // strcopy for interface name
@@ -50,6 +52,7 @@
 #include <net/if.h>        // interface name
 #include <sys/ioctl.h>     // blocking / non-blocking
 #include <unistd.h>        // write and read for CAN interface
+#include <utility>         // forwarding the deadline
 
 /**
  * \brief Defining a struct that holds informations about standard CAN frames.
@@ -76,6 +79,174 @@ using CanStdData = CanDataType;
 using CanFDData = std::array< std::uint8_t, CAN_FD::DATA_LEN >;
 using CanIDType = canid_t;
 
+/// A reader filter: a frame passes if (received id & mask) == (id & mask).
+/// Set CAN_INV_FILTER in the id to invert the filter.
+using CanFilter = struct can_filter;
+
+/**
+ * \brief Creates a reader filter at compile-time.
+ * \param[in] can_id the CAN identifier to match.
+ * \param[in] can_mask the bits of the identifier that must match.
+ * \return the filter to pass to CanSocket::set_filters().
+ */
+constexpr CanFilter make_can_filter(const CanIDType can_id,
+                                    const CanIDType can_mask) noexcept
+{
+    return CanFilter{can_id, can_mask};
+}
+
+/// One raw SocketCAN frame as it is exchanged with the kernel. It is large
+/// enough to hold both standard CAN frames and CAN FD frames.
+using CanFrame = struct canfd_frame;
+
+/**
+ * \brief A statically sized queue of CAN frames that are transmitted together
+ * with one system call by CanSocket::send_batch().
+ * \details The frames are staged in place. The message headers for sendmmsg
+ * are linked to the frame slots once at construction, thus flushing the batch
+ * does not copy or prepare anything. If the kernel accepts only a part of the
+ * batch, the frames sent are consumed and the next flush transmits the
+ * remaining frames only.
+ * \tparam N the maximum number of frames to stage.
+ */
+template < std::size_t N > class CanTxBatch
+{
+  public:
+    /**
+     * \brief Default constructor linking the message headers to the frames.
+     */
+    CanTxBatch() noexcept : m_staged{0U}
+    {
+        static_assert(N > 0U, "The batch must hold at least one frame.");
+
+        for (std::size_t i = 0U; i < N; ++i)
+        {
+            m_iovs[i].iov_base = &m_frames[i];
+            m_iovs[i].iov_len = CANFD_MTU;
+            std::memset(&m_msgs[i], 0, sizeof(struct mmsghdr));
+            m_msgs[i].msg_hdr.msg_iov = &m_iovs[i];
+            m_msgs[i].msg_hdr.msg_iovlen = 1U;
+        }
+    }
+
+    /// The message headers point into this object. Copying is not allowed.
+    CanTxBatch(const CanTxBatch&) = delete;
+    CanTxBatch& operator=(const CanTxBatch&) = delete;
+
+    /**
+     * \brief Reserves the next frame slot to fill in place.
+     * \param[in] canfd true if the frame is sent as a CAN FD frame, false if
+     * it is a standard CAN frame.
+     * \return the frame to fill or nullptr if the batch is full.
+     */
+    CanFrame* stage(const bool canfd) noexcept
+    {
+        CanFrame* frame{nullptr};
+
+        if (m_staged < N)
+        {
+            frame = &m_frames[m_staged];
+            frame->len = 0U;
+            frame->flags = 0U;
+            frame->__res0 = 0U;
+            frame->__res1 = 0U;
+            // the kernel determines the frame type by the length written.
+            m_iovs[m_staged].iov_len = canfd ? CANFD_MTU : CAN_MTU;
+            ++m_staged;
+        }
+
+        return frame;
+    }
+
+    /**
+     * \brief Stages a frame copying the data directly into the frame slot.
+     * \tparam CANData Deduced type: Whether this is a standard CAN frame or a
+     * CAN FD frame.
+     * \param[in] can_id CAN identifier to transmit the message.
+     * \param[in] data the user data to transmit.
+     * \param[in] len Length in bytes to send.
+     * \return true if the frame is staged, false if the batch is full.
+     */
+    template < typename CANData >
+    bool push(const CanIDType can_id, const CANData& data,
+              const std::uint8_t len) noexcept
+    {
+        static_assert(std::is_same< CanStdData, CANData >::value ||
+                          std::is_same< CanFDData, CANData >::value,
+                      "Must be a standard CAN frame or CAN FD frame.");
+        static constexpr bool is_fd = std::is_same< CanFDData, CANData >::value;
+        CanFrame* frame = stage(is_fd);
+
+        if (frame != nullptr)
+        {
+            frame->can_id = can_id;
+            // limit the length to max DLC of standard CAN or CAN FD
+            frame->len = static_cast< std::uint8_t >(
+                std::min(static_cast< std::size_t >(len), data.size()));
+            std::memcpy(frame->data, data.data(), frame->len);
+        }
+
+        return (frame != nullptr);
+    }
+
+    /**
+     * \brief Number of frames staged and not yet sent.
+     */
+    std::size_t pending() const noexcept { return m_staged; }
+
+    /**
+     * \brief true if no frame is waiting for transmission.
+     */
+    bool empty() const noexcept { return pending() == 0U; }
+
+    /**
+     * \brief true if no more frames can be staged.
+     */
+    bool full() const noexcept { return m_staged == N; }
+
+    /**
+     * \brief Drops all staged frames.
+     */
+    void clear() noexcept { m_staged = 0U; }
+
+    /**
+     * \brief The message headers of the frames not yet sent.
+     */
+    struct mmsghdr* pending_messages() noexcept { return m_msgs.data(); }
+
+    /**
+     * \brief Marks the given number of pending frames as sent. The frames
+     * not yet sent are moved to the front, so the slots of the frames sent
+     * can be staged again right away.
+     * \param[in] frames_sent number of frames the kernel accepted.
+     */
+    void consume(const std::size_t frames_sent) noexcept
+    {
+        const std::size_t done = std::min(frames_sent, m_staged);
+
+        for (std::size_t i = done; i < m_staged; ++i)
+        {
+            m_frames[i - done] = m_frames[i];
+            m_iovs[i - done].iov_len = m_iovs[i].iov_len;
+        }
+
+        m_staged -= done;
+    }
+
+  private:
+    /// the frames staged for transmission.
+    std::array< CanFrame, N > m_frames;
+
+    /// one io vector per frame holding its address and MTU.
+    std::array< struct iovec, N > m_iovs;
+
+    /// one message header per frame given to sendmmsg.
+    std::array< struct mmsghdr, N > m_msgs;
+
+    /// number of frames staged.
+    std::size_t m_staged;
+};
+
 /**
  * \brief CanSocket is used for sending and receiving standard CAN frames and
  * CAN FD frames.
@@ -163,6 +334,7 @@ class CanSocket : public Socket< CanSocket >
         // initialize with zero value. uninitialized stack variables are a
         // common error source.
         std::int8_t data_sent{0};
+        BSW_TRACE_SCOPE("CanSocket::send");
         // must be the correct array size. minimizes static analysis efforts by
         // checking this at compile-time
         static_assert(std::is_same< CanStdData, CANData >::value ||
@@ -192,7 +364,7 @@ class CanSocket : public Socket< CanSocket >
                                  data.size());
 
             // copy data into the data field of the frame struct.
-            for (std::uint8_t i = 0U; i < len; ++i)
+            for (std::uint8_t i = 0U; i < frame.len; ++i)
             {
                 frame.data[i] = data[i];
             }
@@ -226,6 +398,56 @@ class CanSocket : public Socket< CanSocket >
         return data_sent;
     }
 
+    /**
+     * \brief Transmits all pending frames of a batch with one system call
+     * (sendmmsg).
+     * \tparam N the capacity of the batch.
+     * \param[in,out] batch the frames to send. Frames sent are removed from
+     * the batch, frames the kernel did not accept remain pending, so calling
+     * this again retries the remaining frames only.
+     * \return the number of frames sent. If the transmit queue of the
+     * interface is full (ENOBUFS) this may be less than the frames pending or
+     * zero. If there was an error, -1 is returned.
+     */
+    template < std::size_t N >
+    std::int16_t send_batch(CanTxBatch< N >& batch) noexcept
+    {
+        std::int16_t frames_sent{-1};
+
+        if (is_can_initialized())
+        {
+            frames_sent = 0;
+            const auto pending = batch.pending();
+
+            if (pending > 0U)
+            {
+                const auto socket = get_socket_handle();
+                const int nframes =
+                    sendmmsg(socket, batch.pending_messages(),
+                             static_cast< unsigned int >(pending), 0);
+
+                if (nframes >= 0)
+                {
+                    batch.consume(static_cast< std::size_t >(nframes));
+                    frames_sent = static_cast< std::int16_t >(nframes);
+                }
+                else if ((errno == ENOBUFS) || (errno == EAGAIN))
+                {
+                    // the transmit queue is full. nothing sent, try again.
+                    SetErrorNumber(errno);
+                    frames_sent = 0;
+                }
+                else
+                {
+                    SetErrorNumber(errno);
+                    frames_sent = -1;
+                }
+            }
+        }
+
+        return frames_sent;
+    }
+
     /**
      * \brief Receives a CAN message from the socket and
      * writes the data into an array (blocking read).
@@ -236,6 +458,19 @@ class CanSocket : public Socket< CanSocket >
      */
     std::int8_t receive(CanIDType& can_id, CanFDData& data_ref) noexcept;
 
+    /**
+     * \brief Receives a CAN message from the socket together with the time
+     * the kernel or the CAN device received it (blocking read).
+     * \param[out] can_id CAN identifier of the message received.
+     * \param[out] data_ref Array to store the received packet data to.
+     * \param[out] stamp receive timestamp, zero if enable_timestamps() was
+     * not called.
+     * \return Greater than zero if data was received.
+     * This returns -1 if there was an error or timeout.
+     */
+    std::int8_t receive(CanIDType& can_id, CanFDData& data_ref,
+                        RxTimestamp& stamp) noexcept;
+
     /**
      * \brief Receives a CAN message from the socket and writes the data into
      * an array (non-blocking read / timeout / polling possible).
@@ -248,7 +483,126 @@ class CanSocket : public Socket< CanSocket >
      */
     template < typename Duration >
     std::int8_t receive(CanIDType& can_id, CanFDData& data_ref,
-                        const Duration&& deadline) noexcept;
+                        const Duration&& deadline) noexcept
+    {
+        // Complete length of the CAN frame received
+        std::int8_t can_received{-1};
+
+        if (is_can_initialized())
+        {
+            // before we go in a blocking read, we will check if there is
+            // activity on the socket.
+            const bool event = wait_for(std::move(deadline));
+
+            if (event == true)
+            {
+                can_received = receive(can_id, data_ref);
+            }
+            else
+            {
+                // Timeout on zero return
+                can_received = 0;
+            }
+        }
+
+        return can_received;
+    }
+
+    /**
+     * \brief Receives all CAN frames pending on the socket with one system
+     * call (recvmmsg). The frames are written directly into the memory given
+     * by the caller.
+     * \param[out] frames Caller-owned array of frames to store the received
+     * frames to.
+     * \param[in] count Number of frames the array is able to hold. A maximum
+     * of MAX_BATCH frames is received with one call.
+     * \return the number of frames received or -1 if there was an error.
+     * On a blocking socket this waits for the first frame only and returns
+     * all frames that are pending then.
+     */
+    std::int16_t receive_batch(CanFrame* frames,
+                               const std::size_t count) noexcept
+    {
+        return receive_batch(frames, nullptr, count);
+    }
+
+    /**
+     * \brief Receives all CAN frames pending on the socket with one system
+     * call together with their receive timestamps.
+     * \param[out] frames Caller-owned array of frames to store the received
+     * frames to.
+     * \param[out] stamps Caller-owned array of at least count timestamps.
+     * stamps[i] is the receive time of frames[i], zero if enable_timestamps()
+     * was not called. May be nullptr if no timestamps are needed.
+     * \param[in] count Number of frames the arrays are able to hold. A
+     * maximum of MAX_BATCH frames is received with one call.
+     * \return the number of frames received or -1 if there was an error.
+     */
+    std::int16_t receive_batch(CanFrame* frames, RxTimestamp* stamps,
+                               const std::size_t count) noexcept;
+
+    /**
+     * \brief Receives all CAN frames pending on the socket with one system
+     * call into a statically sized array.
+     * \tparam N the capacity of the array.
+     * \param[out] frames Array to store the received frames to.
+     * \return the number of frames received or -1 if there was an error.
+     */
+    template < std::size_t N >
+    std::int16_t receive_batch(std::array< CanFrame, N >& frames) noexcept
+    {
+        static_assert(N > 0U, "The frame array must not be empty.");
+        return receive_batch(frames.data(), N);
+    }
+
+    /**
+     * \brief Receives all CAN frames pending on the socket with one system
+     * call into a statically sized array, together with their timestamps.
+     * \tparam N the capacity of the arrays.
+     * \param[out] frames Array to store the received frames to.
+     * \param[out] stamps Array to store the receive timestamps to.
+     * \return the number of frames received or -1 if there was an error.
+     */
+    template < std::size_t N >
+    std::int16_t receive_batch(std::array< CanFrame, N >& frames,
+                               std::array< RxTimestamp, N >& stamps) noexcept
+    {
+        static_assert(N > 0U, "The frame array must not be empty.");
+        return receive_batch(frames.data(), stamps.data(), N);
+    }
+
+    /**
+     * \brief Receives all CAN frames pending on the socket with one system
+     * call (non-blocking read / timeout / polling possible).
+     * \tparam N the capacity of the array.
+     * \param[out] frames Array to store the received frames to.
+     * \param[in] deadline Time to wait for the first frame.
+     * \return the number of frames received. If there is a timeout it returns
+     * zero. If there was an error, -1 is returned.
+     */
+    template < std::size_t N, typename Duration >
+    std::int16_t receive_batch(std::array< CanFrame, N >& frames,
+                               const Duration&& deadline) noexcept
+    {
+        std::int16_t frames_received{-1};
+
+        if (is_can_initialized())
+        {
+            const bool event = wait_for(std::move(deadline));
+
+            if (event == true)
+            {
+                frames_received = receive_batch(frames);
+            }
+            else
+            {
+                // timeout, no frame pending.
+                frames_received = 0;
+            }
+        }
+
+        return frames_received;
+    }
 
     /**
      * \brief Create a CAN socket / file descriptor to send and receive.
@@ -261,6 +615,15 @@ class CanSocket : public Socket< CanSocket >
      */
     bool is_can_initialized() const noexcept;
 
+    /**
+     * \brief The index of the interface the socket is bound to, 0 if the
+     * interface does not exist.
+     */
+    unsigned int get_interface_index() const noexcept
+    {
+        return can_init_ ? static_cast< unsigned int >(ifr_.ifr_ifindex) : 0U;
+    }
+
     /**
      * \brief Switch to CAN FD mode. Configure the interface to send and receive
      * CAN FD frames.
@@ -268,6 +631,56 @@ class CanSocket : public Socket< CanSocket >
      */
     bool enable_canfd() noexcept;
 
+    /**
+     * \brief Installs reader filters in the kernel (CAN_RAW_FILTER). Only
+     * frames that pass one of the filters are delivered to this socket.
+     * \param[in] filters the list of filters. Replaces the filters set before.
+     * \param[in] count the number of filters in the list. If zero, no frame is
+     * received at all.
+     * \return true if the filters are installed, false if not.
+     */
+    bool set_filters(const CanFilter* filters,
+                     const std::size_t count) noexcept;
+
+    /**
+     * \brief Installs a statically known set of reader filters in the kernel.
+     * \tparam N the number of filters.
+     * \param[in] filters the filters, e.g. created with make_can_filter().
+     * \return true if the filters are installed, false if not.
+     */
+    template < std::size_t N >
+    bool set_filters(const std::array< CanFilter, N >& filters) noexcept
+    {
+        static_assert(N > 0U, "Use reject_all() to receive no frames at all.");
+        return set_filters(filters.data(), N);
+    }
+
+    /**
+     * \brief Removes all reader filters, thus no frame is received anymore.
+     * This is useful for sockets that only transmit.
+     * \return true if successful, false if not.
+     */
+    bool reject_all() noexcept;
+
+    /**
+     * \brief Selects the error frames to receive (CAN_RAW_ERR_FILTER).
+     * \param[in] err_mask the error classes to receive, e.g. CAN_ERR_BUSOFF.
+     * CAN_ERR_MASK receives all error frames, zero none (default).
+     * \return true if the mask is set, false if not.
+     */
+    bool set_error_filter(const can_err_mask_t err_mask) noexcept;
+
+    /**
+     * \brief Changes how several filters are combined (CAN_RAW_JOIN_FILTERS).
+     * \param[in] join false: a frame passes if it matches any filter
+     * (default). true: a frame passes only if it matches all filters.
+     * \return true if the option is set, false if not.
+     */
+    bool join_filters(const bool join) noexcept;
+
+    /// Maximum number of frames received with one call of receive_batch().
+    static constexpr std::size_t MAX_BATCH{64U};
+
   private:
     /**
      * \brief Check if the interface exists and is known to the OS.
@@ -45,16 +45,94 @@
 #else
 #error "Please #define BYTE_ORDER for your system architecture."
 #endif
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#if defined(__AVX2__) || defined(__SSSE3__)
+#include <immintrin.h> // byte shuffles for bulk conversion
+#elif defined(__ARM_NEON)
+#include <arm_neon.h> // byte reversal for bulk conversion
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+/**
+ * \brief Reverses the bytes of a word. Uses the byte swap instruction of the
+ * CPU if the compiler provides it.
+ */
+inline std::uint16_t byte_swap16(const std::uint16_t val) noexcept
+{
+#if defined(__GNUC__)
+    return __builtin_bswap16(val);
+#else
+    return static_cast< std::uint16_t >(((val >> 8U) & 0x00FFU) |
+                                        ((val << 8U) & 0xFF00U));
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/**
+ * \brief Reverses the bytes of a double word.
+ */
+inline std::uint32_t byte_swap32(const std::uint32_t val) noexcept
+{
+#if defined(__GNUC__)
+    return __builtin_bswap32(val);
+#else
+    std::uint32_t temp{0UL};
+    temp = ((val >> 24U) & 0x000000FFUL);  // byte 3 to 0
+    temp |= ((val << 24U) & 0xFF000000UL); // byte 0 to 3
+    temp |= ((val >> 8U) & 0x0000FF00UL);  // byte 2 to 1
+    temp |= ((val << 8U) & 0x00FF0000UL);  // byte 1 to 2
+    return temp;
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/**
+ * \brief Reverses the bytes of a quad word.
+ */
+inline std::uint64_t byte_swap64(const std::uint64_t val) noexcept
+{
+#if defined(__GNUC__)
+    return __builtin_bswap64(val);
+#else
+    std::uint64_t temp = 0ULL;
+    temp = ((val >> 56U) & 0x00000000000000FFULL);  // byte 7 to 0
+    temp |= ((val << 56U) & 0xFF00000000000000ULL); // byte 0 to 7
+    temp |= ((val >> 40U) & 0x000000000000FF00ULL); // byte 6 to 1
+    temp |= ((val << 40U) & 0x00FF000000000000ULL); // byte 1 to 6
+    temp |= ((val >> 24U) & 0x0000000000FF0000ULL); // byte 5 to 2
+    temp |= ((val << 24U) & 0x0000FF0000000000ULL); // byte 2 to 5
+    temp |= ((val >> 8U) & 0x00000000FF000000ULL);  // byte 4 to 3
+    temp |= ((val << 8U) & 0x000000FF00000000ULL);  // byte 3 to 4
+    return temp;
+#endif
+}
 
 ////////////////////////////////////////////////////////////////////////////////
-template < typename T, size_t Sz > T swap_bytes(const T& val) noexcept;
+template < typename T, std::size_t Sz > T swap_bytes(const T& val) noexcept;
 
 ////////////////////////////////////////////////////////////////////////////////
 /**
  * \brief template specialization to swap an unsigned byte.
  * \return this will only return the byte again.
  */
-template <> inline uint8 swap_bytes< uint8, 1 >(const uint8& val) noexcept
+template <>
+inline std::uint8_t swap_bytes< std::uint8_t, 1 >(
+    const std::uint8_t& val) noexcept
+{
+    return val;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/**
+ * \brief template specialization to swap a signed byte.
+ * \return this will only return the byte again.
+ */
+template <>
+inline std::int8_t swap_bytes< std::int8_t, 1 >(const std::int8_t& val) noexcept
 {
     return val;
 }
@@ -64,12 +142,11 @@ template <> inline uint8 swap_bytes< uint8, 1 >(const uint8& val) noexcept
  * \brief template specialization to swap an unsgined word.
  * \return an unsigned word with swapped bytes.
  */
-template <> inline uint16 swap_bytes< uint16, 2U >(const uint16& val) noexcept
+template <>
+inline std::uint16_t swap_bytes< std::uint16_t, 2U >(
+    const std::uint16_t& val) noexcept
 {
-    uint16 temp = 0U;
-    temp = ((val >> 8U) & 0x00FFU);
-    temp |= ((val << 8U) & 0xFFFFU);
-    return temp;
+    return byte_swap16(val);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -77,12 +154,12 @@ template <> inline uint16 swap_bytes< uint16, 2U >(const uint16& val) noexcept
  * \brief template specialization to swap an unsgined word.
  * \return a signed word with swapped bytes.
  */
-template <> inline sint16 swap_bytes< sint16, 2U >(const sint16& val) noexcept
+template <>
+inline std::int16_t swap_bytes< std::int16_t, 2U >(
+    const std::int16_t& val) noexcept
 {
-    sint16 temp = 0;
-    temp = ((val >> 8) & 0x00FF);
-    temp |= ((val << 8) & 0xFFFF);
-    return temp;
+    return static_cast< std::int16_t >(
+        byte_swap16(static_cast< std::uint16_t >(val)));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -92,14 +169,11 @@ template <> inline sint16 swap_bytes< sint16, 2U >(const sint16& val) noexcept
  * \param[in] val the value to byte-swap
  * \return a byte-swapped unsigned double word
  */
-template <> inline uint32 swap_bytes< uint32, 4 >(const uint32& val) noexcept
+template <>
+inline std::uint32_t swap_bytes< std::uint32_t, 4 >(
+    const std::uint32_t& val) noexcept
 {
-    uint32 temp{0UL};
-    temp = ((val >> 24U) & 0x000000FFUL);  // byte 3 to 0
-    temp |= ((val << 24U) & 0xFF000000UL); // byte 0 to 3
-    temp |= ((val >> 8U) & 0x0000FF00UL);  // byte 2 to 1
-    temp |= ((val << 8U) & 0x00FF0000UL);  // byte 1 to 2
-    return temp;
+    return byte_swap32(val);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -108,14 +182,12 @@ template <> inline uint32 swap_bytes< uint32, 4 >(const uint32& val) noexcept
  * \param[in] val the value to byte-swap
  * \return a byte-swapped unsigned double word
  */
-template <> inline sint32 swap_bytes< sint32, 4 >(const sint32& val) noexcept
+template <>
+inline std::int32_t swap_bytes< std::int32_t, 4 >(
+    const std::int32_t& val) noexcept
 {
-    sint32 temp = 0L;
-    temp = ((val >> 24) & 0x000000FFL);  // byte 3 to 0
-    temp |= ((val << 24) & 0xFF000000L); // byte 0 to 3
-    temp |= ((val >> 8) & 0x0000FF00L);  // byte 2 to 1
-    temp |= ((val << 8) & 0x00FF0000L);  // byte 1 to 2
-    return temp;
+    return static_cast< std::int32_t >(
+        byte_swap32(static_cast< std::uint32_t >(val)));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -124,18 +196,11 @@ template <> inline sint32 swap_bytes< sint32, 4 >(const sint32& val) noexcept
  * \param[in] val to swap the bytes
  * \return the swapped value
  */
-template <> inline uint64 swap_bytes< uint64, 8 >(const uint64& val) noexcept
+template <>
+inline std::uint64_t swap_bytes< std::uint64_t, 8 >(
+    const std::uint64_t& val) noexcept
 {
-    uint64 temp = 0ULL;
-    temp = ((val >> 56U) & 0x00000000000000FFULL);  // byte 7 to 0
-    temp |= ((val << 56U) & 0xFF00000000000000ULL); // byte 0 to 7
-    temp |= ((val >> 40U) & 0x000000000000FF00ULL); // byte 6 to 1
-    temp |= ((val << 40U) & 0x00FF000000000000ULL); // byte 1 to 6
-    temp |= ((val >> 24U) & 0x0000000000FF0000ULL); // byte 5 to 2
-    temp |= ((val << 24U) & 0x0000FF0000000000ULL); // byte 2 to 5
-    temp |= ((val >> 8U) & 0x00000000FF000000ULL);  // byte 4 to 3
-    temp |= ((val << 8U) & 0x000000FF00000000ULL);  // byte 3 to 4
-    return temp;
+    return byte_swap64(val);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -144,51 +209,35 @@ template <> inline uint64 swap_bytes< uint64, 8 >(const uint64& val) noexcept
  * \param[in] val to swap the bytes
  * \return the swapped value
  */
-template <> inline sint64 swap_bytes< sint64, 8 >(const sint64& val) noexcept
+template <>
+inline std::int64_t swap_bytes< std::int64_t, 8 >(
+    const std::int64_t& val) noexcept
 {
-    sint64 temp = 0LL;
-    temp = ((val >> 56U) & 0x00000000000000FFULL);  // byte 7 to 0
-    temp |= ((val << 56U) & 0xFF00000000000000ULL); // byte 0 to 7
-    temp |= ((val >> 40U) & 0x000000000000FF00ULL); // byte 6 to 1
-    temp |= ((val << 40U) & 0x00FF000000000000ULL); // byte 1 to 6
-    temp |= ((val >> 24U) & 0x0000000000FF0000ULL); // byte 5 to 2
-    temp |= ((val << 24U) & 0x0000FF0000000000ULL); // byte 2 to 5
-    temp |= ((val >> 8U) & 0x00000000FF000000ULL);  // byte 4 to 3
-    temp |= ((val << 8U) & 0x000000FF00000000ULL);  // byte 3 to 4
-    return temp;
+    return static_cast< std::int64_t >(
+        byte_swap64(static_cast< std::uint64_t >(val)));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 template <>
-inline float32 swap_bytes< float32, 4 >(const float32& fval) noexcept
-{
-    float32 float_swapped{0.0F};
-    float32 temp = fval;
-    uint8* float_to_convert = reinterpret_cast< uint8* >(&temp);
-    uint8* to_convert = reinterpret_cast< uint8* >(&float_swapped);
-    to_convert[0] = float_to_convert[3];
-    to_convert[1] = float_to_convert[2];
-    to_convert[2] = float_to_convert[1];
-    to_convert[3] = float_to_convert[0];
+inline float swap_bytes< float, 4 >(const float& fval) noexcept
+{
+    std::uint32_t bits{0UL};
+    std::memcpy(&bits, &fval, sizeof(bits));
+    bits = byte_swap32(bits);
+    float float_swapped{0.0F};
+    std::memcpy(&float_swapped, &bits, sizeof(bits));
     return float_swapped;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 template <>
-inline float64 swap_bytes< float64, 8 >(const float64& fval) noexcept
-{
-    float64 float_swapped{0.0};
-    float64 temp = fval;
-    uint8* float_to_convert = reinterpret_cast< uint8* >(&temp);
-    uint8* to_convert = reinterpret_cast< uint8* >(&float_swapped);
-    to_convert[0] = float_to_convert[7];
-    to_convert[1] = float_to_convert[6];
-    to_convert[2] = float_to_convert[5];
-    to_convert[3] = float_to_convert[4];
-    to_convert[4] = float_to_convert[3];
-    to_convert[5] = float_to_convert[2];
-    to_convert[6] = float_to_convert[1];
-    to_convert[7] = float_to_convert[0];
+inline double swap_bytes< double, 8 >(const double& fval) noexcept
+{
+    std::uint64_t bits{0ULL};
+    std::memcpy(&bits, &fval, sizeof(bits));
+    bits = byte_swap64(bits);
+    double float_swapped{0.0};
+    std::memcpy(&float_swapped, &bits, sizeof(bits));
     return float_swapped;
 }
 
@@ -229,4 +278,156 @@ template < typename T > inline T from_network(const T& value) noexcept
     return convert;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/**
+ * \brief Reverses the bytes of every element of an array.
+ * \details Full vectors of 32 (AVX2) or 16 (SSSE3, NEON) bytes are converted
+ * with one byte shuffle each, the remaining elements with the scalar byte
+ * swap. The instruction set is selected at compile-time, e.g. with
+ * -march=native, -mavx2 or -mssse3 (CMake option BSW_SIMD); without any the
+ * scalar path is used.
+ * Source and destination may be unaligned but must not overlap partially.
+ * \tparam Width the size of one element in bytes: 2, 4 or 8.
+ * \param[in] src the elements to convert.
+ * \param[out] dst where the converted elements are written.
+ * \param[in] count the number of elements.
+ */
+template < std::size_t Width >
+inline void swap_bytes_bulk(const std::uint8_t* src, std::uint8_t* dst,
+                            const std::size_t count) noexcept
+{
+    static_assert((Width == 2U) || (Width == 4U) || (Width == 8U),
+                  "Only elements of 2, 4 or 8 bytes are swapped.");
+    const std::size_t bytes = count * Width;
+    std::size_t i = 0U;
+
+#if defined(__AVX2__) || defined(__SSSE3__)
+    // index of the source byte for every byte of a 16 byte lane.
+    alignas(16) static constexpr std::uint8_t SHUFFLE16[16] = {
+        1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14};
+    alignas(16) static constexpr std::uint8_t SHUFFLE32[16] = {
+        3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12};
+    alignas(16) static constexpr std::uint8_t SHUFFLE64[16] = {
+        7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8};
+    const std::uint8_t* shuffle =
+        (Width == 2U) ? SHUFFLE16 : ((Width == 4U) ? SHUFFLE32 : SHUFFLE64);
+    const __m128i mask128 =
+        _mm_load_si128(reinterpret_cast< const __m128i* >(shuffle));
+#if defined(__AVX2__)
+    // the shuffle of AVX2 works on two independent 16 byte lanes.
+    const __m256i mask256 = _mm256_broadcastsi128_si256(mask128);
+
+    for (; (i + 32U) <= bytes; i += 32U)
+    {
+        const __m256i v =
+            _mm256_loadu_si256(reinterpret_cast< const __m256i* >(src + i));
+        _mm256_storeu_si256(reinterpret_cast< __m256i* >(dst + i),
+                            _mm256_shuffle_epi8(v, mask256));
+    }
+#endif
+    for (; (i + 16U) <= bytes; i += 16U)
+    {
+        const __m128i v =
+            _mm_loadu_si128(reinterpret_cast< const __m128i* >(src + i));
+        _mm_storeu_si128(reinterpret_cast< __m128i* >(dst + i),
+                         _mm_shuffle_epi8(v, mask128));
+    }
+#elif defined(__ARM_NEON)
+    for (; (i + 16U) <= bytes; i += 16U)
+    {
+        const uint8x16_t v = vld1q_u8(src + i);
+        const uint8x16_t swapped =
+            (Width == 2U) ? vrev16q_u8(v)
+                          : ((Width == 4U) ? vrev32q_u8(v) : vrev64q_u8(v));
+        vst1q_u8(dst + i, swapped);
+    }
+#endif
+
+    // the remaining elements one by one.
+    for (; i < bytes; i += Width)
+    {
+        if (Width == 2U)
+        {
+            std::uint16_t val{0U};
+            std::memcpy(&val, src + i, Width);
+            val = byte_swap16(val);
+            std::memcpy(dst + i, &val, Width);
+        }
+        else if (Width == 4U)
+        {
+            std::uint32_t val{0UL};
+            std::memcpy(&val, src + i, Width);
+            val = byte_swap32(val);
+            std::memcpy(dst + i, &val, Width);
+        }
+        else
+        {
+            std::uint64_t val{0ULL};
+            std::memcpy(&val, src + i, Width);
+            val = byte_swap64(val);
+            std::memcpy(dst + i, &val, Width);
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/**
+ * \brief Converts an array of values from host-byte-order into a byte
+ * stream in network-byte-order.
+ * \tparam T an arithmetic type.
+ * \param[in] values the values to convert.
+ * \param[in] count the number of values.
+ * \param[out] bytes the destination of count * sizeof(T) bytes.
+ */
+template < typename T >
+inline void to_network(const T* values, const std::size_t count,
+                       std::uint8_t* bytes) noexcept
+{
+    static_assert(std::is_arithmetic< T >::value,
+                  "Type must be integral or floating point.");
+    const auto src = reinterpret_cast< const std::uint8_t* >(values);
+
+#if (BYTE_ORDER == LITTLE_ENDIAN)
+    if (sizeof(T) > 1U)
+    {
+        // single bytes have no byte order and are copied as they are below,
+        // a width of 2 only keeps this branch instantiable for them.
+        constexpr std::size_t WIDTH = (sizeof(T) > 1U) ? sizeof(T) : 2U;
+        swap_bytes_bulk< WIDTH >(src, bytes, count);
+        return;
+    }
+#endif
+
+    std::memcpy(bytes, src, count * sizeof(T));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/**
+ * \brief Converts a byte stream in network-byte-order into an array of values
+ * in host-byte-order.
+ * \tparam T an arithmetic type.
+ * \param[in] bytes the source of count * sizeof(T) bytes.
+ * \param[in] count the number of values.
+ * \param[out] values the converted values.
+ */
+template < typename T >
+inline void from_network(const std::uint8_t* bytes, const std::size_t count,
+                         T* values) noexcept
+{
+    static_assert(std::is_arithmetic< T >::value,
+                  "Type must be integral or floating point.");
+    const auto dst = reinterpret_cast< std::uint8_t* >(values);
+
+#if (BYTE_ORDER == LITTLE_ENDIAN)
+    if (sizeof(T) > 1U)
+    {
+        constexpr std::size_t WIDTH = (sizeof(T) > 1U) ? sizeof(T) : 2U;
+        swap_bytes_bulk< WIDTH >(bytes, dst, count);
+        return;
+    }
+#endif
+
+    std::memcpy(dst, bytes, count * sizeof(T));
+}
+
 #endif /* ENDIANESS_H_ */
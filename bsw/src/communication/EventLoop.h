@@ -0,0 +1,382 @@
+/**
+ * \file      EventLoop.h
+ * \author    dtuchscherer <daniel.tuchscherer@gmail.com>
+ * \brief     Event loop multiplexing many sockets
+ * \details   The event loop waits for readiness of many sockets with one epoll
+ *            instance and dispatches the events to callbacks registered per
+ *            socket.
+ * \copyright Copyright (c) 2018, dtuchscherer.
+ *            All rights reserved.
+ *
+ *            Redistributions and use in source and binary forms, with
+ *            or without modifications, are permitted provided that the
+ *            following conditions are met: Redistributions of source code must
+ *            retain the above copyright notice, this list of conditions and the
+ *            following disclaimer.
+ *
+ *            Redistributions in binary form must reproduce the above copyright
+ *            notice, this list of conditions and the following disclaimer in
+ *            the documentation and/or other materials provided with the
+ *            distribution.
+ *
+ *            Neither the name of the Heilbronn University nor the name of its
+ *            contributors may be used to endorse or promote products derived
+ *            from this software without specific prior written permission.
+ *
+ *            THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS “AS IS”
+ *            AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ *            TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ *            PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE REGENTS
+ *            OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *            SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *            LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *            USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *            AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *            LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *            ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *            POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef EVENTLOOP_H_
+#define EVENTLOOP_H_
+
+#ifndef __unix__
+#error "The EventLoop uses epoll and is available under Linux only."
+#endif
+
+#include "Socket.h"
+#include <array>
+#include <chrono>
+#include <sys/epoll.h>
+#include <utility>
+
+/**
+ * \brief Callback invoked when a registered socket is ready.
+ * \param[in] events the epoll events that occurred, e.g. EPOLLIN.
+ * \param[in] context the user context given at registration.
+ */
+using EventCallback = void (*)(std::uint32_t events, void* context);
+
+/**
+ * \brief A reactor multiplexing many sockets on one thread.
+ * \details Any Socket< Derived > is registered with a callback and a context
+ * pointer. Readiness is reported edge-triggered by epoll, thus a callback must
+ * read or write until the socket returns EAGAIN. The registrations and the
+ * event buffer are statically sized, no memory is allocated while
+ * dispatching.
+ * \tparam Capacity the maximum number of registered sockets.
+ */
+template < std::size_t Capacity > class EventLoop
+{
+  public:
+    /**
+     * \brief Default constructor creating the epoll instance.
+     */
+    EventLoop() noexcept
+        : m_epoll{epoll_create1(EPOLL_CLOEXEC)}, m_last_error{0}
+    {
+        static_assert(Capacity > 0U, "The loop must hold at least one socket.");
+
+        if (m_epoll < 0)
+        {
+            m_last_error = errno;
+        }
+
+        for (auto& handler : m_handlers)
+        {
+            handler = Handler{get_invalid_alias(), nullptr, nullptr, 0U};
+        }
+    }
+
+    /**
+     * \brief Destructor closes the epoll instance. The sockets registered are
+     * not closed.
+     */
+    ~EventLoop() noexcept
+    {
+        if (is_initialized() == true)
+        {
+            ::close(m_epoll);
+        }
+    }
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    /**
+     * \brief If the epoll instance was created.
+     */
+    bool is_initialized() const noexcept { return m_epoll >= 0; }
+
+    /**
+     * \brief Registers a socket and switches it into non-blocking mode.
+     * \tparam Derived the concrete socket type, e.g. CanSocket or TcpSocket.
+     * \param[in] socket the socket to watch.
+     * \param[in] callback the function called on readiness.
+     * \param[in] context the user context given to the callback.
+     * \param[in] events the events to watch, EPOLLIN by default.
+     * \return true if the socket is registered, false if the loop is full or
+     * registering failed.
+     */
+    template < typename Derived >
+    bool add(Socket< Derived >& socket, const EventCallback callback,
+             void* context, const std::uint32_t events = EPOLLIN) noexcept
+    {
+        bool added{false};
+
+        if (socket.set_blocking(false) == true)
+        {
+            added = add(socket.get_socket(), callback, context, events);
+        }
+
+        return added;
+    }
+
+    /**
+     * \brief Registers a file descriptor, e.g. an eventfd or timerfd. The
+     * descriptor must be non-blocking.
+     * \param[in] handle the file descriptor to watch.
+     * \param[in] callback the function called on readiness.
+     * \param[in] context the user context given to the callback.
+     * \param[in] events the events to watch, EPOLLIN by default.
+     * \return true if the descriptor is registered, false if not.
+     */
+    bool add(const SocketHandleType handle, const EventCallback callback,
+             void* context, const std::uint32_t events = EPOLLIN) noexcept
+    {
+        bool added{false};
+        Handler* slot = find(get_invalid_alias());
+
+        if ((is_initialized() == true) && (slot != nullptr) &&
+            (callback != nullptr) && (find(handle) == nullptr))
+        {
+            struct epoll_event event;
+            event.events = events | EPOLLET;
+            event.data.u64 = tag(*slot);
+            const int ctl = epoll_ctl(m_epoll, EPOLL_CTL_ADD, handle, &event);
+
+            if (ctl == 0)
+            {
+                *slot = Handler{handle, callback, context, slot->generation};
+                added = true;
+            }
+            else
+            {
+                m_last_error = errno;
+            }
+        }
+
+        return added;
+    }
+
+    /**
+     * \brief Changes the events watched, e.g. to wait for EPOLLOUT while a
+     * send is pending.
+     * \param[in] handle the registered file descriptor.
+     * \param[in] events the events to watch.
+     * \return true if changed, false if the descriptor is not registered.
+     */
+    bool modify(const SocketHandleType handle,
+                const std::uint32_t events) noexcept
+    {
+        bool modified{false};
+        Handler* slot = find(handle);
+
+        if (slot != nullptr)
+        {
+            struct epoll_event event;
+            event.events = events | EPOLLET;
+            event.data.u64 = tag(*slot);
+            const int ctl = epoll_ctl(m_epoll, EPOLL_CTL_MOD, handle, &event);
+            modified = (ctl == 0);
+
+            if (modified == false)
+            {
+                m_last_error = errno;
+            }
+        }
+
+        return modified;
+    }
+
+    /**
+     * \brief Unregisters a file descriptor. This must be called before the
+     * socket is closed.
+     * \param[in] handle the registered file descriptor.
+     * \return true if removed, false if the descriptor is not registered.
+     */
+    bool remove(const SocketHandleType handle) noexcept
+    {
+        bool removed{false};
+        Handler* slot = find(handle);
+
+        if (slot != nullptr)
+        {
+            epoll_ctl(m_epoll, EPOLL_CTL_DEL, handle, nullptr);
+            // events of the same batch still pending for the old
+            // registration are dropped by the new generation.
+            *slot = Handler{get_invalid_alias(), nullptr, nullptr,
+                            slot->generation + 1U};
+            removed = true;
+        }
+
+        return removed;
+    }
+
+    /**
+     * \brief Unregisters a socket.
+     * \param[in] socket the registered socket.
+     * \return true if removed, false if the socket is not registered.
+     */
+    template < typename Derived >
+    bool remove(const Socket< Derived >& socket) noexcept
+    {
+        return remove(socket.get_socket());
+    }
+
+    /**
+     * \brief Waits for events and calls the callbacks of all ready sockets.
+     * \param[in] deadline Time to wait for the first event, rounded up to
+     * milliseconds so a short wait does not turn into polling.
+     * \return the number of events dispatched, zero on timeout or -1 on error.
+     */
+    template < typename Duration >
+    std::int16_t run_once(const Duration&& deadline) noexcept
+    {
+        auto ms =
+            std::chrono::duration_cast< std::chrono::milliseconds >(deadline);
+
+        if (ms < deadline)
+        {
+            ++ms;
+        }
+
+        return dispatch(static_cast< int >(ms.count()));
+    }
+
+    /**
+     * \brief Waits without timeout for events and calls the callbacks of all
+     * ready sockets.
+     * \return the number of events dispatched or -1 on error.
+     */
+    std::int16_t run_once() noexcept { return dispatch(-1); }
+
+    /**
+     * \brief Dispatches events as long as the given variable is true.
+     * \param[in] running the loop is left as soon as this is false.
+     * \param[in] deadline the maximum time to wait before running is checked.
+     */
+    template < typename Duration >
+    void run(const bool& running, const Duration&& deadline) noexcept
+    {
+        while (running == true)
+        {
+            run_once(std::move(deadline));
+        }
+    }
+
+    /**
+     * \brief Gets the last error for error handling purposes.
+     */
+    SocketErrorType get_last_error() const noexcept { return m_last_error; }
+
+  private:
+    /**
+     * \brief One registration: the descriptor and its callback.
+     */
+    struct Handler
+    {
+        SocketHandleType handle;
+        EventCallback callback;
+        void* context;
+        /// incremented on every removal of the registration.
+        std::uint32_t generation;
+    };
+
+    /**
+     * \brief The epoll user data of a registration: the generation in the
+     * upper and the index of the slot in the lower 32 bits.
+     */
+    std::uint64_t tag(const Handler& handler) const noexcept
+    {
+        const auto index =
+            static_cast< std::uint64_t >(&handler - m_handlers.data());
+        return (static_cast< std::uint64_t >(handler.generation) << 32U) |
+               index;
+    }
+
+    /**
+     * \brief Search the registration of a descriptor.
+     */
+    Handler* find(const SocketHandleType handle) noexcept
+    {
+        Handler* found{nullptr};
+
+        for (auto& handler : m_handlers)
+        {
+            if (handler.handle == handle)
+            {
+                found = &handler;
+                break;
+            }
+        }
+
+        return found;
+    }
+
+    /**
+     * \brief Waits for events and dispatches them.
+     * \param[in] timeout_ms timeout of epoll_wait in milliseconds.
+     */
+    std::int16_t dispatch(const int timeout_ms) noexcept
+    {
+        std::int16_t dispatched{-1};
+        const int nevents =
+            epoll_wait(m_epoll, m_events.data(),
+                       static_cast< int >(m_events.size()), timeout_ms);
+
+        if (nevents >= 0)
+        {
+            for (int i = 0; i < nevents; ++i)
+            {
+                const std::uint64_t tagged = m_events[i].data.u64;
+                const Handler& handler = m_handlers[tagged & 0xFFFFFFFFU];
+
+                // a callback may have removed or replaced a socket of the
+                // same batch.
+                if ((handler.callback != nullptr) &&
+                    (tag(handler) == tagged))
+                {
+                    handler.callback(m_events[i].events, handler.context);
+                }
+            }
+
+            dispatched = static_cast< std::int16_t >(nevents);
+        }
+        else if (errno == EINTR)
+        {
+            // interrupted by a signal, nothing dispatched.
+            dispatched = 0;
+        }
+        else
+        {
+            m_last_error = errno;
+        }
+
+        return dispatched;
+    }
+
+    /// registrations of the sockets watched.
+    std::array< Handler, Capacity > m_handlers;
+
+    /// events returned by one epoll_wait.
+    std::array< struct epoll_event, Capacity > m_events;
+
+    /// the epoll instance.
+    int m_epoll;
+
+    /// Stores the last error occurred.
+    SocketErrorType m_last_error;
+};
+
+#endif /* EVENTLOOP_H_ */
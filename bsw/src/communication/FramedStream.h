@@ -0,0 +1,322 @@
+/**
+ * \file      FramedStream.h
+ * \author    dtuchscherer <daniel.tuchscherer@gmail.com>
+ * \brief     Message framing over TCP/IP
+ * \details   Streaming decoder for length-prefixed Packet messages on a TCP/IP
+ *            byte stream.
+ * \copyright Copyright (c) 2018, dtuchscherer.
+ *            All rights reserved.
+ *
+ *            Redistributions and use in source and binary forms, with
+ *            or without modifications, are permitted provided that the
+ *            following conditions are met: Redistributions of source code must
+ *            retain the above copyright notice, this list of conditions and the
+ *            following disclaimer.
+ *
+ *            Redistributions in binary form must reproduce the above copyright
+ *            notice, this list of conditions and the following disclaimer in
+ *            the documentation and/or other materials provided with the
+ *            distribution.
+ *
+ *            Neither the name of the Heilbronn University nor the name of its
+ *            contributors may be used to endorse or promote products derived
+ *            from this software without specific prior written permission.
+ *
+ *            THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS “AS IS”
+ *            AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ *            TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ *            PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE REGENTS
+ *            OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *            SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *            LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *            USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *            AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *            LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *            ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *            POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef FRAMEDSTREAM_H_
+#define FRAMEDSTREAM_H_
+
+#include "Packet.h"
+#include "TcpSocket.h"
+#include <algorithm>
+#include <array>
+#include <poll.h>
+
+/**
+ * \brief Length-prefixed message framing over a TCP/IP stream.
+ * \details TCP is a byte stream: one receive may return a part of a message
+ * or several messages at once. Every message is therefore prefixed with its
+ * length as an unsigned word in network-byte-order. The receiver keeps the
+ * bytes in a ring buffer that is filled with as many bytes as the kernel has
+ * with one system call. Then all complete frames are taken out one by one.
+ * If the ring is full, nothing is read from the socket until frames are
+ * taken out, thus the TCP flow control throttles the sender (back-pressure).
+ * \tparam Capacity the size of the ring buffer in bytes. Must be a power of
+ * two and hold at least one frame of the largest Packet received.
+ */
+template < std::size_t Capacity > class FramedStream
+{
+  public:
+    /// number of bytes of the length prefix of every frame.
+    static constexpr std::size_t HEADER_LEN{sizeof(std::uint16_t)};
+
+    /**
+     * \brief Default constructor for an empty stream.
+     */
+    FramedStream() noexcept
+        : m_head{0U}, m_tail{0U}, m_closed{false}, m_protocol_error{false}
+    {
+        static_assert((Capacity > HEADER_LEN) &&
+                          ((Capacity & (Capacity - 1U)) == 0U),
+                      "The capacity must be a power of two.");
+    }
+
+    /**
+     * \brief Receives as many bytes as the kernel has with one system call.
+     * \param[in] socket the connected socket to read from.
+     * \return the number of bytes read. Zero if the ring is full or the peer
+     * closed the connection (see is_closed()). If there was an error, -1 is
+     * returned and the error is stored in the socket (EAGAIN if
+     * non-blocking and no data is pending).
+     */
+    std::int32_t fill(TcpSocket& socket) noexcept
+    {
+        std::int32_t bytes_read{0};
+        const std::size_t free_bytes = Capacity - available();
+
+        if (free_bytes > 0U)
+        {
+            // the free space may wrap around the end of the ring.
+            const std::size_t begin = m_tail & MASK;
+            const std::size_t first = std::min(free_bytes, Capacity - begin);
+            std::array< struct iovec, 2U > iovs;
+            iovs[0].iov_base = &m_ring[begin];
+            iovs[0].iov_len = first;
+            iovs[1].iov_base = &m_ring[0];
+            iovs[1].iov_len = free_bytes - first;
+
+            struct msghdr msg;
+            std::memset(&msg, 0, sizeof(msg));
+            msg.msg_iov = iovs.data();
+            msg.msg_iovlen = (iovs[1].iov_len > 0U) ? 2U : 1U;
+            const ssize_t received = ::recvmsg(socket.get_socket(), &msg, 0);
+
+            if (received > 0)
+            {
+                m_tail += static_cast< std::uint32_t >(received);
+                bytes_read = static_cast< std::int32_t >(received);
+            }
+            else if (received == 0)
+            {
+                // orderly shutdown by the peer.
+                m_closed = true;
+            }
+            else
+            {
+                socket.SetErrorNumber(errno);
+                bytes_read = -1;
+            }
+        }
+
+        return bytes_read;
+    }
+
+    /**
+     * \brief Takes the next complete frame out of the ring.
+     * \tparam Size the size of the packet.
+     * \param[out] packet the packet the payload is copied to. Its read and
+     * write position is reset.
+     * \param[out] length the payload length of the frame.
+     * \return true if a frame was taken, false if there is no complete frame
+     * or the frame exceeds the packet (see has_protocol_error()).
+     */
+    template < std::size_t Size >
+    bool next(Packet< Size >& packet, std::uint16_t& length) noexcept
+    {
+        static_assert(Size + HEADER_LEN <= Capacity,
+                      "The ring must hold at least one complete frame.");
+        bool taken{false};
+
+        if ((m_protocol_error == false) && (available() >= HEADER_LEN))
+        {
+            std::array< std::uint8_t, HEADER_LEN > header;
+            copy_out(m_head, header.data(), HEADER_LEN);
+            const std::uint16_t frame_len = static_cast< std::uint16_t >(
+                (header[0] << 8U) | header[1]);
+
+            if (frame_len > Size)
+            {
+                // the stream is out of sync or the peer sends too large
+                // messages, we're not able to recover.
+                m_protocol_error = true;
+            }
+            else if (available() >= (HEADER_LEN + frame_len))
+            {
+                copy_out(m_head + HEADER_LEN, packet.get_data().data(),
+                         frame_len);
+                m_head += static_cast< std::uint32_t >(HEADER_LEN + frame_len);
+                packet.clear();
+                length = frame_len;
+                taken = true;
+            }
+        }
+
+        return taken;
+    }
+
+    /**
+     * \brief Sends one frame: length prefix and payload with one system call
+     * and without copying the payload.
+     * \details If the kernel takes a part of the frame only, the rest is sent
+     * right away, waiting for a non-blocking socket to become writable, as
+     * the peer would lose the frame boundaries otherwise. If nothing was sent
+     * the frame may be sent again later.
+     * \tparam Size the size of the packet.
+     * \param[in] socket the connected socket to send with.
+     * \param[in] packet the packet holding the payload.
+     * \param[in] length the number of bytes of the packet to send.
+     * \return the number of bytes sent including the prefix or -1 on error.
+     */
+    template < std::size_t Size >
+    static std::int32_t send(TcpSocket& socket, const Packet< Size >& packet,
+                             const std::uint16_t length) noexcept
+    {
+        static_assert(Size <= 0xFFFFU, "The frame length must fit a word.");
+        const std::uint16_t frame_len =
+            std::min(length, static_cast< std::uint16_t >(Size));
+        const std::uint16_t header = to_network< std::uint16_t >(frame_len);
+        std::array< struct iovec, 2U > buffers{
+            {TcpSocket::make_buffer(&header, HEADER_LEN),
+             TcpSocket::make_buffer(packet.get_data().data(), frame_len)}};
+        const auto frame_bytes =
+            static_cast< std::int32_t >(HEADER_LEN + frame_len);
+        std::int32_t sent{0};
+        std::size_t first{0U};
+
+        while ((sent >= 0) && (sent < frame_bytes))
+        {
+            const std::int32_t nbytes =
+                socket.send_vectored(&buffers[first], buffers.size() - first);
+
+            if (nbytes > 0)
+            {
+                sent += nbytes;
+                first = skip_sent(buffers, first,
+                                  static_cast< std::size_t >(nbytes));
+            }
+            else if ((sent == 0) || (wait_writable(socket) == false))
+            {
+                sent = -1;
+            }
+        }
+
+        return sent;
+    }
+
+    /**
+     * \brief The number of bytes received and not yet taken out.
+     */
+    std::size_t available() const noexcept { return m_tail - m_head; }
+
+    /**
+     * \brief true if the peer closed the connection.
+     */
+    bool is_closed() const noexcept { return m_closed; }
+
+    /**
+     * \brief true if a frame exceeded the packet. The stream must be reset.
+     */
+    bool has_protocol_error() const noexcept { return m_protocol_error; }
+
+    /**
+     * \brief Drops all bytes, e.g. after reconnecting.
+     */
+    void reset() noexcept
+    {
+        m_head = 0U;
+        m_tail = 0U;
+        m_closed = false;
+        m_protocol_error = false;
+    }
+
+  private:
+    /// wraps the free running indices into the ring.
+    static constexpr std::uint32_t MASK =
+        static_cast< std::uint32_t >(Capacity - 1U);
+
+    /**
+     * \brief Advances the io vectors past the bytes sent.
+     * \return the index of the first io vector not sent completely.
+     */
+    static std::size_t skip_sent(std::array< struct iovec, 2U >& buffers,
+                                 std::size_t first, std::size_t sent) noexcept
+    {
+        while ((first < buffers.size()) && (sent >= buffers[first].iov_len))
+        {
+            sent -= buffers[first].iov_len;
+            ++first;
+        }
+
+        if (first < buffers.size())
+        {
+            buffers[first].iov_base =
+                static_cast< std::uint8_t* >(buffers[first].iov_base) + sent;
+            buffers[first].iov_len -= sent;
+        }
+
+        return first;
+    }
+
+    /**
+     * \brief Waits for the socket to take more data after a partial send.
+     * \return true if the socket is writable, false on a socket error.
+     */
+    static bool wait_writable(TcpSocket& socket) noexcept
+    {
+        const auto error = socket.get_last_error();
+        bool writable{false};
+
+        if ((error == EAGAIN) || (error == EWOULDBLOCK) || (error == EINTR))
+        {
+            struct pollfd event;
+            event.fd = socket.get_socket();
+            event.events = POLLOUT;
+            event.revents = 0;
+            writable = (::poll(&event, 1U, -1) >= 0) || (errno == EINTR);
+        }
+
+        return writable;
+    }
+
+    /**
+     * \brief Copies bytes out of the ring, the range may wrap around.
+     */
+    void copy_out(const std::uint32_t from, std::uint8_t* to,
+                  const std::size_t len) const noexcept
+    {
+        const std::size_t begin = from & MASK;
+        const std::size_t first = std::min(len, Capacity - begin);
+        std::memcpy(to, &m_ring[begin], first);
+        std::memcpy(to + first, &m_ring[0], len - first);
+    }
+
+    /// the bytes received.
+    std::array< std::uint8_t, Capacity > m_ring;
+
+    /// free running index of the next byte to take out.
+    std::uint32_t m_head;
+
+    /// free running index of the next byte to receive.
+    std::uint32_t m_tail;
+
+    /// true if the peer closed the connection.
+    bool m_closed;
+
+    /// true if a frame exceeded the packet.
+    bool m_protocol_error;
+};
+
+#endif /* FRAMEDSTREAM_H_ */
@@ -0,0 +1,768 @@
+/**
+ * \file      IsoTp.h
+ * \author    dtuchscherer <daniel.tuchscherer@gmail.com>
+ * \brief     ISO-TP (ISO 15765-2) transport protocol in user space
+ * \details   Segmentation and reassembly of messages up to 4 GiB over CAN
+ *            frames with flow control, for kernels without CAN_ISOTP.
+ * \copyright Copyright (c) 2018, dtuchscherer.
+ *            All rights reserved.
+ *
+ *            Redistributions and use in source and binary forms, with
+ *            or without modifications, are permitted provided that the
+ *            following conditions are met: Redistributions of source code must
+ *            retain the above copyright notice, this list of conditions and the
+ *            following disclaimer.
+ *
+ *            Redistributions in binary form must reproduce the above copyright
+ *            notice, this list of conditions and the following disclaimer in
+ *            the documentation and/or other materials provided with the
+ *            distribution.
+ *
+ *            Neither the name of the Heilbronn University nor the name of its
+ *            contributors may be used to endorse or promote products derived
+ *            from this software without specific prior written permission.
+ *
+ *            THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS “AS IS”
+ *            AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ *            TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ *            PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE REGENTS
+ *            OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *            SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *            LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *            USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *            AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *            LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *            ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *            POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef ISOTP_H_
+#define ISOTP_H_
+
+#include "CanSocket.h"
+#include "Packet.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * \brief Configuration of an ISO-TP connection (normal addressing).
+ */
+struct IsoTpConfig
+{
+    /// CAN identifier of the frames sent.
+    CanIDType tx_id;
+
+    /// CAN identifier of the frames received.
+    CanIDType rx_id;
+
+    /// block size announced to the sender: number of consecutive frames
+    /// until the next flow control. 0 sends all frames without a pause.
+    std::uint8_t block_size;
+
+    /// minimum separation time announced to the sender, encoded as on the
+    /// bus: 0x00 - 0x7F milliseconds, 0xF1 - 0xF9 100 - 900 microseconds.
+    std::uint8_t st_min;
+
+    /// if true the frames sent are padded to 8 bytes with padding.
+    bool pad;
+
+    /// the value of the padding bytes.
+    std::uint8_t padding;
+};
+
+/**
+ * \brief Creates a configuration with padding and without flow control
+ * pauses.
+ * \param[in] tx_id CAN identifier of the frames sent.
+ * \param[in] rx_id CAN identifier of the frames received.
+ * \param[in] block_size see IsoTpConfig::block_size.
+ * \param[in] st_min see IsoTpConfig::st_min.
+ */
+constexpr IsoTpConfig make_isotp_config(const CanIDType tx_id,
+                                        const CanIDType rx_id,
+                                        const std::uint8_t block_size = 0U,
+                                        const std::uint8_t st_min = 0U) noexcept
+{
+    return IsoTpConfig{tx_id, rx_id, block_size, st_min, true, 0xCCU};
+}
+
+/**
+ * \brief Decodes the minimum separation time of a flow control frame.
+ * \param[in] st_min the raw value. Reserved values are treated as the
+ * maximum of 127 ms as the standard requests.
+ * \return the time to wait between two consecutive frames.
+ */
+constexpr std::chrono::microseconds isotp_st_min(const std::uint8_t st_min)
+{
+    return (st_min <= 0x7FU)
+               ? std::chrono::microseconds{st_min * 1000U}
+               : (((st_min >= 0xF1U) && (st_min <= 0xF9U))
+                      ? std::chrono::microseconds{(st_min - 0xF0U) * 100U}
+                      : std::chrono::microseconds{127000U});
+}
+
+/**
+ * \brief Errors that abort an ISO-TP transfer.
+ */
+enum class IsoTpError
+{
+    /// no error.
+    NONE,
+    /// no flow control frame received in time (N_Bs).
+    TIMEOUT_FLOW_CONTROL,
+    /// no consecutive frame received in time (N_Cr).
+    TIMEOUT_CONSECUTIVE,
+    /// a consecutive frame with an unexpected sequence number.
+    WRONG_SEQUENCE,
+    /// the message does not fit into the receive buffer, or the receiver
+    /// reported an overflow.
+    OVERFLOW,
+    /// a frame that is invalid or not expected in the current state.
+    UNEXPECTED_FRAME,
+    /// a transfer is already running.
+    BUSY
+};
+
+/**
+ * \brief ISO-TP transport (ISO 15765-2) over classic CAN frames as a
+ * non-blocking state machine.
+ * \details A message is sent as one single frame if it fits into 7 bytes.
+ * Otherwise a first frame is sent and, after the receiver answered with a
+ * flow control frame, the rest follows in consecutive frames, paced by the
+ * block size and STmin of the receiver. Messages longer than 4095 bytes use
+ * the 32 bit length of ISO 15765-2:2016.
+ *
+ * Nothing is buffered: consecutive frames are copied directly from the
+ * data given to send(), received frames are reassembled directly into the
+ * Packet given to set_rx_buffer().
+ *
+ * The state machine is driven by on_frame() for every frame received from
+ * the link and poll() to send pending consecutive frames and detect
+ * timeouts. transmit() and receive() do this in a blocking loop.
+ * \tparam Link the CAN link, CanSocket by default. It needs
+ * send(CanIDType, const CanStdData&, std::uint8_t) returning > 0 on success.
+ */
+template < typename Link = CanSocket > class IsoTpTransport
+{
+  public:
+    /// The clock for STmin and timeouts.
+    using Clock = std::chrono::steady_clock;
+
+    /// Timeout waiting for a flow control or consecutive frame.
+    static constexpr std::chrono::milliseconds TIMEOUT{1000};
+
+    /**
+     * \brief Creates a transport on a CAN link.
+     * \param[in] link the CAN link to send and receive frames.
+     * \param[in] config identifiers and flow control parameters.
+     */
+    IsoTpTransport(Link& link, const IsoTpConfig& config) noexcept
+        : m_link(link), m_config(config), m_tx_data{nullptr}, m_tx_len{0U},
+          m_tx_offset{0U}, m_tx_state{TxState::IDLE}, m_tx_sequence{0U},
+          m_tx_block_left{0U}, m_tx_st_min{0}, m_rx_buffer{nullptr},
+          m_rx_capacity{0U}, m_rx_len{0U}, m_rx_offset{0U},
+          m_rx_state{RxState::IDLE}, m_rx_sequence{0U}, m_rx_block_count{0U},
+          m_rx_complete{false}, m_last_error{IsoTpError::NONE}
+    {
+    }
+
+    /**
+     * \brief Sets the buffer messages are reassembled into.
+     * \param[in] packet the caller's packet. It must outlive the transport
+     * or be replaced before the next message arrives.
+     */
+    template < std::size_t Size >
+    void set_rx_buffer(Packet< Size >& packet) noexcept
+    {
+        m_rx_buffer = packet.get_data().data();
+        m_rx_capacity = Size;
+    }
+
+    /**
+     * \brief Starts sending a message. The data is not copied and must stay
+     * valid until tx_busy() returns false.
+     * \param[in] data the message.
+     * \param[in] len the length of the message.
+     * \param[in] now the current time.
+     * \return true if the transfer was started, false if a transfer is
+     * already running or the first frame could not be sent.
+     */
+    bool send(const std::uint8_t* data, const std::size_t len,
+              const Clock::time_point now = Clock::now()) noexcept
+    {
+        if (tx_busy())
+        {
+            m_last_error = IsoTpError::BUSY;
+            return false;
+        }
+
+        CanStdData frame{};
+        std::uint8_t frame_len{0U};
+
+        if (len <= SF_DATA_LEN)
+        {
+            frame[0] = static_cast< std::uint8_t >(len);
+            std::memcpy(&frame[1], data, len);
+            frame_len = static_cast< std::uint8_t >(len + 1U);
+            m_tx_offset = len;
+        }
+        else if (len <= FF_MAX_LEN)
+        {
+            frame[0] = static_cast< std::uint8_t >(0x10U | (len >> 8U));
+            frame[1] = static_cast< std::uint8_t >(len);
+            std::memcpy(&frame[2], data, 6U);
+            frame_len = 8U;
+            m_tx_offset = 6U;
+        }
+        else
+        {
+            // escape sequence: the length follows as 32 bit value.
+            frame[0] = 0x10U;
+            frame[1] = 0x00U;
+            frame[2] = static_cast< std::uint8_t >(len >> 24U);
+            frame[3] = static_cast< std::uint8_t >(len >> 16U);
+            frame[4] = static_cast< std::uint8_t >(len >> 8U);
+            frame[5] = static_cast< std::uint8_t >(len);
+            std::memcpy(&frame[6], data, 2U);
+            frame_len = 8U;
+            m_tx_offset = 2U;
+        }
+
+        const bool sent = transmit_frame(frame, frame_len);
+
+        if (sent && (len > SF_DATA_LEN))
+        {
+            m_tx_data = data;
+            m_tx_len = len;
+            m_tx_sequence = 1U;
+            m_tx_state = TxState::WAIT_FLOW_CONTROL;
+            m_tx_deadline = now + TIMEOUT;
+        }
+
+        return sent;
+    }
+
+    /**
+     * \brief Starts sending the first len bytes of a packet.
+     */
+    template < std::size_t Size >
+    bool send(const Packet< Size >& packet, const std::size_t len,
+              const Clock::time_point now = Clock::now()) noexcept
+    {
+        return send(packet.get_data().data(), std::min(len, Size), now);
+    }
+
+    /**
+     * \brief Processes a frame received from the link. Frames with another
+     * identifier than rx_id are ignored.
+     * \param[in] frame the frame received.
+     * \param[in] now the time the frame was received.
+     */
+    void on_frame(const CanFrame& frame,
+                  const Clock::time_point now = Clock::now()) noexcept
+    {
+        if ((frame.can_id != m_config.rx_id) || (frame.len == 0U))
+        {
+            return;
+        }
+
+        switch (frame.data[0] >> 4U)
+        {
+        case 0x0U:
+            on_single_frame(frame);
+            break;
+        case 0x1U:
+            on_first_frame(frame, now);
+            break;
+        case 0x2U:
+            on_consecutive_frame(frame, now);
+            break;
+        case 0x3U:
+            on_flow_control(frame, now);
+            break;
+        default:
+            m_last_error = IsoTpError::UNEXPECTED_FRAME;
+            break;
+        }
+    }
+
+    /**
+     * \brief Sends all consecutive frames that are due and checks the
+     * timeouts. Call this at least every STmin while tx_busy().
+     * \param[in] now the current time.
+     */
+    void poll(const Clock::time_point now = Clock::now()) noexcept
+    {
+        if ((m_tx_state == TxState::WAIT_FLOW_CONTROL) &&
+            (now >= m_tx_deadline))
+        {
+            abort_tx(IsoTpError::TIMEOUT_FLOW_CONTROL);
+        }
+
+        while ((m_tx_state == TxState::SENDING) && (now >= m_tx_next))
+        {
+            if (send_consecutive_frame(now) == false)
+            {
+                // the transmit queue is full, try again on the next poll.
+                break;
+            }
+        }
+
+        if ((m_rx_state == RxState::RECEIVING) && (now >= m_rx_deadline))
+        {
+            abort_rx(IsoTpError::TIMEOUT_CONSECUTIVE);
+        }
+    }
+
+    /**
+     * \brief Checks if a message was received completely. Returns true only
+     * once per message.
+     * \param[out] len the length of the message in the receive buffer.
+     * \return true if a new message is in the receive buffer.
+     */
+    bool rx_complete(std::size_t& len) noexcept
+    {
+        const bool complete = m_rx_complete;
+
+        if (complete)
+        {
+            len = m_rx_len;
+            m_rx_complete = false;
+        }
+
+        return complete;
+    }
+
+    /**
+     * \brief A message is being sent.
+     */
+    bool tx_busy() const noexcept { return m_tx_state != TxState::IDLE; }
+
+    /**
+     * \brief A segmented message is being received.
+     */
+    bool rx_busy() const noexcept { return m_rx_state != RxState::IDLE; }
+
+    /**
+     * \brief The error that aborted the last transfer.
+     */
+    IsoTpError get_last_error() const noexcept { return m_last_error; }
+
+    /**
+     * \brief Sends a message and blocks until it is sent completely,
+     * receiving the flow control frames from the link.
+     * \param[in] data the message.
+     * \param[in] len the length of the message.
+     * \return true if the message was sent, false on error or timeout.
+     */
+    bool transmit(const std::uint8_t* data, const std::size_t len) noexcept
+    {
+        m_last_error = IsoTpError::NONE;
+        bool sent = send(data, len);
+
+        while (sent && tx_busy())
+        {
+            process_link(Clock::now());
+        }
+
+        return sent && (m_last_error == IsoTpError::NONE);
+    }
+
+    /**
+     * \brief Waits for a message and reassembles it into the packet.
+     * \param[out] packet the buffer to receive into.
+     * \param[out] len the length of the message received.
+     * \param[in] timeout time to wait for the message to begin.
+     * \return true if a message was received, false on error or timeout.
+     */
+    template < std::size_t Size, typename Duration >
+    bool receive(Packet< Size >& packet, std::size_t& len,
+                 const Duration& timeout) noexcept
+    {
+        set_rx_buffer(packet);
+        m_last_error = IsoTpError::NONE;
+        const auto until = Clock::now() + timeout;
+        bool received = false;
+
+        while ((received == false) && (m_last_error == IsoTpError::NONE) &&
+               (rx_busy() || (Clock::now() < until)))
+        {
+            process_link(Clock::now());
+            received = rx_complete(len);
+        }
+
+        return received;
+    }
+
+  private:
+    /// states of the sender.
+    enum class TxState
+    {
+        IDLE,
+        WAIT_FLOW_CONTROL,
+        SENDING
+    };
+
+    /// states of the receiver.
+    enum class RxState
+    {
+        IDLE,
+        RECEIVING
+    };
+
+    /// payload of a single frame.
+    static constexpr std::size_t SF_DATA_LEN{7U};
+
+    /// payload of a consecutive frame.
+    static constexpr std::size_t CF_DATA_LEN{7U};
+
+    /// largest length of a first frame without escape sequence.
+    static constexpr std::size_t FF_MAX_LEN{4095U};
+
+    /// flow status: continue to send.
+    static constexpr std::uint8_t FC_CTS{0U};
+
+    /// flow status: wait for the next flow control.
+    static constexpr std::uint8_t FC_WAIT{1U};
+
+    /// flow status: the message does not fit into the receive buffer.
+    static constexpr std::uint8_t FC_OVERFLOW{2U};
+
+    /**
+     * \brief Receives pending frames from the link and polls the state
+     * machine. Waits until the next consecutive frame is due at most.
+     */
+    void process_link(const Clock::time_point now) noexcept
+    {
+        using namespace std::chrono;
+        auto wait = microseconds{1000};
+
+        if (m_tx_state == TxState::SENDING)
+        {
+            wait = (m_tx_next > now)
+                       ? duration_cast< microseconds >(m_tx_next - now)
+                       : microseconds{0};
+        }
+
+        std::array< CanFrame, 16U > frames;
+        const auto nframes = m_link.receive_batch(frames, std::move(wait));
+
+        for (std::int16_t i = 0; i < nframes; ++i)
+        {
+            on_frame(frames[static_cast< std::size_t >(i)], Clock::now());
+        }
+
+        poll(Clock::now());
+    }
+
+    /**
+     * \brief Sends one frame with tx_id, padded if configured.
+     */
+    bool transmit_frame(CanStdData& frame, std::uint8_t len) noexcept
+    {
+        if (m_config.pad)
+        {
+            std::fill(frame.begin() + len, frame.end(), m_config.padding);
+            len = static_cast< std::uint8_t >(frame.size());
+        }
+
+        return m_link.send(m_config.tx_id, frame, len) > 0;
+    }
+
+    /**
+     * \brief Sends a flow control frame with the configured parameters.
+     */
+    bool send_flow_control(const std::uint8_t status) noexcept
+    {
+        CanStdData frame{};
+        frame[0] = static_cast< std::uint8_t >(0x30U | status);
+        frame[1] = m_config.block_size;
+        frame[2] = m_config.st_min;
+        return transmit_frame(frame, 3U);
+    }
+
+    /**
+     * \brief Sends the next consecutive frame.
+     * \return false if the link did not accept the frame.
+     */
+    bool send_consecutive_frame(const Clock::time_point now) noexcept
+    {
+        const auto chunk = std::min(CF_DATA_LEN, m_tx_len - m_tx_offset);
+        CanStdData frame{};
+        frame[0] = static_cast< std::uint8_t >(0x20U | m_tx_sequence);
+        std::memcpy(&frame[1], m_tx_data + m_tx_offset, chunk);
+
+        const bool sent =
+            transmit_frame(frame, static_cast< std::uint8_t >(chunk + 1U));
+
+        if (sent)
+        {
+            m_tx_offset += chunk;
+            m_tx_sequence = static_cast< std::uint8_t >((m_tx_sequence + 1U) &
+                                                        0x0FU);
+            m_tx_next = now + m_tx_st_min;
+
+            if (m_tx_offset >= m_tx_len)
+            {
+                m_tx_state = TxState::IDLE;
+            }
+            else if ((m_tx_block_left > 0U) && (--m_tx_block_left == 0U))
+            {
+                // the block is complete, the receiver sends a flow control.
+                m_tx_state = TxState::WAIT_FLOW_CONTROL;
+                m_tx_deadline = now + TIMEOUT;
+            }
+        }
+
+        return sent;
+    }
+
+    /**
+     * \brief A complete message in one frame.
+     */
+    void on_single_frame(const CanFrame& frame) noexcept
+    {
+        const std::size_t len = frame.data[0] & 0x0FU;
+
+        if ((len == 0U) || (len > SF_DATA_LEN) || (len >= frame.len))
+        {
+            m_last_error = IsoTpError::UNEXPECTED_FRAME;
+        }
+        else if ((m_rx_buffer == nullptr) || (len > m_rx_capacity))
+        {
+            abort_rx(IsoTpError::OVERFLOW);
+        }
+        else
+        {
+            // a new message aborts a reception in progress.
+            std::memcpy(m_rx_buffer, &frame.data[1], len);
+            m_rx_len = len;
+            m_rx_state = RxState::IDLE;
+            m_rx_complete = true;
+        }
+    }
+
+    /**
+     * \brief The beginning of a segmented message. A length which fits into
+     * a single frame, or in the escape form into the 12 bit length, is
+     * ignored as required by ISO 15765-2.
+     */
+    void on_first_frame(const CanFrame& frame,
+                        const Clock::time_point now) noexcept
+    {
+        if (frame.len < 8U)
+        {
+            m_last_error = IsoTpError::UNEXPECTED_FRAME;
+            return;
+        }
+
+        std::size_t len = (static_cast< std::size_t >(frame.data[0] & 0x0FU)
+                           << 8U) |
+                          frame.data[1];
+        std::size_t header = 2U;
+
+        if (len == 0U)
+        {
+            len = (static_cast< std::size_t >(frame.data[2]) << 24U) |
+                  (static_cast< std::size_t >(frame.data[3]) << 16U) |
+                  (static_cast< std::size_t >(frame.data[4]) << 8U) |
+                  frame.data[5];
+            header = 6U;
+
+            if (len <= FF_MAX_LEN)
+            {
+                m_last_error = IsoTpError::UNEXPECTED_FRAME;
+                return;
+            }
+        }
+        else if (len <= SF_DATA_LEN)
+        {
+            m_last_error = IsoTpError::UNEXPECTED_FRAME;
+            return;
+        }
+
+        if ((m_rx_buffer == nullptr) || (len > m_rx_capacity))
+        {
+            send_flow_control(FC_OVERFLOW);
+            abort_rx(IsoTpError::OVERFLOW);
+            return;
+        }
+
+        m_rx_offset = std::min(8U - header, len);
+        std::memcpy(m_rx_buffer, &frame.data[header], m_rx_offset);
+        m_rx_len = len;
+        m_rx_sequence = 1U;
+        m_rx_block_count = 0U;
+        m_rx_state = RxState::RECEIVING;
+        m_rx_complete = false;
+        m_rx_deadline = now + TIMEOUT;
+        send_flow_control(FC_CTS);
+    }
+
+    /**
+     * \brief The next part of a segmented message.
+     */
+    void on_consecutive_frame(const CanFrame& frame,
+                              const Clock::time_point now) noexcept
+    {
+        if (m_rx_state != RxState::RECEIVING)
+        {
+            m_last_error = IsoTpError::UNEXPECTED_FRAME;
+            return;
+        }
+
+        if ((frame.data[0] & 0x0FU) != m_rx_sequence)
+        {
+            abort_rx(IsoTpError::WRONG_SEQUENCE);
+            return;
+        }
+
+        // never copy past the message length or the buffer.
+        const std::size_t end = std::min(m_rx_len, m_rx_capacity);
+        const auto chunk = std::min(
+            {CF_DATA_LEN, (end > m_rx_offset) ? end - m_rx_offset : 0U,
+             static_cast< std::size_t >((frame.len > 0U) ? frame.len - 1U
+                                                          : 0U)});
+        std::memcpy(m_rx_buffer + m_rx_offset, &frame.data[1], chunk);
+        m_rx_offset += chunk;
+        m_rx_sequence = static_cast< std::uint8_t >((m_rx_sequence + 1U) &
+                                                    0x0FU);
+        m_rx_deadline = now + TIMEOUT;
+
+        if (m_rx_offset >= m_rx_len)
+        {
+            m_rx_state = RxState::IDLE;
+            m_rx_complete = true;
+        }
+        else if ((m_config.block_size > 0U) &&
+                 (++m_rx_block_count == m_config.block_size))
+        {
+            m_rx_block_count = 0U;
+            send_flow_control(FC_CTS);
+        }
+    }
+
+    /**
+     * \brief The receiver tells how to continue sending.
+     */
+    void on_flow_control(const CanFrame& frame,
+                         const Clock::time_point now) noexcept
+    {
+        if ((m_tx_state != TxState::WAIT_FLOW_CONTROL) || (frame.len < 3U))
+        {
+            m_last_error = IsoTpError::UNEXPECTED_FRAME;
+            return;
+        }
+
+        const std::uint8_t status = frame.data[0] & 0x0FU;
+
+        if (status == FC_CTS)
+        {
+            m_tx_block_left = frame.data[1];
+            m_tx_st_min = isotp_st_min(frame.data[2]);
+            m_tx_next = now;
+            m_tx_state = TxState::SENDING;
+        }
+        else if (status == FC_WAIT)
+        {
+            m_tx_deadline = now + TIMEOUT;
+        }
+        else
+        {
+            abort_tx(IsoTpError::OVERFLOW);
+        }
+    }
+
+    /**
+     * \brief Stops sending because of an error.
+     */
+    void abort_tx(const IsoTpError error) noexcept
+    {
+        m_tx_state = TxState::IDLE;
+        m_last_error = error;
+    }
+
+    /**
+     * \brief Stops receiving because of an error.
+     */
+    void abort_rx(const IsoTpError error) noexcept
+    {
+        m_rx_state = RxState::IDLE;
+        m_rx_complete = false;
+        m_last_error = error;
+    }
+
+    /// the CAN link.
+    Link& m_link;
+
+    /// identifiers and flow control parameters.
+    IsoTpConfig m_config;
+
+    /// the message being sent, owned by the caller.
+    const std::uint8_t* m_tx_data;
+
+    /// length of the message being sent.
+    std::size_t m_tx_len;
+
+    /// bytes of the message sent so far.
+    std::size_t m_tx_offset;
+
+    /// state of the sender.
+    TxState m_tx_state;
+
+    /// sequence number of the next consecutive frame.
+    std::uint8_t m_tx_sequence;
+
+    /// consecutive frames left in the block, 0 if unlimited.
+    std::uint8_t m_tx_block_left;
+
+    /// STmin requested by the receiver.
+    std::chrono::microseconds m_tx_st_min;
+
+    /// when the next consecutive frame may be sent.
+    Clock::time_point m_tx_next;
+
+    /// when the flow control must be received.
+    Clock::time_point m_tx_deadline;
+
+    /// the caller's buffer messages are reassembled into.
+    std::uint8_t* m_rx_buffer;
+
+    /// size of the receive buffer.
+    std::size_t m_rx_capacity;
+
+    /// length of the message being received.
+    std::size_t m_rx_len;
+
+    /// bytes of the message received so far.
+    std::size_t m_rx_offset;
+
+    /// state of the receiver.
+    RxState m_rx_state;
+
+    /// expected sequence number of the next consecutive frame.
+    std::uint8_t m_rx_sequence;
+
+    /// consecutive frames received in the current block.
+    std::uint8_t m_rx_block_count;
+
+    /// a message was received completely and not taken yet.
+    bool m_rx_complete;
+
+    /// when the next consecutive frame must be received.
+    Clock::time_point m_rx_deadline;
+
+    /// the error that aborted the last transfer.
+    IsoTpError m_last_error;
+};
+
+template < typename Link >
+constexpr std::chrono::milliseconds IsoTpTransport< Link >::TIMEOUT;
+
+template < typename Link >
+constexpr std::size_t IsoTpTransport< Link >::CF_DATA_LEN;
+
+#endif /* ISOTP_H_ */
@@ -0,0 +1,168 @@
+/**
+ * \file      IsoTpSocket.cpp
+ * \author    dtuchscherer <daniel.tuchscherer@gmail.com>
+ * \brief     ISO-TP over the SocketCAN CAN_ISOTP protocol
+ * \details   These are the methods of class IsoTpSocket to configure,
+ *            send and receive ISO-TP messages via the Linux kernel.
+ * \version   1.0
+ * \copyright Copyright (c) 2018, Daniel Tuchscherer.
+ *            All rights reserved.
+ *
+ *            Redistributions and use in source and binary forms, with
+ *            or without modifications, are permitted provided that the
+ *            following conditions are met: Redistributions of source code must
+ *            retain the above copyright notice, this list of conditions and the
+ *            following disclaimer.
+ *
+ *            Redistributions in binary form must reproduce the above copyright
+ *            notice, this list of conditions and the following disclaimer in
+ *            the documentation and/or other materials provided with the
+ *            distribution.
+ *
+ *            Neither the name of the Heilbronn University nor the name of its
+ *            contributors may be used to endorse or promote products derived
+ *            from this software without specific prior written permission.
+ *
+ *            THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS “AS IS”
+ *            AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ *            TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ *            PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE REGENTS
+ *            OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *            SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *            LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *            USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *            AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *            LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *            ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *            POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef _WIN32
+#error "SocketCAN for Linux OS only."
+#endif
+#include "IsoTpSocket.h"
+
+////////////////////////////////////////////////////////////////////////////////
+bool IsoTpSocket::create() noexcept
+{
+    bool socket_created{false};
+    socket_ = socket(PF_CAN, SOCK_DGRAM, CAN_ISOTP);
+
+    // check here if the socket was opened.
+    if (get_socket_handle() > 0)
+    {
+        socket_created = true;
+    }
+    else
+    {
+        // ... error opening the socket, e.g. the module can-isotp is missing.
+        last_error_ = errno;
+        socket_created = false;
+    }
+
+    return socket_created;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::int32_t IsoTpSocket::send(const void* data, const std::size_t len) noexcept
+{
+    std::int32_t data_sent{-1};
+
+    if (is_isotp_initialized())
+    {
+        const auto socket = get_socket_handle();
+        data_sent = static_cast< std::int32_t >(write(socket, data, len));
+
+        if (data_sent < 0)
+        {
+            last_error_ = errno;
+        }
+    }
+
+    return data_sent;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::int32_t IsoTpSocket::receive(void* data, const std::size_t len) noexcept
+{
+    std::int32_t data_received{-1};
+
+    if (is_isotp_initialized())
+    {
+        const auto socket = get_socket_handle();
+        data_received = static_cast< std::int32_t >(read(socket, data, len));
+
+        if (data_received < 0)
+        {
+            last_error_ = errno;
+        }
+    }
+
+    return data_received;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool IsoTpSocket::configure(const IsoTpConfig& config) noexcept
+{
+    bool configured{false};
+    const auto socket = get_socket_handle();
+
+    struct can_isotp_options options;
+    std::memset(&options, 0, sizeof(options));
+    options.flags = config.pad ? CAN_ISOTP_TX_PADDING : 0U;
+    options.txpad_content = config.padding;
+    options.rxpad_content = config.padding;
+
+    struct can_isotp_fc_options flow_control;
+    std::memset(&flow_control, 0, sizeof(flow_control));
+    flow_control.bs = config.block_size;
+    flow_control.stmin = config.st_min;
+    flow_control.wftmax = 0U;
+
+    const auto options_set = setsockopt(socket, SOL_CAN_ISOTP, CAN_ISOTP_OPTS,
+                                        &options, sizeof(options));
+    const auto fc_set = setsockopt(socket, SOL_CAN_ISOTP, CAN_ISOTP_RECV_FC,
+                                   &flow_control, sizeof(flow_control));
+
+    if ((options_set >= 0) && (fc_set >= 0))
+    {
+        configured = true;
+    }
+    else
+    {
+        last_error_ = errno;
+        configured = false;
+    }
+
+    return configured;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool IsoTpSocket::bind_if_socket(const unsigned int ifindex,
+                                 const IsoTpConfig& config) noexcept
+{
+    bool bind_success{false};
+    struct sockaddr_can address;
+    std::memset(&address, 0, sizeof(address));
+    address.can_family = AF_CAN;
+    address.can_ifindex = static_cast< int >(ifindex);
+    address.can_addr.tp.tx_id = config.tx_id;
+    address.can_addr.tp.rx_id = config.rx_id;
+
+    const auto handle = get_socket_handle();
+    const int bind_res =
+        bind(handle, (struct sockaddr*)&address, sizeof(address));
+
+    if (bind_res < 0)
+    {
+        last_error_ = errno;
+        bind_success = false;
+        std::cerr << "Bind of ISO-TP socket and interface failed.\n";
+    }
+    else
+    {
+        bind_success = true;
+    }
+
+    return bind_success;
+}
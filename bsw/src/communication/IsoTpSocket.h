@@ -0,0 +1,182 @@
+/**
+ * \file      IsoTpSocket.h
+ * \author    dtuchscherer <daniel.tuchscherer@gmail.com>
+ * \brief     ISO-TP over the SocketCAN CAN_ISOTP protocol
+ * \details   Sends and receives segmented messages with the ISO-TP
+ *            implementation of the Linux kernel.
+ * \version   1.0
+ * \copyright Copyright (c) 2018, Daniel Tuchscherer.
+ *            All rights reserved.
+ *
+ *            Redistributions and use in source and binary forms, with
+ *            or without modifications, are permitted provided that the
+ *            following conditions are met: Redistributions of source code must
+ *            retain the above copyright notice, this list of conditions and the
+ *            following disclaimer.
+ *
+ *            Redistributions in binary form must reproduce the above copyright
+ *            notice, this list of conditions and the following disclaimer in
+ *            the documentation and/or other materials provided with the
+ *            distribution.
+ *
+ *            Neither the name of the Heilbronn University nor the name of its
+ *            contributors may be used to endorse or promote products derived
+ *            from this software without specific prior written permission.
+ *
+ *            THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS “AS IS”
+ *            AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ *            TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ *            PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE REGENTS
+ *            OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *            SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *            LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *            USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *            AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *            LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *            ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *            POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef ISOTPSOCKET_H_
+#define ISOTPSOCKET_H_
+#ifndef _WIN32
+
+#include "IsoTp.h"  // IsoTpConfig
+#include "Packet.h"
+#include "Socket.h"
+#include <cstring>
+#include <linux/can.h>
+#include <linux/can/isotp.h>
+#include <net/if.h>
+#include <unistd.h>
+#include <utility>
+
+/**
+ * \brief ISO-TP socket using the kernel implementation (CAN_ISOTP).
+ * \details The kernel does the segmentation, flow control and reassembly,
+ * thus user space is woken once per message instead of once per frame. The
+ * complete message is copied by the kernel directly from or into the
+ * caller's Packet. Use IsoTpTransport if the kernel has no CAN_ISOTP.
+ */
+class IsoTpSocket : public Socket< IsoTpSocket >
+{
+  public:
+    /**
+     * \brief Opens an ISO-TP socket on the interface.
+     * \param[in] interface_str interface name, e.g. "can0", "vcan0"
+     * \param[in] config identifiers, block size and STmin announced to the
+     * sender, and the padding of the frames sent.
+     */
+    template < std::size_t N >
+    IsoTpSocket(const char (&interface_str)[N],
+                const IsoTpConfig& config) noexcept
+        : Socket{}, isotp_init_{false}
+    {
+        if (is_socket_initialized())
+        {
+            const auto ifindex = if_nametoindex(interface_str);
+
+            if (ifindex != 0U)
+            {
+                isotp_init_ = configure(config) && bind_if_socket(ifindex,
+                                                                  config);
+            }
+            else
+            {
+                std::cerr << "CAN interface " << interface_str
+                          << " you've specified is not found!\n";
+            }
+        }
+    }
+
+    /**
+     * \brief Create the ISO-TP socket; this is called by the base class.
+     * \return true if the socket is opened or false if there was an error.
+     */
+    bool create() noexcept;
+
+    /**
+     * \brief Checks if the socket is bound and configured.
+     */
+    bool is_isotp_initialized() const noexcept { return isotp_init_; }
+
+    /**
+     * \brief Sends a message. Blocks until the kernel accepted it.
+     * \param[in] data the message.
+     * \param[in] len the length of the message.
+     * \return the number of bytes sent or -1 on error.
+     */
+    std::int32_t send(const void* data, const std::size_t len) noexcept;
+
+    /**
+     * \brief Sends the first len bytes of a packet as one message.
+     */
+    template < std::size_t Size >
+    std::int32_t send(const Packet< Size >& packet,
+                      const std::size_t len) noexcept
+    {
+        return send(packet.get_data().data(), (len < Size) ? len : Size);
+    }
+
+    /**
+     * \brief Receives one complete message directly into a packet
+     * (blocking read).
+     * \param[out] packet the packet to receive into.
+     * \return the length of the message or -1 on error. A message longer
+     * than the packet is truncated.
+     */
+    template < std::size_t Size >
+    std::int32_t receive(Packet< Size >& packet) noexcept
+    {
+        return receive(packet.get_data().data(), Size);
+    }
+
+    /**
+     * \brief Receives one complete message directly into a packet
+     * (non-blocking read / timeout / polling possible).
+     * \param[out] packet the packet to receive into.
+     * \param[in] deadline time to wait for the message to begin.
+     * \return the length of the message, zero on timeout or -1 on error.
+     */
+    template < std::size_t Size, typename Duration >
+    std::int32_t receive(Packet< Size >& packet,
+                         const Duration&& deadline) noexcept
+    {
+        std::int32_t received{-1};
+
+        if (is_isotp_initialized())
+        {
+            const bool event = wait_for(std::move(deadline));
+            received = event ? receive(packet) : 0;
+        }
+
+        return received;
+    }
+
+    /**
+     * \brief Receives one complete message into a buffer (blocking read).
+     * \param[out] data the buffer.
+     * \param[in] len the size of the buffer.
+     * \return the length of the message or -1 on error.
+     */
+    std::int32_t receive(void* data, const std::size_t len) noexcept;
+
+  private:
+    /**
+     * \brief Sets padding and flow control options; must be done before the
+     * socket is bound.
+     */
+    bool configure(const IsoTpConfig& config) noexcept;
+
+    /**
+     * \brief Binds the socket to the interface and the identifiers.
+     */
+    bool bind_if_socket(const unsigned int ifindex,
+                        const IsoTpConfig& config) noexcept;
+
+    /// the socket is bound and configured.
+    bool isotp_init_;
+};
+
+#endif // WIN32 detection
+#endif /* ISOTPSOCKET_H_ */
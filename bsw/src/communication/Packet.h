@@ -40,10 +40,143 @@
 #ifndef PACKET_H_
 #define PACKET_H_
 
-#include "Endianess.h" // converting to and from host-byte-order
+#include "Endianness.h" // converting to and from host-byte-order
 #include <array>
 #include <cstring>
 
+/**
+ * \brief A run of bytes inside a packet or view, returned by read_bytes()
+ * without copying. It stands in for std::string_view, which is C++17, and is
+ * valid as long as the memory of the packet is not modified.
+ */
+struct ByteSpan
+{
+    /// the first byte.
+    const std::uint8_t* data;
+    /// the number of bytes.
+    std::size_t size;
+
+    /**
+     * \brief The bytes as characters. They are not null-terminated.
+     */
+    const char* chars() const noexcept
+    {
+        return reinterpret_cast< const char* >(data);
+    }
+};
+
+/// Size of the length prefix of strings and byte runs in a packet.
+constexpr std::size_t BYTES_PREFIX_SIZE{sizeof(std::uint32_t)};
+
+/**
+ * \brief Length-prefixed fields: the length as 32 bit value in
+ * network-byte-order, followed by the bytes as they are. Packet and the
+ * packet views store their strings and byte runs with these functions.
+ */
+struct ByteField
+{
+    /**
+     * \brief Writes a field at the write position with one memcpy.
+     * \param[in] buffer the memory of the packet.
+     * \param[in] size the size of the packet.
+     * \param[in,out] write_pos the write position, advanced if stored.
+     * \param[in] data the bytes to store.
+     * \param[in] len the number of bytes.
+     * \return true if stored, false if nothing was written.
+     */
+    static bool append(std::uint8_t* buffer, const std::size_t size,
+                       std::uint32_t& write_pos, const void* data,
+                       const std::uint32_t len) noexcept
+    {
+        const bool appended = fits(size, write_pos, len);
+
+        if (appended == true)
+        {
+            const std::uint32_t prefix = to_network< std::uint32_t >(len);
+            std::memcpy(&buffer[write_pos], &prefix, BYTES_PREFIX_SIZE);
+
+            if (len > 0U)
+            {
+                std::memcpy(&buffer[write_pos + BYTES_PREFIX_SIZE], data, len);
+            }
+
+            write_pos += static_cast< std::uint32_t >(BYTES_PREFIX_SIZE + len);
+        }
+
+        return appended;
+    }
+
+    /**
+     * \brief Reads a field at the read position without copying.
+     * \param[in] buffer the memory of the packet.
+     * \param[in] size the size of the packet.
+     * \param[in,out] read_pos the read position, advanced if read.
+     * \param[out] span points into the buffer at the bytes read.
+     * \return true if read, false if the prefix or the bytes exceed the
+     * packet, then the read position is unchanged.
+     */
+    static bool read(const std::uint8_t* buffer, const std::size_t size,
+                     std::uint32_t& read_pos, ByteSpan& span) noexcept
+    {
+        bool read = false;
+
+        if (fits(size, read_pos, 0U) == true)
+        {
+            std::uint32_t len{0U};
+            std::memcpy(&len, &buffer[read_pos], BYTES_PREFIX_SIZE);
+            len = from_network< std::uint32_t >(len);
+
+            // the length comes off the wire, it is checked without a sum
+            // that may wrap around.
+            if (fits(size, read_pos, len) == true)
+            {
+                span = ByteSpan{&buffer[read_pos + BYTES_PREFIX_SIZE], len};
+                read_pos +=
+                    static_cast< std::uint32_t >(BYTES_PREFIX_SIZE + len);
+                read = true;
+            }
+        }
+
+        return read;
+    }
+
+    /**
+     * \brief Reads a field into a char buffer and terminates it.
+     * \param[in] capacity the size of the buffer including the terminator.
+     * \return true if read, false if the string does not fit into the buffer
+     * or exceeds the packet, then the read position is unchanged.
+     */
+    static bool read_string(const std::uint8_t* buffer, const std::size_t size,
+                            std::uint32_t& read_pos, char* str,
+                            const std::size_t capacity) noexcept
+    {
+        std::uint32_t pos = read_pos;
+        ByteSpan span{nullptr, 0U};
+        const bool read =
+            ByteField::read(buffer, size, pos, span) && (span.size < capacity);
+
+        if (read == true)
+        {
+            std::memcpy(str, span.data, span.size);
+            str[span.size] = '\0';
+            read_pos = pos;
+        }
+
+        return read;
+    }
+
+  private:
+    /**
+     * \brief If the prefix and len bytes fit behind the position.
+     */
+    static constexpr bool fits(const std::size_t size, const std::size_t pos,
+                               const std::size_t len) noexcept
+    {
+        return (pos <= size) && ((size - pos) >= BYTES_PREFIX_SIZE) &&
+               (len <= (size - pos - BYTES_PREFIX_SIZE));
+    }
+};
+
 /**
  * \brief Packet class for unified data (network) transport.
  * \tparam Size of the container
@@ -51,7 +184,10 @@
 template < std::size_t Size > class Packet
 {
   public:
-    using DataContainer = std::array< uint8, Size >;
+    using DataContainer = std::array< std::uint8_t, Size >;
+
+    /// the number of bytes of the packet, e.g. to check layouts against.
+    static constexpr std::size_t capacity = Size;
 
     /**
      * \brief Default constructor initializes the write and read position.
@@ -113,13 +249,13 @@ template < std::size_t Size > class Packet
         static_assert(std::is_arithmetic< T >::value,
                       "Type must be integral or floating point.");
         static_assert(
-            Position < Size,
+            (Position + sizeof(T)) <= Size,
             "The position to read is greater than the actual Packet size.");
         using MyType = T;
         MyType data{static_cast< MyType >(0)};
-        const MyType* data_ptr =
-            reinterpret_cast< const MyType* >(&m_data[Position]);
-        data = from_network< MyType >(*data_ptr);
+        // the position may be unaligned for T, thus copy it byte by byte.
+        std::memcpy(&data, &m_data[Position], sizeof(MyType));
+        data = from_network< MyType >(data);
         return data;
     }
 
@@ -133,7 +269,7 @@ template < std::size_t Size > class Packet
         static_assert(std::is_arithmetic< T >::value,
                       "Type must be integral or floating point.");
         static_assert(
-            Position < Size,
+            (Position + sizeof(T)) <= Size,
             "The position to write is greater than the actual Packet size.");
         using MyType = T;
         static constexpr auto bytes = sizeof(T);
@@ -179,7 +315,7 @@ template < std::size_t Size > class Packet
      */
     template < typename T > void append(const T& data) noexcept
     {
-        static constexpr uint8 bytes_to_write = sizeof(T);
+        static constexpr std::uint8_t bytes_to_write = sizeof(T);
 
         if (is_writable(bytes_to_write))
         {
@@ -192,22 +328,78 @@ template < std::size_t Size > class Packet
 
     /**
      * \brief Appends the container with a char array.
+     * \details The length is determined with strlen. Prefer append_string()
+     * for strings of known length.
      * \param[in] data the char array.
      */
     void append(const char* data) noexcept
     {
-        // determine the length of the char array
-        std::uint32_t bytes_to_write =
-            static_cast< std::uint32_t >(std::strlen(data));
+        append_bytes(data, static_cast< std::uint32_t >(std::strlen(data)));
+    }
 
-        // store the length first
-        *this << bytes_to_write;
+    /**
+     * \brief Appends a length-prefixed run of bytes, see ByteField.
+     * \param[in] data the bytes to store.
+     * \param[in] len the number of bytes.
+     * \return true if stored, false if the prefix and the bytes exceed the
+     * packet, then nothing is written.
+     */
+    bool append_bytes(const void* data, const std::uint32_t len) noexcept
+    {
+        return ByteField::append(m_data.data(), Size, m_write_pos, data, len);
+    }
 
-        if (is_writable(bytes_to_write))
-        {
-            std::memcpy(&m_data[m_write_pos], data, bytes_to_write);
-            m_write_pos += bytes_to_write;
-        }
+    /**
+     * \brief Appends a length-prefixed array of bytes of compile-time size.
+     */
+    template < std::size_t N >
+    bool append_bytes(const std::array< std::uint8_t, N >& data) noexcept
+    {
+        static_assert((BYTES_PREFIX_SIZE + N) <= Size,
+                      "The bytes exceed the Packet size.");
+        return append_bytes(data.data(), static_cast< std::uint32_t >(N));
+    }
+
+    /**
+     * \brief Appends a length-prefixed string of known length, e.g. of a
+     * std::string or a literal with sizeof(literal) - 1. The terminator is
+     * not stored.
+     */
+    bool append_string(const char* str, const std::uint32_t len) noexcept
+    {
+        return append_bytes(str, len);
+    }
+
+    /**
+     * \brief Reads a length-prefixed run of bytes without copying.
+     * \param[out] span points into the packet at the bytes read.
+     * \return true if read, false if the bytes exceed the packet, then the
+     * read position is unchanged.
+     */
+    bool read_bytes(ByteSpan& span) noexcept
+    {
+        return ByteField::read(m_data.data(), Size, m_read_pos, span);
+    }
+
+    /**
+     * \brief Reads a length-prefixed string into a buffer and terminates it.
+     * \param[out] str the buffer.
+     * \param[in] capacity the size of the buffer including the terminator.
+     * \return true if read, false if the string does not fit into the buffer
+     * or exceeds the packet, then the read position is unchanged.
+     */
+    bool read_string(char* str, const std::size_t capacity) noexcept
+    {
+        return ByteField::read_string(m_data.data(), Size, m_read_pos, str,
+                                      capacity);
+    }
+
+    /**
+     * \brief Reads a length-prefixed string into a char array.
+     */
+    template < std::size_t N > bool read_string(char (&str)[N]) noexcept
+    {
+        return read_string(&str[0], N);
     }
 
     /**
@@ -227,6 +419,78 @@ template < std::size_t Size > class Packet
         return skipped;
     }
 
+    /**
+     * \brief Appends an array of values in network byte order.
+     * \details The whole array is converted in one pass using the bulk
+     * conversion of Endianness.h instead of one shift operator per element.
+     * \param[in] values the values to store.
+     * \param[in] count the number of values.
+     * \return true if the array fit into the packet, false if nothing was
+     * written.
+     */
+    template < typename T >
+    bool append_array(const T* values, const std::size_t count) noexcept
+    {
+        bool appended = false;
+        const std::size_t bytes_to_write = count * sizeof(T);
+
+        // the count comes from the caller, the product must not wrap.
+        if ((count <= ((Size - m_write_pos) / sizeof(T))) &&
+            is_writable(bytes_to_write))
+        {
+            to_network(values, count, &m_data[m_write_pos]);
+            m_write_pos += bytes_to_write;
+            appended = true;
+        }
+
+        return appended;
+    }
+
+    /**
+     * \brief Appends a fixed size array of values in network byte order.
+     * \param[in] values the values to store.
+     * \return true if the array fit into the packet.
+     */
+    template < typename T, std::size_t N >
+    bool append_array(const std::array< T, N >& values) noexcept
+    {
+        return append_array(values.data(), N);
+    }
+
+    /**
+     * \brief Extracts an array of values to host byte order.
+     * \param[out] values where to store the values.
+     * \param[in] count the number of values to extract.
+     * \return true if enough data was available, false if nothing was read.
+     */
+    template < typename T >
+    bool read_array(T* values, const std::size_t count) noexcept
+    {
+        bool read = false;
+        const std::size_t bytes_to_read = count * sizeof(T);
+
+        if ((count <= ((Size - m_read_pos) / sizeof(T))) &&
+            is_readable(bytes_to_read))
+        {
+            from_network(&m_data[m_read_pos], count, values);
+            m_read_pos += bytes_to_read;
+            read = true;
+        }
+
+        return read;
+    }
+
+    /**
+     * \brief Extracts a fixed size array of values to host byte order.
+     * \param[out] values where to store the values.
+     * \return true if enough data was available.
+     */
+    template < typename T, std::size_t N >
+    bool read_array(std::array< T, N >& values) noexcept
+    {
+        return read_array(values.data(), N);
+    }
+
     /**
      * \brief Extract a bool from this packet to host byte order.
      * \param[out] data is a reference to a variable to store the extracted
@@ -235,7 +499,7 @@ template < std::size_t Size > class Packet
      */
     Packet& operator>>(bool& data) noexcept
     {
-        static constexpr uint8 bytes_to_read = sizeof(std::uint8_t);
+        static constexpr std::uint8_t bytes_to_read = sizeof(std::uint8_t);
         std::uint8_t bool_as_num = 0U;
         *this >> bool_as_num;
 
@@ -259,7 +523,7 @@ template < std::size_t Size > class Packet
      */
     Packet& operator>>(std::uint8_t& data) noexcept
     {
-        static constexpr uint8 bytes_to_read = sizeof(uint8);
+        static constexpr std::uint8_t bytes_to_read = sizeof(std::uint8_t);
 
         if (is_readable(bytes_to_read))
         {
@@ -324,7 +588,7 @@ template < std::size_t Size > class Packet
         {
             const std::int16_t* data_ptr =
                 reinterpret_cast< const std::int16_t* >(&m_data[m_read_pos]);
-            data = from_network< sint16 >(*data_ptr);
+            data = from_network< std::int16_t >(*data_ptr);
             m_read_pos += bytes_to_read;
         }
 
@@ -346,7 +610,7 @@ template < std::size_t Size > class Packet
         {
             const std::uint32_t* data_ptr =
                 reinterpret_cast< const std::uint32_t* >(&m_data[m_read_pos]);
-            data = from_network< uint32 >(*data_ptr);
+            data = from_network< std::uint32_t >(*data_ptr);
             m_read_pos += bytes_to_read;
         }
 
@@ -451,7 +715,7 @@ template < std::size_t Size > class Packet
         if (is_readable(bytes_to_read))
         {
             std::uint64_t f_as_num =
-                *(reinterpret_cast< uint64* >(&m_data[m_read_pos]));
+                *(reinterpret_cast< std::uint64_t* >(&m_data[m_read_pos]));
             // first swap the bytes and then convert into a floating point
             f_as_num = from_network< std::uint64_t >(f_as_num);
             std::memcpy(&data, &f_as_num, bytes_to_read);
@@ -467,16 +731,13 @@ template < std::size_t Size > class Packet
      */
     Packet& operator>>(char* data) noexcept
     {
-        uint32 bytes_to_read = 0U;
-        *this >> bytes_to_read;
+        ByteSpan span{nullptr, 0U};
 
-        if (is_readable(bytes_to_read))
+        if (read_bytes(span) == true)
         {
-            std::memcpy(data, &m_data[m_read_pos], bytes_to_read);
+            std::memcpy(data, span.data, span.size);
             // we need to add the char terminator
-            data[bytes_to_read] = '\0';
-            // update reading position
-            m_read_pos += bytes_to_read;
+            data[span.size] = '\0';
         }
 
         return *this;
@@ -658,6 +919,8 @@ template < std::size_t Size > class Packet
     std::uint32_t m_read_pos;
 };
 
+template < std::size_t Size > constexpr std::size_t Packet< Size >::capacity;
+
 /*******************************************************************************
  * EXPORTED VARIABLES
  *******************************************************************************/
@@ -0,0 +1,249 @@
+/**
+ * \file      PacketLayout.h
+ * \author    dtuchscherer <daniel.tuchscherer@gmail.com>
+ * \brief     Compile-time message layouts for Packet
+ * \details   A layout describes the position and type of every field of a
+ *            message. Encoding and decoding is resolved at compile-time.
+ * \copyright Copyright (c) 2018, dtuchscherer.
+ *            All rights reserved.
+ *
+ *            Redistributions and use in source and binary forms, with
+ *            or without modifications, are permitted provided that the
+ *            following conditions are met: Redistributions of source code must
+ *            retain the above copyright notice, this list of conditions and the
+ *            following disclaimer.
+ *
+ *            Redistributions in binary form must reproduce the above copyright
+ *            notice, this list of conditions and the following disclaimer in
+ *            the documentation and/or other materials provided with the
+ *            distribution.
+ *
+ *            Neither the name of the Heilbronn University nor the name of its
+ *            contributors may be used to endorse or promote products derived
+ *            from this software without specific prior written permission.
+ *
+ *            THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS “AS IS”
+ *            AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ *            TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ *            PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE REGENTS
+ *            OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *            SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *            LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *            USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *            AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *            LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *            ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *            POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PACKETLAYOUT_H_
+#define PACKETLAYOUT_H_
+
+#include "Packet.h"
+#include "PacketView.h"
+#include <tuple>
+#include <type_traits>
+
+/**
+ * \brief Describes one field of a message layout.
+ * \tparam T the type of the field. Must be integral or floating point.
+ * \tparam Position the byte position the field begins at in the packet.
+ */
+template < typename T, std::size_t Position > struct Field
+{
+    static_assert(std::is_arithmetic< T >::value,
+                  "Type must be integral or floating point.");
+
+    /// the type of the field's value
+    using Type = T;
+
+    /// first byte of the field
+    static constexpr std::size_t begin = Position;
+
+    /// one past the last byte of the field
+    static constexpr std::size_t end = Position + sizeof(T);
+};
+
+/**
+ * \brief Checks at compile-time that no two fields share a byte.
+ * \param[in] begin first byte of each field.
+ * \param[in] end one past the last byte of each field.
+ * \return true if all fields are disjoint, false if at least two overlap.
+ */
+template < std::size_t N >
+constexpr bool fields_disjoint(const std::size_t (&begin)[N],
+                               const std::size_t (&end)[N]) noexcept
+{
+    bool disjoint{true};
+
+    for (std::size_t i = 0U; i < N; ++i)
+    {
+        for (std::size_t j = i + 1U; j < N; ++j)
+        {
+            if ((begin[i] < end[j]) && (begin[j] < end[i]))
+            {
+                disjoint = false;
+            }
+        }
+    }
+
+    return disjoint;
+}
+
+/**
+ * \brief Determines the number of bytes a layout occupies.
+ * \param[in] end one past the last byte of each field.
+ * \return the greatest end of all fields.
+ */
+template < std::size_t N >
+constexpr std::size_t fields_end(const std::size_t (&end)[N]) noexcept
+{
+    std::size_t max_end{0U};
+
+    for (std::size_t i = 0U; i < N; ++i)
+    {
+        max_end = (end[i] > max_end) ? end[i] : max_end;
+    }
+
+    return max_end;
+}
+
+/**
+ * \brief A declarative, compile-time message layout for Packet.
+ * \details All positions are known at compile-time. Overlapping fields and
+ * fields exceeding the packet are rejected by static_assert, thus encoding
+ * and decoding a complete message is one unrolled sequence of stores and
+ * peeks without any runtime bounds check.
+ *
+ * \code
+ * using Telemetry = Layout< Field< std::uint16_t, 0 >, Field< float, 2 > >;
+ * Packet< 8 > packet;
+ * Telemetry::encode(packet, counter, speed);
+ * Telemetry::decode(packet, counter, speed);
+ * \endcode
+ *
+ * The members of a struct are encoded or decoded by passing them one by one
+ * or as a tuple, e.g. std::tie(msg.counter, msg.speed). Instead of a Packet
+ * a PacketView or ConstPacketView of a received buffer may be given, then
+ * nothing is copied besides the fields themselves:
+ *
+ * \code
+ * Telemetry::decode(ConstPacketView< 8 >{frame.data}, counter, speed);
+ * \endcode
+ * \tparam Fields the fields of the message.
+ */
+template < typename... Fields > class Layout
+{
+  public:
+    static_assert(sizeof...(Fields) > 0U,
+                  "A layout must contain at least one field.");
+
+    /// the values of all fields of the layout.
+    using Values = std::tuple< typename Fields::Type... >;
+
+    /// number of fields of the layout.
+    static constexpr std::size_t count = sizeof...(Fields);
+
+    /// number of bytes the layout occupies.
+    static constexpr std::size_t size = fields_end< count >({Fields::end...});
+
+    static_assert(fields_disjoint< count >({Fields::begin...},
+                                           {Fields::end...}),
+                  "The fields of the layout must not overlap.");
+
+    /**
+     * \brief Stores all values in network-byte-order at their positions.
+     * \param[out] packet the Packet or PacketView to store the message in.
+     * \param[in] values one value per field in the order of the fields.
+     */
+    template < typename Buffer >
+    static void encode(Buffer&& packet,
+                       const typename Fields::Type&... values) noexcept
+    {
+        static_assert(size <= std::decay_t< Buffer >::capacity,
+                      "The layout exceeds the Packet size.");
+        // expands into one store per field.
+        const int expand[] = {
+            0, (packet.template store< typename Fields::Type, Fields::begin >(
+                    values),
+                0)...};
+        static_cast< void >(expand);
+    }
+
+    /**
+     * \brief Stores all values of a tuple in network-byte-order.
+     * \param[out] packet the Packet or PacketView to store the message in.
+     * \param[in] values one value per field, e.g. from std::tie().
+     */
+    template < typename Buffer, typename... Ts >
+    static void encode(Buffer&& packet,
+                       const std::tuple< Ts... >& values) noexcept
+    {
+        static_assert(sizeof...(Ts) == count,
+                      "One value per field must be given.");
+        encode_tuple(packet, values, std::index_sequence_for< Ts... >{});
+    }
+
+    /**
+     * \brief Extracts all values to host-byte-order from their positions.
+     * \param[in] packet the Packet or a view to read the message from.
+     * \param[out] values one variable per field in the order of the fields.
+     */
+    template < typename Buffer >
+    static void decode(const Buffer& packet,
+                       typename Fields::Type&... values) noexcept
+    {
+        static_assert(size <= Buffer::capacity,
+                      "The layout exceeds the Packet size.");
+        // expands into one peek per field.
+        const int expand[] = {
+            0, (values = packet.template peek< typename Fields::Type,
+                                               Fields::begin >(),
+                0)...};
+        static_cast< void >(expand);
+    }
+
+    /**
+     * \brief Extracts all values into a tuple of references.
+     * \param[in] packet the Packet or a view to read the message from.
+     * \param[out] values one reference per field, e.g. from std::tie().
+     */
+    template < typename Buffer, typename... Ts >
+    static void decode(const Buffer& packet,
+                       std::tuple< Ts&... > values) noexcept
+    {
+        static_assert(sizeof...(Ts) == count,
+                      "One variable per field must be given.");
+        decode_tuple(packet, values, std::index_sequence_for< Ts... >{});
+    }
+
+    /**
+     * \brief Extracts all values of the message.
+     * \param[in] packet the Packet or a view to read the message from.
+     * \return the values in the order of the fields.
+     */
+    template < typename Buffer >
+    static Values decode(const Buffer& packet) noexcept
+    {
+        Values values;
+        decode_tuple(packet, values, std::index_sequence_for< Fields... >{});
+        return values;
+    }
+
+  private:
+    template < typename Buffer, typename Tuple, std::size_t... I >
+    static void encode_tuple(Buffer& packet, const Tuple& values,
+                             std::index_sequence< I... >) noexcept
+    {
+        encode(packet, std::get< I >(values)...);
+    }
+
+    template < typename Buffer, typename Tuple, std::size_t... I >
+    static void decode_tuple(const Buffer& packet, Tuple& values,
+                             std::index_sequence< I... >) noexcept
+    {
+        decode(packet, std::get< I >(values)...);
+    }
+};
+
+#endif /* PACKETLAYOUT_H_ */
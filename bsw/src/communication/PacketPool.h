@@ -0,0 +1,55 @@
+/**
+ * \file      PacketPool.h
+ * \author    dtuchscherer <daniel.tuchscherer@gmail.com>
+ * \brief     Preallocated packets for real-time tasks
+ * \details   Packets handed out by pointer from a lock-free ObjectPool, so they
+ *            are passed through queues without copying the data and never
+ *            page-fault or allocate within update().
+ * \copyright Copyright (c) 2018, dtuchscherer.
+ *            All rights reserved.
+ *
+ *            Redistributions and use in source and binary forms, with
+ *            or without modifications, are permitted provided that the
+ *            following conditions are met: Redistributions of source code must
+ *            retain the above copyright notice, this list of conditions and the
+ *            following disclaimer.
+ *
+ *            Redistributions in binary form must reproduce the above copyright
+ *            notice, this list of conditions and the following disclaimer in
+ *            the documentation and/or other materials provided with the
+ *            distribution.
+ *
+ *            Neither the name of the Heilbronn University nor the name of its
+ *            contributors may be used to endorse or promote products derived
+ *            from this software without specific prior written permission.
+ *
+ *            THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS “AS IS”
+ *            AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ *            TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ *            PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE REGENTS
+ *            OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *            SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *            LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *            USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *            AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *            LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *            ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *            POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PACKETPOOL_H_
+#define PACKETPOOL_H_
+
+#include "ObjectPool.h"
+#include "Packet.h"
+
+/**
+ * \brief Pool of Count packets of Size bytes each.
+ * \details acquire() returns a cleared Packet< Size >* or nullptr, release()
+ * returns it. The pointer is handed from thread to thread, e.g. by a
+ * SpscQueue< Packet< Size >*, N >, and released by the last user.
+ */
+template < std::size_t Size, std::size_t Count >
+using PacketPool = ObjectPool< Packet< Size >, Count >;
+
+#endif /* PACKETPOOL_H_ */
@@ -0,0 +1,418 @@
+/**
+ * \file      PacketView.h
+ * \author    dtuchscherer <daniel.tuchscherer@gmail.com>
+ * \brief     Non-owning packets over external buffers
+ * \details   The reading and writing API of Packet over memory owned by
+ *            the caller, e.g. a CAN frame, a ring slot or a mapped file.
+ * \copyright Copyright (c) 2018, dtuchscherer.
+ *            All rights reserved.
+ *
+ *            Redistributions and use in source and binary forms, with
+ *            or without modifications, are permitted provided that the
+ *            following conditions are met: Redistributions of source code must
+ *            retain the above copyright notice, this list of conditions and the
+ *            following disclaimer.
+ *
+ *            Redistributions in binary form must reproduce the above copyright
+ *            notice, this list of conditions and the following disclaimer in
+ *            the documentation and/or other materials provided with the
+ *            distribution.
+ *
+ *            Neither the name of the Heilbronn University nor the name of its
+ *            contributors may be used to endorse or promote products derived
+ *            from this software without specific prior written permission.
+ *
+ *            THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS “AS IS”
+ *            AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ *            TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ *            PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE REGENTS
+ *            OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *            SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *            LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *            USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *            AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *            LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *            ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *            POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PACKETVIEW_H_
+#define PACKETVIEW_H_
+
+#include "Packet.h"
+#include <array>
+#include <cstring>
+#include <type_traits>
+
+/**
+ * \brief A packet over a buffer owned by someone else.
+ * \details The view offers the same peek/store, stream operators and array
+ * functions as Packet, but reads and writes the caller's memory directly,
+ * e.g. the data of a received canfd_frame, a slot of a ring buffer or a
+ * mapped file. Nothing is copied on construction, the buffer must outlive
+ * the view. Use the aliases PacketView and ConstPacketView.
+ * \tparam Byte std::uint8_t for a mutable view, const std::uint8_t for a
+ * read-only view.
+ * \tparam Size the number of bytes viewed.
+ */
+template < typename Byte, std::size_t Size > class BasicPacketView
+{
+  public:
+    static_assert(std::is_same< std::uint8_t,
+                                typename std::remove_const< Byte >::type >::value,
+                  "A packet view is a view of bytes.");
+
+    /// the number of bytes of the view.
+    static constexpr std::size_t capacity = Size;
+
+    /**
+     * \brief Views Size bytes at the given address. The caller guarantees
+     * that the buffer is large enough.
+     * \param[in] data the first byte.
+     */
+    explicit BasicPacketView(Byte* data) noexcept
+        : m_data{data}, m_write_pos{0U}, m_read_pos{0U}
+    {
+        static_assert(Size > 0, "Size must be greater than zero!");
+    }
+
+    /**
+     * \brief Views a C array, e.g. canfd_frame::data.
+     */
+    template < std::size_t N >
+    explicit BasicPacketView(Byte (&data)[N]) noexcept
+        : BasicPacketView{&data[0]}
+    {
+        static_assert(N >= Size, "The array is smaller than the view.");
+    }
+
+    /**
+     * \brief Views a std::array.
+     */
+    template < std::size_t N >
+    explicit BasicPacketView(std::array< std::uint8_t, N >& data) noexcept
+        : BasicPacketView{data.data()}
+    {
+        static_assert(N >= Size, "The array is smaller than the view.");
+    }
+
+    template < std::size_t N >
+    explicit BasicPacketView(
+        const std::array< std::uint8_t, N >& data) noexcept
+        : BasicPacketView{data.data()}
+    {
+        static_assert(N >= Size, "The array is smaller than the view.");
+    }
+
+    /**
+     * \brief Views the data of a Packet.
+     */
+    template < std::size_t N >
+    explicit BasicPacketView(Packet< N >& packet) noexcept
+        : BasicPacketView{packet.get_data()}
+    {
+    }
+
+    template < std::size_t N >
+    explicit BasicPacketView(const Packet< N >& packet) noexcept
+        : BasicPacketView{packet.get_data()}
+    {
+    }
+
+    /**
+     * \brief A read-only view of a mutable view.
+     */
+    template < typename Other >
+    BasicPacketView(const BasicPacketView< Other, Size >& other) noexcept
+        : BasicPacketView{other.data()}
+    {
+    }
+
+    /**
+     * \brief returns the static size of the view.
+     */
+    constexpr std::uint16_t get_size() const noexcept
+    {
+        return static_cast< std::uint16_t >(Size);
+    }
+
+    /**
+     * \brief direct link to the data.
+     */
+    Byte* data() const noexcept { return m_data; }
+
+    /**
+     * \brief Clearing the indices for a new storage.
+     */
+    void clear() noexcept
+    {
+        m_write_pos = 0U;
+        m_read_pos = 0U;
+    }
+
+    /**
+     * \brief Returns a value from a given position without modifying the
+     * read position, as Packet::peek().
+     * \tparam T the value type to return
+     * \tparam Position the position at what the value begins.
+     */
+    template < typename T, std::size_t Position > T peek() const noexcept
+    {
+        static_assert(std::is_arithmetic< T >::value,
+                      "Type must be integral or floating point.");
+        static_assert(
+            (Position + sizeof(T)) <= Size,
+            "The position to read is greater than the actual view size.");
+        T data{static_cast< T >(0)};
+        // the position may be unaligned for T, thus copy it byte by byte.
+        std::memcpy(&data, &m_data[Position], sizeof(T));
+        return from_network< T >(data);
+    }
+
+    /**
+     * \brief Stores a value at the given position in network-byte-order, as
+     * Packet::store().
+     */
+    template < typename T, std::size_t Position >
+    void store(const T& data) noexcept
+    {
+        static_assert(std::is_arithmetic< T >::value,
+                      "Type must be integral or floating point.");
+        static_assert(
+            (Position + sizeof(T)) <= Size,
+            "The position to write is greater than the actual view size.");
+        static_assert(std::is_const< Byte >::value == false,
+                      "A ConstPacketView is read-only.");
+        const T network_data = to_network< T >(data);
+        std::memcpy(&m_data[Position], &network_data, sizeof(T));
+    }
+
+    /**
+     * \brief Checks if the length of bytes to write is possible.
+     */
+    bool is_writable(const std::size_t bytes_to_write) const noexcept
+    {
+        const auto write_pos_new = m_write_pos + bytes_to_write;
+        return (write_pos_new <= Size) && (bytes_to_write > 0);
+    }
+
+    /**
+     * \brief Checks if there are bytes left to read.
+     */
+    bool is_readable(const std::size_t bytes_to_read) const noexcept
+    {
+        const auto read_pos_new = m_read_pos + bytes_to_read;
+        return (read_pos_new <= Size) && (bytes_to_read > 0);
+    }
+
+    /**
+     * \brief Skipping the following bytes incrementing the read position.
+     * \param[in] bytes to skip
+     */
+    bool skip(const std::size_t bytes) noexcept
+    {
+        bool skipped = false;
+
+        if (is_readable(bytes) == true)
+        {
+            m_read_pos += bytes;
+            skipped = true;
+        }
+
+        return skipped;
+    }
+
+    /**
+     * \brief Appends an array of values in network byte order.
+     * \return true if the array fit into the view, false if nothing was
+     * written.
+     */
+    template < typename T >
+    bool append_array(const T* values, const std::size_t count) noexcept
+    {
+        static_assert(std::is_const< Byte >::value == false,
+                      "A ConstPacketView is read-only.");
+        bool appended = false;
+        const std::size_t bytes_to_write = count * sizeof(T);
+
+        // the count comes from the caller, the product must not wrap.
+        if ((count <= ((Size - m_write_pos) / sizeof(T))) &&
+            is_writable(bytes_to_write))
+        {
+            to_network(values, count, &m_data[m_write_pos]);
+            m_write_pos += bytes_to_write;
+            appended = true;
+        }
+
+        return appended;
+    }
+
+    template < typename T, std::size_t N >
+    bool append_array(const std::array< T, N >& values) noexcept
+    {
+        return append_array(values.data(), N);
+    }
+
+    /**
+     * \brief Extracts an array of values to host byte order.
+     * \return true if enough data was available, false if nothing was read.
+     */
+    template < typename T >
+    bool read_array(T* values, const std::size_t count) noexcept
+    {
+        bool read = false;
+        const std::size_t bytes_to_read = count * sizeof(T);
+
+        if ((count <= ((Size - m_read_pos) / sizeof(T))) &&
+            is_readable(bytes_to_read))
+        {
+            from_network(&m_data[m_read_pos], count, values);
+            m_read_pos += bytes_to_read;
+            read = true;
+        }
+
+        return read;
+    }
+
+    template < typename T, std::size_t N >
+    bool read_array(std::array< T, N >& values) noexcept
+    {
+        return read_array(values.data(), N);
+    }
+
+    /**
+     * \brief Appends a length-prefixed run of bytes, see ByteField.
+     * \return true if stored, false if nothing was written.
+     */
+    bool append_bytes(const void* data, const std::uint32_t len) noexcept
+    {
+        static_assert(std::is_const< Byte >::value == false,
+                      "A ConstPacketView is read-only.");
+        return ByteField::append(m_data, Size, m_write_pos, data, len);
+    }
+
+    template < std::size_t N >
+    bool append_bytes(const std::array< std::uint8_t, N >& data) noexcept
+    {
+        static_assert((BYTES_PREFIX_SIZE + N) <= Size,
+                      "The bytes exceed the view.");
+        return append_bytes(data.data(), static_cast< std::uint32_t >(N));
+    }
+
+    bool append_string(const char* str, const std::uint32_t len) noexcept
+    {
+        return append_bytes(str, len);
+    }
+
+    /**
+     * \brief Reads a length-prefixed run of bytes without copying, the span
+     * points into the viewed buffer.
+     * \return true if read, false if the read position is unchanged.
+     */
+    bool read_bytes(ByteSpan& span) noexcept
+    {
+        return ByteField::read(m_data, Size, m_read_pos, span);
+    }
+
+    /**
+     * \brief Reads a length-prefixed string into a buffer and terminates it.
+     * \return true if read, false if the string does not fit into the buffer
+     * or exceeds the view, then the read position is unchanged.
+     */
+    bool read_string(char* str, const std::size_t capacity) noexcept
+    {
+        return ByteField::read_string(m_data, Size, m_read_pos, str, capacity);
+    }
+
+    template < std::size_t N > bool read_string(char (&str)[N]) noexcept
+    {
+        return read_string(&str[0], N);
+    }
+
+    /**
+     * \brief Extract a value at the read position to host byte order. The
+     * value is left unchanged if the view is read completely.
+     * \param[out] data the variable to store the value in.
+     * \return the view.
+     */
+    template < typename T > BasicPacketView& operator>>(T& data) noexcept
+    {
+        static_assert(std::is_arithmetic< T >::value,
+                      "Type must be integral or floating point.");
+
+        if (is_readable(sizeof(T)))
+        {
+            T network_data;
+            std::memcpy(&network_data, &m_data[m_read_pos], sizeof(T));
+            data = from_network< T >(network_data);
+            m_read_pos += sizeof(T);
+        }
+
+        return *this;
+    }
+
+    /**
+     * \brief Extract a bool stored as one byte.
+     */
+    BasicPacketView& operator>>(bool& data) noexcept
+    {
+        std::uint8_t bool_as_num = 0U;
+        *this >> bool_as_num;
+        data = (bool_as_num != 0U);
+        return *this;
+    }
+
+    /**
+     * \brief Store a value at the write position in network byte order.
+     * \param[in] data the value to store.
+     * \return the view.
+     */
+    template < typename T > BasicPacketView& operator<<(const T& data) noexcept
+    {
+        static_assert(std::is_arithmetic< T >::value,
+                      "Type must be integral or floating point.");
+        static_assert(std::is_const< Byte >::value == false,
+                      "A ConstPacketView is read-only.");
+
+        if (is_writable(sizeof(T)))
+        {
+            const T network_data = to_network< T >(data);
+            std::memcpy(&m_data[m_write_pos], &network_data, sizeof(T));
+            m_write_pos += sizeof(T);
+        }
+
+        return *this;
+    }
+
+    /**
+     * \brief Store a bool as one byte.
+     */
+    BasicPacketView& operator<<(const bool& data) noexcept
+    {
+        const std::uint8_t bool_as_num = data ? 1U : 0U;
+        return *this << bool_as_num;
+    }
+
+  private:
+    /// the viewed bytes.
+    Byte* m_data;
+
+    /// Current position where data is appended.
+    std::uint32_t m_write_pos;
+
+    /// Current position where data is read from.
+    std::uint32_t m_read_pos;
+};
+
+template < typename Byte, std::size_t Size >
+constexpr std::size_t BasicPacketView< Byte, Size >::capacity;
+
+/// A view reading and writing the caller's buffer.
+template < std::size_t Size >
+using PacketView = BasicPacketView< std::uint8_t, Size >;
+
+/// A view reading the caller's buffer, e.g. a received frame.
+template < std::size_t Size >
+using ConstPacketView = BasicPacketView< const std::uint8_t, Size >;
+
+#endif /* PACKETVIEW_H_ */
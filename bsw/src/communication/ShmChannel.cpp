@@ -0,0 +1,172 @@
+/**
+ * \file      ShmChannel.cpp
+ * \author    dtuchscherer <daniel.tuchscherer@gmail.com>
+ * \brief     Shared-memory transport of packets on one host
+ * \details   These are the methods of class ShmRegion to map POSIX shared
+ *            memory and to wait for and wake up on futexes.
+ * \copyright Copyright (c) 2018, Daniel Tuchscherer.
+ *            All rights reserved.
+ *
+ *            Redistributions and use in source and binary forms, with
+ *            or without modifications, are permitted provided that the
+ *            following conditions are met: Redistributions of source code must
+ *            retain the above copyright notice, this list of conditions and the
+ *            following disclaimer.
+ *
+ *            Redistributions in binary form must reproduce the above copyright
+ *            notice, this list of conditions and the following disclaimer in
+ *            the documentation and/or other materials provided with the
+ *            distribution.
+ *
+ *            Neither the name of the Heilbronn University nor the name of its
+ *            contributors may be used to endorse or promote products derived
+ *            from this software without specific prior written permission.
+ *
+ *            THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS “AS IS”
+ *            AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ *            TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ *            PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE REGENTS
+ *            OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *            SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *            LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *            USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *            AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *            LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *            ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *            POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef _WIN32
+#error "Shared memory channels are implemented for Linux OS only."
+#endif
+#include "ShmChannel.h"
+#include <cerrno>
+#include <climits>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+constexpr std::uint64_t ShmChannelHeader::MAGIC;
+constexpr std::uint32_t ShmChannelHeader::VERSION;
+
+////////////////////////////////////////////////////////////////////////////////
+ShmRegion::ShmRegion() noexcept : map_{nullptr}, length_{0U}, last_error_{0} {}
+
+////////////////////////////////////////////////////////////////////////////////
+ShmRegion::~ShmRegion() noexcept { close(); }
+
+////////////////////////////////////////////////////////////////////////////////
+bool ShmRegion::create(const char* name, const std::size_t size) noexcept
+{
+    return map(name, O_RDWR | O_CREAT, size);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool ShmRegion::open(const char* name, const std::size_t size) noexcept
+{
+    // subscribers write the waiter count, thus read/write as well.
+    return map(name, O_RDWR, size);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool ShmRegion::map(const char* name, const int flags,
+                    const std::size_t size) noexcept
+{
+    bool mapped{false};
+    close();
+    const int fd = shm_open(name, flags | O_CLOEXEC, 0660);
+
+    if (fd >= 0)
+    {
+        struct stat info;
+        bool sized{false};
+
+        if (fstat(fd, &info) == 0)
+        {
+            if (static_cast< std::size_t >(info.st_size) == size)
+            {
+                sized = true;
+            }
+            else if ((flags & O_CREAT) != 0)
+            {
+                // the publisher sizes the object.
+                sized = (ftruncate(fd, static_cast< off_t >(size)) == 0);
+            }
+            else
+            {
+                // a subscriber of another layout.
+                errno = EINVAL;
+            }
+        }
+
+        if (sized)
+        {
+            void* map = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                             fd, 0);
+
+            if (map != MAP_FAILED)
+            {
+                map_ = map;
+                length_ = size;
+                mapped = true;
+            }
+        }
+
+        if (mapped == false)
+        {
+            last_error_ = errno;
+        }
+
+        // the mapping keeps the object referenced.
+        ::close(fd);
+    }
+    else
+    {
+        last_error_ = errno;
+    }
+
+    return mapped;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ShmRegion::close() noexcept
+{
+    if (map_ != nullptr)
+    {
+        munmap(map_, length_);
+        map_ = nullptr;
+        length_ = 0U;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool ShmRegion::remove(const char* name) noexcept
+{
+    return (shm_unlink(name) == 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool ShmRegion::wait(std::atomic< std::uint32_t >& word,
+                     const std::uint32_t expected,
+                     const std::int64_t timeout_ns) noexcept
+{
+    struct timespec timeout;
+    timeout.tv_sec = static_cast< time_t >(timeout_ns / 1000000000LL);
+    timeout.tv_nsec = static_cast< long >(timeout_ns % 1000000000LL);
+    // no FUTEX_PRIVATE_FLAG: the word is shared between processes.
+    const long result =
+        syscall(SYS_futex, reinterpret_cast< std::uint32_t* >(&word),
+                FUTEX_WAIT, expected, &timeout, nullptr, 0);
+    return (result == 0) || (errno != ETIMEDOUT);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ShmRegion::wake(std::atomic< std::uint32_t >& word) noexcept
+{
+    syscall(SYS_futex, reinterpret_cast< std::uint32_t* >(&word), FUTEX_WAKE,
+            INT_MAX, nullptr, nullptr, 0);
+}
@@ -0,0 +1,604 @@
+/**
+ * \file      ShmChannel.h
+ * \author    dtuchscherer <daniel.tuchscherer@gmail.com>
+ * \brief     Shared-memory transport of packets on one host
+ * \details   A POSIX shared memory ring of fixed-size slots, written by one
+ *            publisher and read by any number of subscribers.
+ * \copyright Copyright (c) 2018, Daniel Tuchscherer.
+ *            All rights reserved.
+ *
+ *            Redistributions and use in source and binary forms, with
+ *            or without modifications, are permitted provided that the
+ *            following conditions are met: Redistributions of source code must
+ *            retain the above copyright notice, this list of conditions and the
+ *            following disclaimer.
+ *
+ *            Redistributions in binary form must reproduce the above copyright
+ *            notice, this list of conditions and the following disclaimer in
+ *            the documentation and/or other materials provided with the
+ *            distribution.
+ *
+ *            Neither the name of the Heilbronn University nor the name of its
+ *            contributors may be used to endorse or promote products derived
+ *            from this software without specific prior written permission.
+ *
+ *            THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS “AS IS”
+ *            AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ *            TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ *            PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE REGENTS
+ *            OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *            SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *            LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *            USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *            AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *            LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *            ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *            POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SHMCHANNEL_H_
+#define SHMCHANNEL_H_
+#ifndef _WIN32
+
+#include "Packet.h"
+#include "SpscQueue.h" // cache line size
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <utility> // forwarding the deadline
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2,
+              "Atomics in shared memory must be lock-free.");
+
+/**
+ * \brief A mapping of a POSIX shared memory object (shm_open).
+ * \details This is the part of the channel depending on the OS, the layout
+ * of the memory is defined by ShmPublisher and ShmSubscriber.
+ */
+class ShmRegion
+{
+  public:
+    ShmRegion() noexcept;
+
+    /**
+     * \brief Unmaps the memory. The shared memory object is kept.
+     */
+    ~ShmRegion() noexcept;
+
+    ShmRegion(const ShmRegion&) = delete;
+    ShmRegion& operator=(const ShmRegion&) = delete;
+
+    /**
+     * \brief Opens or creates the object and maps it read/write.
+     * \param[in] name the name of the object, e.g. "/bsw_control". It is
+     * found in /dev/shm.
+     * \param[in] size the size of the object, it is resized if it differs.
+     * \return true if the memory is mapped, false if not.
+     */
+    bool create(const char* name, const std::size_t size) noexcept;
+
+    /**
+     * \brief Opens an existing object and maps it read/write.
+     * \param[in] name the name of the object.
+     * \param[in] size the size expected, the object must be of this size.
+     * \return true if the memory is mapped, false if not.
+     */
+    bool open(const char* name, const std::size_t size) noexcept;
+
+    /**
+     * \brief Unmaps the memory.
+     */
+    void close() noexcept;
+
+    /**
+     * \brief Removes the object. Mappings stay valid until they are closed.
+     * \param[in] name the name of the object.
+     * \return true if removed, false if not.
+     */
+    static bool remove(const char* name) noexcept;
+
+    /**
+     * \brief Sleeps as long as the word holds the expected value (futex).
+     * The word may be shared between processes.
+     * \param[in] word the word in shared memory.
+     * \param[in] expected the value to sleep on.
+     * \param[in] timeout_ns the maximum time to sleep.
+     * \return false if the timeout expired, true otherwise.
+     */
+    static bool wait(std::atomic< std::uint32_t >& word,
+                     const std::uint32_t expected,
+                     const std::int64_t timeout_ns) noexcept;
+
+    /**
+     * \brief Wakes up all processes sleeping on the word.
+     * \param[in] word the word in shared memory.
+     */
+    static void wake(std::atomic< std::uint32_t >& word) noexcept;
+
+    /**
+     * \brief The mapped memory, nullptr if not mapped.
+     */
+    void* data() const noexcept { return map_; }
+
+    /**
+     * \brief true if the memory is mapped.
+     */
+    bool is_open() const noexcept { return map_ != nullptr; }
+
+    /**
+     * \brief Gets the last error for error handling purposes.
+     */
+    int get_last_error() const noexcept { return last_error_; }
+
+  private:
+    /**
+     * \brief Maps the object opened with the given flags.
+     */
+    bool map(const char* name, const int flags,
+             const std::size_t size) noexcept;
+
+    /// the mapped memory.
+    void* map_;
+
+    /// the length of the mapping.
+    std::size_t length_;
+
+    /// errno of the last error.
+    int last_error_;
+};
+
+/**
+ * \brief The header at the start of the shared memory of a channel.
+ */
+struct ShmChannelHeader
+{
+    /// "BSWSHMCH", written last by the publisher once the ring is ready.
+    std::atomic< std::uint64_t > magic;
+    std::uint32_t version;
+    std::uint32_t slot_size;
+    std::uint32_t slot_count;
+    std::uint32_t reserved;
+
+    /// the sequence number of the next message written.
+    alignas(CACHE_LINE_SIZE) std::atomic< std::uint64_t > write_seq;
+
+    /// incremented on every message, the subscribers sleep on it.
+    alignas(CACHE_LINE_SIZE) std::atomic< std::uint32_t > notify;
+
+    /// number of subscribers sleeping, the publisher wakes them if not zero.
+    std::atomic< std::uint32_t > waiters;
+
+    static constexpr std::uint64_t MAGIC{0x4843484D48535742ULL}; // BSWSHMCH
+    static constexpr std::uint32_t VERSION{1U};
+
+    /**
+     * \brief Checks if the header describes a ring of the given layout.
+     */
+    bool matches(const std::size_t size, const std::size_t count) const
+        noexcept
+    {
+        return (magic.load(std::memory_order_acquire) == MAGIC) &&
+               (version == VERSION) && (slot_size == size) &&
+               (slot_count == count);
+    }
+};
+
+/**
+ * \brief The shared memory of a channel: the header and the slots.
+ * \details Every slot is a seqlock. A message with sequence number n is
+ * written into slot n % Count; while it is written the sequence of the slot
+ * is 2n + 1, afterwards 2n + 2. A reader copies the slot and checks that the
+ * sequence did not change meanwhile, otherwise the slot was overwritten.
+ * \tparam Size the maximum length of a message.
+ * \tparam Count the number of slots, a power of two.
+ */
+template < std::size_t Size, std::size_t Count > struct ShmRing
+{
+    struct alignas(CACHE_LINE_SIZE) Slot
+    {
+        std::atomic< std::uint64_t > seq;
+        std::uint16_t len;
+        std::array< std::uint8_t, Size > data;
+    };
+
+    ShmChannelHeader header;
+    std::array< Slot, Count > slots;
+
+    static constexpr std::size_t MASK{Count - 1U};
+
+    static_assert((Count > 0U) && ((Count & (Count - 1U)) == 0U),
+                  "The number of slots must be a power of two.");
+    static_assert(Size <= 0xFFFFU, "A message is at most 65535 bytes.");
+};
+
+/**
+ * \brief Writes messages into a shared memory channel. There must be only
+ * one publisher per channel.
+ * \details Sending never blocks and never waits for subscribers: a slow
+ * subscriber loses the oldest messages instead of stalling the publisher.
+ * A restarted publisher with the same layout continues the sequence.
+ * \tparam Size the maximum length of a message.
+ * \tparam Count the number of slots, a power of two.
+ */
+template < std::size_t Size, std::size_t Count > class ShmPublisher
+{
+  public:
+    /**
+     * \brief Creates the channel or opens it if it exists.
+     * \param[in] name the name of the channel, e.g. "/bsw_control".
+     */
+    explicit ShmPublisher(const char* name) noexcept : m_ring{nullptr}
+    {
+        if (m_region.create(name, sizeof(Ring)) == true)
+        {
+            m_ring = static_cast< Ring* >(m_region.data());
+
+            if (m_ring->header.matches(Size, Count) == false)
+            {
+                // a new channel or one of another layout: start over.
+                std::memset(m_region.data(), 0, sizeof(Ring));
+                m_ring = new (m_region.data()) Ring;
+                m_ring->header.version = ShmChannelHeader::VERSION;
+                m_ring->header.slot_size = Size;
+                m_ring->header.slot_count = Count;
+                m_ring->header.write_seq.store(0U, std::memory_order_relaxed);
+                m_ring->header.notify.store(0U, std::memory_order_relaxed);
+                m_ring->header.waiters.store(0U, std::memory_order_relaxed);
+
+                for (auto& slot : m_ring->slots)
+                {
+                    slot.seq.store(0U, std::memory_order_relaxed);
+                }
+
+                m_ring->header.magic.store(ShmChannelHeader::MAGIC,
+                                           std::memory_order_release);
+            }
+        }
+    }
+
+    ShmPublisher(const ShmPublisher&) = delete;
+    ShmPublisher& operator=(const ShmPublisher&) = delete;
+
+    /**
+     * \brief Writes a message and wakes up waiting subscribers.
+     * \param[in] message the data to send.
+     * \param[in] len the length of the message, at most Size.
+     * \return the number of bytes sent or -1 if the channel is not open or
+     * the message is too long.
+     */
+    std::int32_t send(const void* message, const std::uint16_t len) noexcept
+    {
+        std::int32_t data_sent{-1};
+
+        if ((m_ring != nullptr) && (len <= Size))
+        {
+            auto& header = m_ring->header;
+            const std::uint64_t seq =
+                header.write_seq.load(std::memory_order_relaxed);
+            auto& slot = m_ring->slots[seq & Ring::MASK];
+
+            // odd: readers of this slot retry or see it was overwritten.
+            slot.seq.store((2U * seq) + 1U, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            slot.len = len;
+            std::memcpy(slot.data.data(), message, len);
+            slot.seq.store((2U * seq) + 2U, std::memory_order_release);
+            header.write_seq.store(seq + 1U, std::memory_order_release);
+
+            header.notify.fetch_add(1U, std::memory_order_seq_cst);
+
+            if (header.waiters.load(std::memory_order_seq_cst) > 0U)
+            {
+                ShmRegion::wake(header.notify);
+            }
+
+            data_sent = static_cast< std::int32_t >(len);
+        }
+
+        return data_sent;
+    }
+
+    /**
+     * \brief Writes a packet as one message.
+     */
+    template < std::size_t PacketSize >
+    std::int32_t send(const Packet< PacketSize >& packet) noexcept
+    {
+        static_assert(PacketSize <= Size, "The packet exceeds the slot size.");
+        return send(packet.get_data().data(),
+                    static_cast< std::uint16_t >(PacketSize));
+    }
+
+    /**
+     * \brief The sequence number of the next message.
+     */
+    std::uint64_t sequence() const noexcept
+    {
+        return (m_ring != nullptr)
+                   ? m_ring->header.write_seq.load(std::memory_order_relaxed)
+                   : 0U;
+    }
+
+    /**
+     * \brief true if the channel is mapped.
+     */
+    bool is_open() const noexcept { return m_ring != nullptr; }
+
+    /**
+     * \brief Gets the last error for error handling purposes.
+     */
+    int get_last_error() const noexcept { return m_region.get_last_error(); }
+
+  private:
+    using Ring = ShmRing< Size, Count >;
+
+    /// the shared memory.
+    ShmRegion m_region;
+
+    /// the ring in the shared memory.
+    Ring* m_ring;
+};
+
+/**
+ * \brief Reads the messages of a shared memory channel. Any number of
+ * subscribers may read one channel, each at its own position.
+ * \details A subscriber starts with the next message sent after it opened
+ * the channel. If it falls behind by more than Count messages, the messages
+ * overwritten are counted in lost() and it continues with the oldest
+ * message still available.
+ * \tparam Size the maximum length of a message.
+ * \tparam Count the number of slots, a power of two.
+ */
+template < std::size_t Size, std::size_t Count > class ShmSubscriber
+{
+  public:
+    /**
+     * \brief Opens the channel if the publisher created it already.
+     * \param[in] name the name of the channel.
+     */
+    explicit ShmSubscriber(const char* name) noexcept
+        : m_ring{nullptr}, m_cursor{0U}, m_lost{0U}
+    {
+        open(name);
+    }
+
+    ShmSubscriber(const ShmSubscriber&) = delete;
+    ShmSubscriber& operator=(const ShmSubscriber&) = delete;
+
+    /**
+     * \brief Opens the channel, e.g. again if the publisher was not started
+     * when the subscriber was constructed.
+     * \param[in] name the name of the channel.
+     * \return true if the channel is open and of the expected layout.
+     */
+    bool open(const char* name) noexcept
+    {
+        m_region.close();
+        m_ring = nullptr;
+
+        if (m_region.open(name, sizeof(Ring)) == true)
+        {
+            auto* const ring = static_cast< Ring* >(m_region.data());
+
+            if (ring->header.matches(Size, Count) == true)
+            {
+                m_ring = ring;
+                m_cursor =
+                    ring->header.write_seq.load(std::memory_order_acquire);
+            }
+            else
+            {
+                m_region.close();
+            }
+        }
+
+        return (m_ring != nullptr);
+    }
+
+    /**
+     * \brief Takes the next message without blocking.
+     * \param[out] message the buffer to copy the message to.
+     * \param[in] len the size of the buffer. Longer messages are truncated.
+     * \return the number of bytes received, zero if there is no new message
+     * or -1 if the channel is not open.
+     */
+    std::int32_t receive(void* message, const std::uint16_t len) noexcept
+    {
+        std::int32_t data_received{-1};
+
+        if (m_ring != nullptr)
+        {
+            data_received = 0;
+            bool done{false};
+
+            while (done == false)
+            {
+                const auto& slot = m_ring->slots[m_cursor & Ring::MASK];
+                const std::uint64_t expected = (2U * m_cursor) + 2U;
+                const std::uint64_t before =
+                    slot.seq.load(std::memory_order_acquire);
+
+                if (before < expected)
+                {
+                    // not written yet or being written right now.
+                    done = true;
+                }
+                else if (before == expected)
+                {
+                    const std::uint16_t copied = std::min(slot.len, len);
+                    std::memcpy(message, slot.data.data(), copied);
+                    std::atomic_thread_fence(std::memory_order_acquire);
+
+                    if (slot.seq.load(std::memory_order_relaxed) == before)
+                    {
+                        ++m_cursor;
+                        data_received = static_cast< std::int32_t >(copied);
+                        done = true;
+                    }
+                    else
+                    {
+                        skip_overwritten();
+                    }
+                }
+                else
+                {
+                    skip_overwritten();
+                }
+            }
+        }
+
+        return data_received;
+    }
+
+    /**
+     * \brief Takes the next message into a packet without blocking.
+     */
+    template < std::size_t PacketSize >
+    std::int32_t receive(Packet< PacketSize >& packet) noexcept
+    {
+        return receive(packet.get_data().data(),
+                       static_cast< std::uint16_t >(PacketSize));
+    }
+
+    /**
+     * \brief Takes the next message and sleeps until one is sent if there is
+     * none.
+     * \param[out] message the buffer to copy the message to.
+     * \param[in] len the size of the buffer.
+     * \param[in] deadline the maximum time to wait.
+     * \return the number of bytes received, zero on timeout or -1 if the
+     * channel is not open.
+     */
+    template < typename Duration >
+    std::int32_t receive(void* message, const std::uint16_t len,
+                         const Duration&& deadline) noexcept
+    {
+        std::int32_t data_received = receive(message, len);
+
+        if ((data_received == 0) && (wait_for(std::move(deadline)) == true))
+        {
+            data_received = receive(message, len);
+        }
+
+        return data_received;
+    }
+
+    /**
+     * \brief Sleeps until a new message is available (futex).
+     * \param[in] deadline the maximum time to wait.
+     * \return true if a message is available, false on timeout.
+     */
+    template < typename Duration >
+    bool wait_for(const Duration&& deadline) noexcept
+    {
+        bool available{false};
+
+        if (m_ring != nullptr)
+        {
+            auto& header = m_ring->header;
+            const auto end = std::chrono::steady_clock::now() + deadline;
+            header.waiters.fetch_add(1U, std::memory_order_seq_cst);
+
+            while (available == false)
+            {
+                // read the word before the sequence, a message sent in
+                // between changes the word and the futex does not sleep.
+                const std::uint32_t word =
+                    header.notify.load(std::memory_order_seq_cst);
+                available = (pending() > 0U);
+                const auto left =
+                    std::chrono::duration_cast< std::chrono::nanoseconds >(
+                        end - std::chrono::steady_clock::now());
+
+                if ((available == true) || (left.count() <= 0))
+                {
+                    break;
+                }
+
+                ShmRegion::wait(header.notify, word, left.count());
+            }
+
+            header.waiters.fetch_sub(1U, std::memory_order_seq_cst);
+        }
+
+        return available;
+    }
+
+    /**
+     * \brief Number of messages sent and not yet received, more than Count
+     * if messages are lost already.
+     */
+    std::uint64_t pending() const noexcept
+    {
+        return (m_ring != nullptr)
+                   ? (m_ring->header.write_seq.load(std::memory_order_acquire) -
+                      m_cursor)
+                   : 0U;
+    }
+
+    /**
+     * \brief The sequence number of the next message received.
+     */
+    std::uint64_t sequence() const noexcept { return m_cursor; }
+
+    /**
+     * \brief Number of messages overwritten before they were received.
+     */
+    std::uint64_t lost() const noexcept { return m_lost; }
+
+    /**
+     * \brief true if the channel is mapped.
+     */
+    bool is_open() const noexcept { return m_ring != nullptr; }
+
+    /**
+     * \brief Gets the last error for error handling purposes.
+     */
+    int get_last_error() const noexcept { return m_region.get_last_error(); }
+
+  private:
+    using Ring = ShmRing< Size, Count >;
+
+    /**
+     * \brief Continues with the oldest message that is not overwritten yet.
+     */
+    void skip_overwritten() noexcept
+    {
+        const std::uint64_t written =
+            m_ring->header.write_seq.load(std::memory_order_acquire);
+        // leave the slot written next to the publisher.
+        const std::uint64_t oldest = written - Count + 1U;
+
+        if (oldest > m_cursor)
+        {
+            m_lost += oldest - m_cursor;
+            m_cursor = oldest;
+        }
+        else
+        {
+            // the publisher passed the slot while it was copied.
+            ++m_lost;
+            ++m_cursor;
+        }
+    }
+
+    /// the shared memory.
+    ShmRegion m_region;
+
+    /// the ring in the shared memory.
+    Ring* m_ring;
+
+    /// the sequence number of the next message to receive.
+    std::uint64_t m_cursor;
+
+    /// number of messages lost.
+    std::uint64_t m_lost;
+};
+
+#endif /* _WIN32 */
+#endif /* SHMCHANNEL_H_ */
@@ -46,8 +46,12 @@
 #include <winsock2.h>
 #elif defined(__unix__)
 #include <cerrno>
+#include <cstring>
 #include <fcntl.h>
+#include <linux/errqueue.h>   // struct scm_timestamping
+#include <linux/net_tstamp.h> // SOF_TIMESTAMPING flags
 #include <sys/socket.h>
+#include <time.h>
 #include <unistd.h>
 #else
 #error "OS not supported! Please define an operating system."
@@ -67,6 +71,25 @@ using SocketErrorType = int;
 #error "OS not supported!"
 #endif
 
+#ifdef __unix__
+/// Receive timestamp of a frame or segment, taken by the kernel or the
+/// network device. It's based on CLOCK_REALTIME (software) or the clock of
+/// the device (hardware).
+using RxTimestamp = struct timespec;
+
+/**
+ * \brief Who takes the receive timestamps.
+ */
+enum class TimestampSource
+{
+    /// the kernel when the frame is received by the driver (SO_TIMESTAMPNS).
+    SOFTWARE,
+    /// the network device, if it supports it; otherwise the kernel
+    /// (SO_TIMESTAMPING).
+    HARDWARE
+};
+#endif
+
 enum class SocketState : SocketHandleType
 {
     INVALID = -1
@@ -105,7 +128,10 @@ template < typename Derived > class Socket
      */
     ~Socket() noexcept
     {
-        close_socket();
+        if (is_socket_initialized() == true)
+        {
+            close_socket();
+        }
 #ifdef _WIN32
         // the WSA clean up is valid under windows only.
         WSACleanup();
@@ -155,6 +181,24 @@ template < typename Derived > class Socket
         return closed;
     }
 
+    /**
+     * \brief Closes the socket if it is open and creates a new one, e.g. to
+     * connect again after a connection attempt failed. Options set on the
+     * old socket are lost, the new socket is blocking.
+     * \return true if the new socket is open, false if not.
+     */
+    bool reopen() noexcept
+    {
+        if (is_socket_initialized() == true)
+        {
+            close_socket();
+        }
+
+        is_blocking_ = true;
+        socket_init_ = create();
+        return socket_init_;
+    }
+
     /**
      * \brief Gets the last error of the socket communication for
      * error handling purposes.
@@ -305,6 +349,55 @@ template < typename Derived > class Socket
         return success;
     }
 
+#ifdef __unix__
+    /**
+     * \brief Lets the kernel timestamp every received frame or segment. The
+     * timestamps are returned by the receive overloads taking an RxTimestamp,
+     * thus there is no need to read the clock after receiving.
+     * \param[in] source software or hardware timestamps. Hardware timestamps
+     * of Ethernet devices must be enabled for the device (SIOCSHWTSTAMP)
+     * in addition, most CAN devices deliver them by default.
+     * \return true if the timestamps are enabled, false if not.
+     */
+    bool enable_timestamps(
+        const TimestampSource source = TimestampSource::SOFTWARE) noexcept
+    {
+        bool enabled{false};
+        int option_set{-1};
+
+        if (source == TimestampSource::SOFTWARE)
+        {
+            const int flag{1};
+            option_set = setsockopt(socket_, SOL_SOCKET, SO_TIMESTAMPNS, &flag,
+                                    sizeof(flag));
+        }
+        else
+        {
+            const int flags =
+                SOF_TIMESTAMPING_RX_HARDWARE | SOF_TIMESTAMPING_RAW_HARDWARE |
+                SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+            option_set = setsockopt(socket_, SOL_SOCKET, SO_TIMESTAMPING,
+                                    &flags, sizeof(flags));
+        }
+
+        if (option_set >= 0)
+        {
+            enabled = true;
+        }
+        else
+        {
+            last_error_ = errno;
+            enabled = false;
+        }
+
+        return enabled;
+    }
+
+    /// Size of the control buffer to receive one timestamp with recvmsg().
+    static constexpr std::size_t TIMESTAMP_CONTROL_LEN{
+        CMSG_SPACE(sizeof(struct scm_timestamping))};
+#endif
+
     /**
      * \brief Check if this socket is blocking or non-blocking.
      * \return true if the socket is blocking or false if non-blocking.
@@ -364,6 +457,54 @@ template < typename Derived > class Socket
      */
     SocketHandleType get_socket_handle() const noexcept { return socket_; }
 
+#ifdef __unix__
+    /**
+     * \brief Takes the receive timestamp out of the control messages of a
+     * message received with recvmsg(). A hardware timestamp is preferred
+     * over a software timestamp.
+     * \param[in] msg the received message.
+     * \param[out] stamp the timestamp, zero if there is none.
+     * \return true if a timestamp was found, false if not.
+     */
+    static bool read_timestamp(const struct msghdr& msg,
+                               RxTimestamp& stamp) noexcept
+    {
+        bool found{false};
+        stamp.tv_sec = 0;
+        stamp.tv_nsec = 0;
+
+        // CMSG_NXTHDR takes a non-const header.
+        struct msghdr* header = const_cast< struct msghdr* >(&msg);
+
+        for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(header); cmsg != nullptr;
+             cmsg = CMSG_NXTHDR(header, cmsg))
+        {
+            if (cmsg->cmsg_level != SOL_SOCKET)
+            {
+                continue;
+            }
+
+            if (cmsg->cmsg_type == SCM_TIMESTAMPNS)
+            {
+                std::memcpy(&stamp, CMSG_DATA(cmsg), sizeof(stamp));
+                found = true;
+            }
+            else if (cmsg->cmsg_type == SCM_TIMESTAMPING)
+            {
+                struct scm_timestamping stamps;
+                std::memcpy(&stamps, CMSG_DATA(cmsg), sizeof(stamps));
+                // index 0 is the software, index 2 the hardware timestamp.
+                const bool hardware =
+                    (stamps.ts[2].tv_sec != 0) || (stamps.ts[2].tv_nsec != 0);
+                stamp = hardware ? stamps.ts[2] : stamps.ts[0];
+                found = true;
+            }
+        }
+
+        return found;
+    }
+#endif
+
     /**
      * \brief A socket will be opened. Because the parameters for opening a
      * socket heavily relies on the protocol this method calls a method
@@ -37,9 +37,23 @@
  */
 
 #include "TcpClient.h"
+#ifdef __unix__
+#include <algorithm>
+#include <poll.h>
+#endif
 
 ////////////////////////////////////////////////////////////////////////////////
+#ifdef __unix__
+TcpClient::TcpClient() noexcept
+    : TcpSocket(), m_server{}, m_has_server{false},
+      m_state{TcpConnectState::DISCONNECTED}, m_restore_blocking{true},
+      m_deadline{}, m_retry_at{}, m_reconnect{}, m_backoff{0}, m_attempts{0U},
+      m_keepalive{}, m_has_keepalive{false}
+{
+}
+#else
 TcpClient::TcpClient() noexcept : TcpSocket() {}
+#endif
 
 ////////////////////////////////////////////////////////////////////////////////
 TcpClient::~TcpClient() noexcept {}
@@ -67,6 +81,9 @@ bool TcpClient::connect(IpAddress ip_address, const std::uint16_t port) noexcept
         if (connected >= 0)
         {
             connected_r = true;
+#ifdef __unix__
+            m_state = TcpConnectState::CONNECTED;
+#endif
         }
         else
         {
@@ -83,4 +100,205 @@ bool TcpClient::connect(IpAddress ip_address, const std::uint16_t port) noexcept
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-bool TcpClient::disconnect() noexcept { return close_socket(); }
+bool TcpClient::disconnect() noexcept
+{
+#ifdef __unix__
+    m_state = TcpConnectState::DISCONNECTED;
+#endif
+    return close_socket();
+}
+
+#ifdef __unix__
+////////////////////////////////////////////////////////////////////////////////
+bool TcpClient::connect(IpAddress ip_address, const std::uint16_t port,
+                        const std::chrono::milliseconds timeout) noexcept
+{
+    TcpConnectState state = connect_async(ip_address, port, timeout);
+
+    while (state == TcpConnectState::CONNECTING)
+    {
+        const auto remaining =
+            std::chrono::duration_cast< std::chrono::milliseconds >(
+                m_deadline - Clock::now());
+        // round up, otherwise the last millisecond is busy polled.
+        const auto timeout_ms =
+            std::max(static_cast< int >(remaining.count()) + 1, 0);
+        state = check_connect(timeout_ms);
+    }
+
+    return (state == TcpConnectState::CONNECTED);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+TcpConnectState
+TcpClient::connect_async(IpAddress ip_address, const std::uint16_t port,
+                         const std::chrono::milliseconds timeout) noexcept
+{
+    ip_address.create_address_struct(ip_address.get_ip_address(), port,
+                                     m_server);
+    m_has_server = true;
+    m_reconnect.connect_timeout = timeout;
+    m_restore_blocking = is_blocking();
+    return start_connect();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+TcpConnectState TcpClient::poll_connect() noexcept
+{
+    return check_connect(0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void TcpClient::set_reconnect(IpAddress ip_address, const std::uint16_t port,
+                              const TcpReconnect& reconnect) noexcept
+{
+    ip_address.create_address_struct(ip_address.get_ip_address(), port,
+                                     m_server);
+    m_has_server = true;
+    m_reconnect = reconnect;
+    m_backoff = reconnect.initial_backoff;
+    m_restore_blocking = is_blocking();
+    m_retry_at = Clock::now();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+TcpConnectState TcpClient::maintain() noexcept
+{
+    if (m_state == TcpConnectState::CONNECTING)
+    {
+        check_connect(0);
+    }
+    else if ((m_state == TcpConnectState::DISCONNECTED) && m_has_server &&
+             (Clock::now() >= m_retry_at))
+    {
+        start_connect();
+    }
+
+    return m_state;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void TcpClient::connection_lost() noexcept
+{
+    // a connected socket can not connect again, take a new one.
+    recreate();
+    m_state = TcpConnectState::DISCONNECTED;
+    m_backoff = m_reconnect.initial_backoff;
+    m_retry_at = Clock::now();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool TcpClient::set_keepalive(const TcpKeepalive& keepalive) noexcept
+{
+    m_keepalive = keepalive;
+    m_has_keepalive = true;
+    return TcpSocket::set_keepalive(keepalive);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+TcpConnectState TcpClient::start_connect() noexcept
+{
+    if (is_socket_initialized() == false)
+    {
+        recreate();
+    }
+
+    ++m_attempts;
+
+    if (set_blocking(false) == true)
+    {
+        const auto connected =
+            ::connect(get_socket_handle(),
+                      reinterpret_cast< struct sockaddr* >(&m_server),
+                      sizeof(m_server));
+
+        if (connected >= 0)
+        {
+            // loopback connections may complete immediately.
+            set_blocking(m_restore_blocking);
+            m_state = TcpConnectState::CONNECTED;
+            m_attempts = 0U;
+            m_backoff = m_reconnect.initial_backoff;
+        }
+        else if (errno == EINPROGRESS)
+        {
+            m_state = TcpConnectState::CONNECTING;
+            m_deadline = Clock::now() + m_reconnect.connect_timeout;
+        }
+        else
+        {
+            connect_failed(errno);
+        }
+    }
+    else
+    {
+        connect_failed(get_last_error());
+    }
+
+    return m_state;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+TcpConnectState TcpClient::check_connect(const int timeout_ms) noexcept
+{
+    if (m_state == TcpConnectState::CONNECTING)
+    {
+        // the socket becomes writable once the handshake is done or failed.
+        struct pollfd writable;
+        writable.fd = get_socket_handle();
+        writable.events = POLLOUT;
+        writable.revents = 0;
+        const int ready = poll(&writable, 1U, timeout_ms);
+
+        if (ready > 0)
+        {
+            int error{0};
+            socklen_t len = sizeof(error);
+            const int result = getsockopt(get_socket_handle(), SOL_SOCKET,
+                                          SO_ERROR, &error, &len);
+
+            if ((result >= 0) && (error == 0))
+            {
+                set_blocking(m_restore_blocking);
+                m_state = TcpConnectState::CONNECTED;
+                m_attempts = 0U;
+                m_backoff = m_reconnect.initial_backoff;
+            }
+            else
+            {
+                connect_failed((result >= 0) ? error : errno);
+            }
+        }
+        else if ((ready < 0) && (errno != EINTR))
+        {
+            connect_failed(errno);
+        }
+        else if (Clock::now() >= m_deadline)
+        {
+            connect_failed(ETIMEDOUT);
+        }
+    }
+
+    return m_state;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void TcpClient::connect_failed(const SocketErrorType error) noexcept
+{
+    // the state of a socket after a failed connect is unspecified.
+    recreate();
+    SetErrorNumber(error);
+    m_state = TcpConnectState::DISCONNECTED;
+    m_retry_at = Clock::now() + m_backoff;
+    m_backoff = std::min(m_backoff * 2, m_reconnect.max_backoff);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void TcpClient::recreate() noexcept
+{
+    if ((reopen() == true) && (m_has_keepalive == true))
+    {
+        TcpSocket::set_keepalive(m_keepalive);
+    }
+}
+#endif
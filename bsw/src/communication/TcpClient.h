@@ -40,6 +40,37 @@
 
 #include "IpAddress.h"
 #include "TcpSocket.h"
+#include <chrono>
+#include <cstdint>
+
+/**
+ * \brief The state of a non-blocking connection to a server.
+ */
+enum class TcpConnectState : std::uint8_t
+{
+    DISCONNECTED, ///< no connection, waiting for the next attempt.
+    CONNECTING,   ///< the handshake is in progress.
+    CONNECTED     ///< the connection is established.
+};
+
+#ifdef __unix__
+/**
+ * \brief Timing of the reconnects of TcpClient::maintain().
+ * \details The first attempt after a lost connection is made right away. If
+ * an attempt fails, the next one is made after the backoff, which doubles
+ * with every failed attempt up to max_backoff and is reset as soon as a
+ * connection is established.
+ */
+struct TcpReconnect
+{
+    /// wait time after the first failed attempt.
+    std::chrono::milliseconds initial_backoff;
+    /// upper limit of the wait time.
+    std::chrono::milliseconds max_backoff;
+    /// an attempt fails if the handshake takes longer.
+    std::chrono::milliseconds connect_timeout;
+};
+#endif
 
 /**
  * \brief The TcpClient class allows connecting and disconnecting to a TCP/IP
@@ -69,11 +100,137 @@ class TcpClient : public TcpSocket
      */
     bool connect(IpAddress ip_address, const std::uint16_t port) noexcept;
 
+#ifdef __unix__
+    /**
+     * \brief Connect to a TCP/IP server without blocking longer than the
+     * timeout, e.g. if the server is down and does not reply at all.
+     * \param[in] ip_address the IP4 address
+     * \param[in] port the port we want to talk to
+     * \param[in] timeout the maximum time to wait for the handshake.
+     * \return true if connection is established, false if it fails or times
+     * out (ETIMEDOUT).
+     */
+    bool connect(IpAddress ip_address, const std::uint16_t port,
+                 const std::chrono::milliseconds timeout) noexcept;
+
+    /**
+     * \brief Starts a connection to a TCP/IP server and returns immediately.
+     * The blocking mode of the socket is restored once connected.
+     * \param[in] ip_address the IP4 address
+     * \param[in] port the port we want to talk to
+     * \param[in] timeout the maximum time of the handshake.
+     * \return CONNECTING while the handshake is in progress, CONNECTED if it
+     * completed immediately, DISCONNECTED if it failed.
+     */
+    TcpConnectState
+    connect_async(IpAddress ip_address, const std::uint16_t port,
+                  const std::chrono::milliseconds timeout) noexcept;
+
+    /**
+     * \brief Checks a connection started by connect_async() without blocking.
+     * \return the state of the connection.
+     */
+    TcpConnectState poll_connect() noexcept;
+
+    /**
+     * \brief Sets the server maintain() keeps connected to.
+     * \param[in] ip_address the IP4 address
+     * \param[in] port the port we want to talk to
+     * \param[in] reconnect the backoff and timeout of the attempts.
+     */
+    void set_reconnect(IpAddress ip_address, const std::uint16_t port,
+                       const TcpReconnect& reconnect) noexcept;
+
+    /**
+     * \brief Drives the connection without blocking. Call this cyclically,
+     * e.g. from RTTask::update(): it starts an attempt once the backoff has
+     * passed, checks a pending handshake and does nothing while connected.
+     * \return the state of the connection.
+     */
+    TcpConnectState maintain() noexcept;
+
+    /**
+     * \brief Reports a connection as broken, e.g. after send() or receive()
+     * failed or the peer closed it. The socket is recreated and maintain()
+     * connects again. The socket handle changes with every new socket.
+     */
+    void connection_lost() noexcept;
+
+    /**
+     * \brief The state of the connection.
+     */
+    TcpConnectState get_connect_state() const noexcept { return m_state; }
+
+    /**
+     * \brief Number of connection attempts made since the last connection.
+     */
+    std::uint32_t get_connect_attempts() const noexcept { return m_attempts; }
+
+    /**
+     * \brief Enables keepalive probes and the user timeout. The settings are
+     * applied again to every socket recreated for a reconnect.
+     * \param[in] keepalive the timing of the probes.
+     * \return true if all options are set, false if not.
+     */
+    bool set_keepalive(const TcpKeepalive& keepalive) noexcept;
+#endif
+
     /**
      * \brief explicitly close the socket for disconnection.
      * \return true if disconnecting was possible, false if not.
      */
     bool disconnect() noexcept;
+
+#ifdef __unix__
+  private:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * \brief Issues the non-blocking connect to the stored server.
+     */
+    TcpConnectState start_connect() noexcept;
+
+    /**
+     * \brief Waits up to the given time for the handshake to complete.
+     * \param[in] timeout_ms the time for poll(), 0 does not block.
+     */
+    TcpConnectState check_connect(const int timeout_ms) noexcept;
+
+    /**
+     * \brief Recreates the socket after a failed attempt and schedules the
+     * next one.
+     * \param[in] error the reason stored as last error.
+     */
+    void connect_failed(const SocketErrorType error) noexcept;
+
+    /**
+     * \brief Opens a new socket with the stored options.
+     */
+    void recreate() noexcept;
+
+    /// the server to connect to.
+    struct sockaddr_in m_server;
+    bool m_has_server;
+
+    /// the state of the connection.
+    TcpConnectState m_state;
+
+    /// the blocking mode to restore once connected.
+    bool m_restore_blocking;
+
+    /// end of the pending handshake and start of the next attempt.
+    Clock::time_point m_deadline;
+    Clock::time_point m_retry_at;
+
+    /// reconnect timing and the backoff of the next failed attempt.
+    TcpReconnect m_reconnect;
+    std::chrono::milliseconds m_backoff;
+    std::uint32_t m_attempts;
+
+    /// keepalive settings applied to every new socket.
+    TcpKeepalive m_keepalive;
+    bool m_has_keepalive;
+#endif
 };
 
 #endif /* TCPCLIENT_H_ */
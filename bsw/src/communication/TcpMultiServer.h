@@ -0,0 +1,391 @@
+/**
+ * \file      TcpMultiServer.h
+ * \author    dtuchscherer <daniel.tuchscherer@gmail.com>
+ * \brief     Ethernet TCP/IP Server for many connections
+ * \details   This TCP/IP Server keeps many connections alive in a fixed-
+ *            capacity slot array and accepts connections non-blocking.
+ * \copyright Copyright (c) 2018, dtuchscherer.
+ *            All rights reserved.
+ *
+ *            Redistributions and use in source and binary forms, with
+ *            or without modifications, are permitted provided that the
+ *            following conditions are met: Redistributions of source code must
+ *            retain the above copyright notice, this list of conditions and the
+ *            following disclaimer.
+ *
+ *            Redistributions in binary form must reproduce the above copyright
+ *            notice, this list of conditions and the following disclaimer in
+ *            the documentation and/or other materials provided with the
+ *            distribution.
+ *
+ *            Neither the name of the Heilbronn University nor the name of its
+ *            contributors may be used to endorse or promote products derived
+ *            from this software without specific prior written permission.
+ *
+ *            THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS “AS IS”
+ *            AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ *            TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ *            PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE REGENTS
+ *            OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *            SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *            LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *            USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *            AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *            LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *            ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *            POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef TCPMULTISERVER_H_
+#define TCPMULTISERVER_H_
+
+#include "EventLoop.h"
+#include "TcpServer.h"
+#include <array>
+
+/**
+ * \brief Default per-connection state: nothing is stored.
+ */
+struct TcpNoState
+{
+};
+
+/**
+ * \brief A TCP/IP server keeping many connections alive at the same time.
+ * \details The connections are held in a fixed-capacity slot array, thus no
+ * memory is allocated after construction. Pending connections are accepted
+ * non-blocking. The server may run stand-alone by calling accept_pending()
+ * or it is attached to an EventLoop, which accepts new connections and
+ * dispatches the data of all connections to one callback.
+ * To spread the accept load across worker threads create one server per
+ * thread and call reuse_port() before listen() on each of them.
+ * \tparam MaxConnections the maximum number of connections held.
+ * \tparam State application-specific state stored per connection.
+ * \tparam Loop the type of the event loop the server is attached to.
+ */
+template < std::size_t MaxConnections, typename State = TcpNoState,
+           typename Loop = EventLoop< MaxConnections + 1U > >
+class TcpMultiServer
+{
+  public:
+    /**
+     * \brief One connection with its socket and application state.
+     */
+    struct Connection
+    {
+        /// the data socket of the connection.
+        TcpSocket socket;
+
+        /// application-specific state of the connection.
+        State state;
+
+        /// the server holding this connection.
+        TcpMultiServer* server;
+    };
+
+    /**
+     * \brief Callback invoked when a connection is ready.
+     * \param[in] connection the connection ready to read or write.
+     * \param[in] events the epoll events that occurred, e.g. EPOLLIN.
+     * \param[in] context the user context given to attach().
+     */
+    using ConnectionCallback = void (*)(Connection& connection,
+                                        std::uint32_t events, void* context);
+
+    /**
+     * \brief Default constructor. Opens the listening socket only.
+     */
+    TcpMultiServer() noexcept
+        : m_server{}, m_connection_count{0U}, m_loop{nullptr},
+          m_callback{nullptr}, m_context{nullptr}
+    {
+        static_assert(MaxConnections > 0U,
+                      "The server must hold at least one connection.");
+        // the server accepts into the slots, not into the single data socket.
+        m_server.m_data.close_socket();
+
+        for (auto& connection : m_connections)
+        {
+            // slots are free as long as their socket is closed.
+            connection.socket.close_socket();
+            connection.server = this;
+        }
+    }
+
+    /**
+     * \brief Closes all connections. An attached loop must still exist,
+     * otherwise detach() the server before the loop is destroyed.
+     */
+    ~TcpMultiServer() noexcept
+    {
+        detach();
+
+        for (auto& connection : m_connections)
+        {
+            close(connection);
+        }
+    }
+
+    TcpMultiServer(const TcpMultiServer&) = delete;
+    TcpMultiServer& operator=(const TcpMultiServer&) = delete;
+
+    /**
+     * \brief Listens for connections in non-blocking mode.
+     * \param[in] ip the IP4 address to listen on for incoming requests.
+     * \param[in] port the port to listen on for incoming requests.
+     * \param[in] backlog the maximum number of pending connections.
+     * \return true if listening is possible, false if not.
+     */
+    bool listen(IpAddress ip, const std::uint16_t port,
+                const int backlog) noexcept
+    {
+        bool listening = m_server.listen(ip, port, backlog);
+
+        if (listening == true)
+        {
+            listening = m_server.m_connect.set_blocking(false);
+        }
+
+        return listening;
+    }
+
+    /**
+     * \brief Let's you restart the server without delay.
+     */
+    bool reuse_addr() noexcept { return m_server.reuse_addr(); }
+
+    /**
+     * \brief Lets several servers listen on the same port.
+     */
+    bool reuse_port() noexcept { return m_server.reuse_port(); }
+
+    /**
+     * \brief Accepts all pending connections into free slots. If all slots
+     * are occupied further connections are refused by closing them.
+     * \return the number of connections accepted or -1 on error.
+     */
+    std::int16_t accept_pending() noexcept
+    {
+        std::int16_t accepted{0};
+        bool pending{true};
+
+        while (pending == true)
+        {
+            const auto handle = m_server.m_connect.get_socket();
+            const int data_socket =
+                ::accept4(handle, nullptr, nullptr, SOCK_NONBLOCK);
+
+            if (data_socket >= 0)
+            {
+                Connection* connection = free_slot();
+
+                if ((connection != nullptr) && (take(*connection, data_socket)))
+                {
+                    ++accepted;
+                }
+                else
+                {
+                    // no slot left, refuse the connection.
+                    ::close(data_socket);
+                }
+            }
+            else
+            {
+                pending = false;
+
+                if ((errno != EAGAIN) && (errno != EWOULDBLOCK))
+                {
+                    m_server.m_connect.SetErrorNumber(errno);
+                    accepted = -1;
+                }
+            }
+        }
+
+        return accepted;
+    }
+
+    /**
+     * \brief Attaches the server to an event loop. New connections are
+     * accepted by the loop and every connection is watched for data. The
+     * loop must outlive the server or the server is detached first.
+     * \param[in] loop the event loop dispatching the events.
+     * \param[in] callback the function called if a connection is ready.
+     * \param[in] context the user context given to the callback.
+     * \return true if the listening socket is registered, false if not.
+     */
+    bool attach(Loop& loop, const ConnectionCallback callback,
+                void* context) noexcept
+    {
+        m_loop = &loop;
+        m_callback = callback;
+        m_context = context;
+        return loop.add(m_server.m_connect, &on_accept, this, EPOLLIN);
+    }
+
+    /**
+     * \brief Unregisters the listening socket and all connections from the
+     * event loop. The loop does not own the server, so this must be called
+     * if the loop is destroyed first.
+     */
+    void detach() noexcept
+    {
+        if (m_loop != nullptr)
+        {
+            m_loop->remove(m_server.m_connect);
+
+            for (auto& connection : m_connections)
+            {
+                if (connection.socket.is_socket_initialized() == true)
+                {
+                    m_loop->remove(connection.socket);
+                }
+            }
+
+            m_loop = nullptr;
+        }
+    }
+
+    /**
+     * \brief Closes one connection and frees its slot. Closing a free slot
+     * has no effect.
+     * \param[in] connection the connection to close.
+     */
+    void close(Connection& connection) noexcept
+    {
+        if (connection.socket.is_socket_initialized() == true)
+        {
+            if (m_loop != nullptr)
+            {
+                m_loop->remove(connection.socket);
+            }
+
+            connection.socket.close_socket();
+            connection.state = State{};
+            --m_connection_count;
+        }
+    }
+
+    /**
+     * \brief The number of connections currently established.
+     */
+    std::size_t connection_count() const noexcept
+    {
+        return m_connection_count;
+    }
+
+    /**
+     * \brief Access a slot, e.g. to send to all clients.
+     * \param[in] index the index of the slot.
+     * \return the connection of the slot.
+     */
+    Connection& connection(const std::size_t index) noexcept
+    {
+        return m_connections[index];
+    }
+
+    /**
+     * \brief If the slot holds an established connection.
+     * \param[in] index the index of the slot.
+     */
+    bool is_connected(const std::size_t index) noexcept
+    {
+        return m_connections[index].socket.is_socket_initialized();
+    }
+
+    /**
+     * \brief The maximum number of connections.
+     */
+    static constexpr std::size_t capacity() noexcept { return MaxConnections; }
+
+  private:
+    /**
+     * \brief Search for a slot that is not in use.
+     */
+    Connection* free_slot() noexcept
+    {
+        Connection* found{nullptr};
+
+        for (auto& connection : m_connections)
+        {
+            if (connection.socket.is_socket_initialized() == false)
+            {
+                found = &connection;
+                break;
+            }
+        }
+
+        return found;
+    }
+
+    /**
+     * \brief Assign an accepted socket to a slot and watch it.
+     */
+    bool take(Connection& connection, const int data_socket) noexcept
+    {
+        connection.socket.assign(data_socket);
+        connection.state = State{};
+        ++m_connection_count;
+        bool watched{true};
+
+        if (m_loop != nullptr)
+        {
+            // the loop switches the socket to non-blocking and records it.
+            watched = m_loop->add(connection.socket, &on_data, &connection,
+                                  EPOLLIN | EPOLLRDHUP);
+        }
+        else
+        {
+            // accepted with SOCK_NONBLOCK, assign() does not know the mode.
+            watched = connection.socket.set_blocking(false);
+        }
+
+        if (watched == false)
+        {
+            close(connection);
+        }
+
+        return watched;
+    }
+
+    /**
+     * \brief The listening socket is ready: accept all pending connections.
+     */
+    static void on_accept(std::uint32_t, void* context) noexcept
+    {
+        static_cast< TcpMultiServer* >(context)->accept_pending();
+    }
+
+    /**
+     * \brief A connection is ready: forward it to the user callback.
+     */
+    static void on_data(std::uint32_t events, void* context) noexcept
+    {
+        auto* connection = static_cast< Connection* >(context);
+        TcpMultiServer* server = connection->server;
+
+        if (server->m_callback != nullptr)
+        {
+            server->m_callback(*connection, events, server->m_context);
+        }
+    }
+
+    /// the listening socket.
+    TcpServer m_server;
+
+    /// the slots holding the connections.
+    std::array< Connection, MaxConnections > m_connections;
+
+    /// number of slots in use.
+    std::size_t m_connection_count;
+
+    /// the event loop the server is attached to or nullptr.
+    Loop* m_loop;
+
+    /// the function called if a connection is ready.
+    ConnectionCallback m_callback;
+
+    /// the user context given to the callback.
+    void* m_context;
+};
+
+#endif /* TCPMULTISERVER_H_ */
@@ -43,7 +43,8 @@
 TcpServer::TcpServer() noexcept : m_connect(), m_data() {}
 
 ////////////////////////////////////////////////////////////////////////////////
-bool TcpServer::listen(IpAddress ip_address, const std::uint16_t port) noexcept
+bool TcpServer::listen(IpAddress ip_address, const std::uint16_t port,
+                       const int backlog) noexcept
 {
     bool listen_success = false;
     // first build the address
@@ -56,7 +57,7 @@ bool TcpServer::listen(IpAddress ip_address, const std::uint16_t port) noexcept
     if (bound >= 0)
     {
         // make that socket a listening socket that listens on the port bound.
-        const int li = ::listen(handle, 10);
+        const int li = ::listen(handle, backlog);
         if (li >= 0)
         {
             listen_success = true;
@@ -131,3 +132,18 @@ bool TcpServer::reuse_addr() noexcept
                                   (char*)&reuse_addr, sizeof(reuse_addr));
     return static_cast< bool >(reuse == 0);
 }
+
+////////////////////////////////////////////////////////////////////////////////
+bool TcpServer::reuse_port() noexcept
+{
+#ifdef SO_REUSEPORT
+    int reuse_port = 1;
+    const auto handle = m_connect.get_socket();
+    const auto reuse = setsockopt(handle, SOL_SOCKET, SO_REUSEPORT,
+                                  (char*)&reuse_port, sizeof(reuse_port));
+    return static_cast< bool >(reuse == 0);
+#else
+    // the OS is not able to share a port between sockets.
+    return false;
+#endif
+}
@@ -58,10 +58,13 @@ class TcpServer
      * \brief Listens for connections.
      * \param[in] ip the IP4 address to listen on for incoming requests.
      * \param[in] port the port to listen on for incoming requests.
+     * \param[in] backlog the maximum number of pending connections that are
+     * not accepted yet.
      * \return true if listening is possible, false if listening is not
      * possible.
      */
-    bool listen(IpAddress ip, const std::uint16_t port) noexcept;
+    bool listen(IpAddress ip, const std::uint16_t port,
+                const int backlog = 10) noexcept;
 
     /**
      * \brief Accepts a connection.
@@ -78,6 +81,15 @@ class TcpServer
      */
     bool reuse_addr() noexcept;
 
+    /**
+     * \brief Reuse port lets several servers, e.g. one per worker thread,
+     * listen on the same port. The kernel then distributes incoming
+     * connections between them. Must be set before listen() on every server.
+     * \return true if setting the socket option was successful, false if
+     * setting the option was not successful.
+     */
+    bool reuse_port() noexcept;
+
     /// socket that accepts the connections from TCP clients.
     TcpSocket m_connect;
 
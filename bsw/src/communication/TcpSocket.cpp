@@ -37,6 +37,7 @@
  */
 
 #include "TcpSocket.h"
+#include "Trace.h"
 #include <netinet/tcp.h>
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -72,6 +73,7 @@ std::int16_t TcpSocket::send(const void* message,
 {
     const bool socket_open = is_socket_initialized();
     std::int16_t data_sent = -1;
+    BSW_TRACE_SCOPE("TcpSocket::send");
 
     // sending only makes sense if at least the socket is open.
     if (socket_open)
@@ -101,11 +103,82 @@ std::int16_t TcpSocket::send(const void* message,
     return data_sent;
 }
 
+#ifdef __unix__
+////////////////////////////////////////////////////////////////////////////////
+std::int32_t TcpSocket::send_vectored(const struct iovec* buffers,
+                                      const std::size_t count,
+                                      const bool more) noexcept
+{
+    std::int32_t data_sent = -1;
+
+    if (is_socket_initialized())
+    {
+        struct msghdr msg;
+        std::memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = const_cast< struct iovec* >(buffers);
+        msg.msg_iovlen = count;
+        const int flags = more ? (MSG_NOSIGNAL | MSG_MORE) : MSG_NOSIGNAL;
+        const SocketHandleType& handle = get_socket_handle();
+        data_sent = static_cast< std::int32_t >(::sendmsg(handle, &msg, flags));
+
+        if (data_sent < 0)
+        {
+            SetErrorNumber(errno);
+        }
+    }
+
+    return data_sent;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::int16_t TcpSocket::send_more(const void* message,
+                                  const std::uint16_t len) noexcept
+{
+    std::int16_t data_sent = -1;
+
+    if (is_socket_initialized())
+    {
+        const SocketHandleType& handle = get_socket_handle();
+        data_sent = ::send(handle, message, len, MSG_NOSIGNAL | MSG_MORE);
+
+        if (data_sent < 0)
+        {
+            SetErrorNumber(errno);
+        }
+    }
+
+    return data_sent;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool TcpSocket::set_cork(const bool option) noexcept
+{
+    bool success{false};
+    int flag = static_cast< int >(option);
+    const SocketHandleType handle = get_socket_handle();
+    const int result =
+        setsockopt(handle, IPPROTO_TCP, TCP_CORK, &flag, sizeof(int));
+
+    if (result >= 0)
+    {
+        success = true;
+    }
+    else
+    {
+        SetErrorNumber(errno);
+        success = false;
+    }
+
+    return success;
+}
+#endif
+
 ////////////////////////////////////////////////////////////////////////////////
 std::int16_t TcpSocket::receive(void* message, const std::uint16_t len) noexcept
 {
     const bool socket_open = is_socket_initialized();
     std::int16_t data_received = -1;
+    BSW_TRACE_SCOPE("TcpSocket::receive");
 
     // sending only makes sense if at least the socket is open.
     if (socket_open)
@@ -133,6 +206,43 @@ std::int16_t TcpSocket::receive(void* message, const std::uint16_t len) noexcept
     return data_received;
 }
 
+#ifdef __unix__
+////////////////////////////////////////////////////////////////////////////////
+std::int16_t TcpSocket::receive(void* message, const std::uint16_t len,
+                                RxTimestamp& stamp) noexcept
+{
+    std::int16_t data_received = -1;
+    BSW_TRACE_SCOPE("TcpSocket::receive");
+
+    if (is_socket_initialized())
+    {
+        std::array< std::uint8_t, TIMESTAMP_CONTROL_LEN > control;
+        struct iovec buffer;
+        buffer.iov_base = message;
+        buffer.iov_len = len;
+        struct msghdr msg;
+        std::memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &buffer;
+        msg.msg_iovlen = 1U;
+        msg.msg_control = control.data();
+        msg.msg_controllen = control.size();
+        const SocketHandleType& handle = get_socket_handle();
+        data_received = static_cast< std::int16_t >(::recvmsg(handle, &msg, 0));
+
+        if (data_received < 0)
+        {
+            SetErrorNumber(errno);
+        }
+        else
+        {
+            read_timestamp(msg, stamp);
+        }
+    }
+
+    return data_received;
+}
+#endif
+
 ////////////////////////////////////////////////////////////////////////////////
 bool TcpSocket::set_nodelay(const bool option) noexcept
 {
@@ -154,3 +264,40 @@ bool TcpSocket::set_nodelay(const bool option) noexcept
 
     return success;
 }
+
+#ifdef __unix__
+////////////////////////////////////////////////////////////////////////////////
+bool TcpSocket::set_keepalive(const TcpKeepalive& keepalive) noexcept
+{
+    const SocketHandleType handle = get_socket_handle();
+    const int enable{1};
+    const int idle = static_cast< int >(keepalive.idle.count());
+    const int interval = static_cast< int >(keepalive.interval.count());
+    const int probes = keepalive.probes;
+    const unsigned int user_timeout =
+        static_cast< unsigned int >(keepalive.user_timeout.count());
+
+    bool success =
+        (setsockopt(handle, SOL_SOCKET, SO_KEEPALIVE, &enable,
+                    sizeof(enable)) >= 0) &&
+        (setsockopt(handle, IPPROTO_TCP, TCP_KEEPIDLE, &idle, sizeof(idle)) >=
+         0) &&
+        (setsockopt(handle, IPPROTO_TCP, TCP_KEEPINTVL, &interval,
+                    sizeof(interval)) >= 0) &&
+        (setsockopt(handle, IPPROTO_TCP, TCP_KEEPCNT, &probes,
+                    sizeof(probes)) >= 0);
+
+    if (success && (user_timeout > 0U))
+    {
+        success = (setsockopt(handle, IPPROTO_TCP, TCP_USER_TIMEOUT,
+                              &user_timeout, sizeof(user_timeout)) >= 0);
+    }
+
+    if (success == false)
+    {
+        SetErrorNumber(errno);
+    }
+
+    return success;
+}
+#endif
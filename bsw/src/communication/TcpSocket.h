@@ -44,9 +44,30 @@
 #include <netdb.h>
 #include <netinet/in.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #endif
 
+#include "Packet.h"
 #include "Socket.h"
+#include <array>
+
+#ifdef __unix__
+/**
+ * \brief Settings of TcpSocket::set_keepalive() to detect a dead peer.
+ */
+struct TcpKeepalive
+{
+    /// idle time of the connection before the first probe is sent.
+    std::chrono::seconds idle;
+    /// time between two probes.
+    std::chrono::seconds interval;
+    /// number of unanswered probes until the connection is dropped.
+    int probes;
+    /// maximum time sent data may stay unacknowledged before the connection
+    /// is dropped (TCP_USER_TIMEOUT), zero keeps the default of the kernel.
+    std::chrono::milliseconds user_timeout;
+};
+#endif
 
 /**
  * \brief Concrete class for a Ethernet TCP/IP communication.
@@ -73,6 +94,75 @@ class TcpSocket : public Socket< TcpSocket >
      */
     std::int16_t send(const void* message, const std::uint16_t len) noexcept;
 
+#ifdef __unix__
+    /**
+     * \brief Send several buffers as one message with one system call
+     * (scatter/gather) without copying them together first.
+     * \param[in] buffers the buffers to send in the given order.
+     * \param[in] count the number of buffers.
+     * \param[in] more true if more data follows immediately (MSG_MORE). The
+     * kernel then holds back the data until a send without this flag, thus
+     * a message sent by several calls still goes out in one segment.
+     * \return the number of bytes that have been sent or -1 if there is an
+     * error.
+     */
+    std::int32_t send_vectored(const struct iovec* buffers,
+                               const std::size_t count,
+                               const bool more = false) noexcept;
+
+    /**
+     * \brief Send several complete packets, e.g. a header and a payload, as
+     * one message with one system call.
+     * \param[in] packets the packets to send in the given order.
+     * \return the number of bytes that have been sent or -1 if there is an
+     * error.
+     */
+    template < std::size_t... Sizes >
+    std::int32_t send_packets(const Packet< Sizes >&... packets) noexcept
+    {
+        const std::array< struct iovec, sizeof...(Sizes) > buffers{
+            {make_buffer(packets.get_data().data(), Sizes)...}};
+        return send_vectored(buffers.data(), buffers.size());
+    }
+
+    /**
+     * \brief Send via the TCP/IP socket and tell the kernel more data
+     * follows (MSG_MORE). The data is sent together with the next send
+     * without this flag.
+     * \param[in] message is the data to send
+     * \param[in] len is the length to send
+     * \return the number of bytes that have been sent or -1 if there is an
+     * error.
+     */
+    std::int16_t send_more(const void* message,
+                           const std::uint16_t len) noexcept;
+
+    /**
+     * \brief Corks the socket (TCP_CORK): partial segments are held back
+     * until the cork is removed (or 200 ms passed), thus several sends go
+     * out in as few segments as possible. Takes precedence over nodelay.
+     * \param[in] option true to cork, false to send all pending data.
+     * \return true if setting the option was successful or not.
+     */
+    bool set_cork(const bool option) noexcept;
+
+    /**
+     * \brief Describes a buffer to send with send_vectored().
+     * \param[in] data the beginning of the buffer.
+     * \param[in] len the number of bytes to send.
+     * \return the io vector.
+     */
+    static struct iovec make_buffer(const void* data,
+                                    const std::size_t len) noexcept
+    {
+        struct iovec buffer;
+        // the kernel does not modify the buffer on send.
+        buffer.iov_base = const_cast< void* >(data);
+        buffer.iov_len = len;
+        return buffer;
+    }
+#endif
+
     /**
      * \brief Receive via the TCP/IP socket
      * \param[out] is the message container to store the received data
@@ -82,6 +172,22 @@ class TcpSocket : public Socket< TcpSocket >
      */
     std::int16_t receive(void* message, const std::uint16_t len) noexcept;
 
+#ifdef __unix__
+    /**
+     * \brief Receive via the TCP/IP socket together with the time the kernel
+     * received the data. If the data of several segments is returned, it's
+     * the timestamp of the last segment.
+     * \param[out] is the message container to store the received data
+     * \param[in] the length to receive
+     * \param[out] stamp receive timestamp, zero if enable_timestamps() was
+     * not called.
+     * \return how much data has been received. if there is an error the return
+     * is smaller than 0.
+     */
+    std::int16_t receive(void* message, const std::uint16_t len,
+                         RxTimestamp& stamp) noexcept;
+#endif
+
     /**
      * \brief Create a TCP socket; This method is called by the base class.
      * \return true if the socket is created or false if there was an error when
@@ -99,6 +205,18 @@ class TcpSocket : public Socket< TcpSocket >
      * successful or not.
      */
     bool set_nodelay(const bool option) noexcept;
+
+#ifdef __unix__
+    /**
+     * \brief Enables TCP keepalive probes (SO_KEEPALIVE) and the user
+     * timeout. Without them a dead peer is detected after the kernel gave up
+     * retransmitting, which takes about 15 minutes, or never on an idle
+     * connection. A dead connection fails the next send or receive.
+     * \param[in] keepalive the timing of the probes.
+     * \return true if all options are set, false if not.
+     */
+    bool set_keepalive(const TcpKeepalive& keepalive) noexcept;
+#endif
 };
 
 #endif /* TCPSOCKET_H_ */
@@ -0,0 +1,271 @@
+/**
+ * \file      UdpSocket.cpp
+ * \author    dtuchscherer <daniel.tuchscherer@gmail.com>
+ * \brief     Ethernet UDP/IP communication and multicast
+ * \details
+ * \version   1.0
+ * \copyright Copyright (c) 2015, dtuchscherer.
+ *            All rights reserved.
+ *
+ *            Redistributions and use in source and binary forms, with
+ *            or without modifications, are permitted provided that the
+ *            following conditions are met: Redistributions of source code must
+ *            retain the above copyright notice, this list of conditions and the
+ *            following disclaimer.
+ *
+ *            Redistributions in binary form must reproduce the above copyright
+ *            notice, this list of conditions and the following disclaimer in
+ *            the documentation and/or other materials provided with the
+ *            distribution.
+ *
+ *            Neither the name of the Heilbronn University nor the name of its
+ *            contributors may be used to endorse or promote products derived
+ *            from this software without specific prior written permission.
+ *
+ *            THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS “AS IS”
+ *            AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ *            TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ *            PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE REGENTS
+ *            OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *            SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *            LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *            USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *            AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *            LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *            ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *            POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef _WIN32
+#error "UdpSocket is implemented for Linux OS only."
+#endif
+#include "UdpSocket.h"
+#include "Trace.h"
+
+////////////////////////////////////////////////////////////////////////////////
+UdpSocket::UdpSocket() noexcept
+    : Socket{}, m_destination{}, m_has_destination{false}
+{
+    // call the base class opening the socket.
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool UdpSocket::create() noexcept
+{
+    bool socket_created = false;
+    socket_ = socket(AF_INET, SOCK_DGRAM, 0);
+
+    // check here if the socket was opened.
+    if (get_socket_handle() > 0)
+    {
+        socket_created = true;
+    }
+    else
+    {
+        last_error_ = errno;
+        socket_created = false;
+    }
+
+    return socket_created;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool UdpSocket::bind(IpAddress ip_address, const std::uint16_t port) noexcept
+{
+    bool bound_r = false;
+    struct sockaddr_in local;
+    ip_address.create_address_struct(ip_address.get_ip_address(), port, local);
+    const int bound = ::bind(get_socket_handle(),
+                             reinterpret_cast< struct sockaddr* >(&local),
+                             sizeof(local));
+
+    if (bound >= 0)
+    {
+        bound_r = true;
+    }
+    else
+    {
+        SetErrorNumber(errno);
+        bound_r = false;
+    }
+
+    return bound_r;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool UdpSocket::reuse_addr() noexcept
+{
+    return set_option(SOL_SOCKET, SO_REUSEADDR, 1);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void UdpSocket::set_destination(IpAddress ip_address,
+                                const std::uint16_t port) noexcept
+{
+    ip_address.create_address_struct(ip_address.get_ip_address(), port,
+                                     m_destination);
+    m_has_destination = true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::int32_t UdpSocket::send(const void* message,
+                             const std::uint16_t len) noexcept
+{
+    std::int32_t data_sent = -1;
+    BSW_TRACE_SCOPE("UdpSocket::send");
+
+    if ((is_socket_initialized() == true) && (m_has_destination == true))
+    {
+        data_sent = static_cast< std::int32_t >(
+            ::sendto(get_socket_handle(), message, len, 0,
+                     reinterpret_cast< struct sockaddr* >(&m_destination),
+                     sizeof(m_destination)));
+
+        if (data_sent < 0)
+        {
+            SetErrorNumber(errno);
+        }
+    }
+
+    return data_sent;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::int32_t UdpSocket::receive(void* message, const std::uint16_t len) noexcept
+{
+    std::int32_t data_received = -1;
+    BSW_TRACE_SCOPE("UdpSocket::receive");
+
+    if (is_socket_initialized() == true)
+    {
+        data_received = static_cast< std::int32_t >(
+            ::recv(get_socket_handle(), message, len, 0));
+
+        if (data_received < 0)
+        {
+            SetErrorNumber(errno);
+        }
+    }
+
+    return data_received;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool UdpSocket::join_group(IpAddress group, IpAddress interface) noexcept
+{
+    return membership(IP_ADD_MEMBERSHIP, group, interface);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool UdpSocket::leave_group(IpAddress group, IpAddress interface) noexcept
+{
+    return membership(IP_DROP_MEMBERSHIP, group, interface);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool UdpSocket::set_multicast_ttl(const std::uint8_t ttl) noexcept
+{
+    return set_option(IPPROTO_IP, IP_MULTICAST_TTL, ttl);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool UdpSocket::set_multicast_loop(const bool loop) noexcept
+{
+    return set_option(IPPROTO_IP, IP_MULTICAST_LOOP, loop ? 1 : 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool UdpSocket::set_multicast_interface(IpAddress interface) noexcept
+{
+    bool success = false;
+    struct in_addr address;
+    address.s_addr = htonl(interface.get_ip_address());
+    const int result = setsockopt(get_socket_handle(), IPPROTO_IP,
+                                  IP_MULTICAST_IF, &address, sizeof(address));
+
+    if (result >= 0)
+    {
+        success = true;
+    }
+    else
+    {
+        SetErrorNumber(errno);
+        success = false;
+    }
+
+    return success;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool UdpSocket::set_send_buffer(const int bytes) noexcept
+{
+    return set_option(SOL_SOCKET, SO_SNDBUF, bytes);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool UdpSocket::set_receive_buffer(const int bytes) noexcept
+{
+    return set_option(SOL_SOCKET, SO_RCVBUF, bytes);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int UdpSocket::get_receive_buffer() noexcept
+{
+    int bytes{-1};
+    socklen_t len = sizeof(bytes);
+    const int result =
+        getsockopt(get_socket_handle(), SOL_SOCKET, SO_RCVBUF, &bytes, &len);
+
+    if (result < 0)
+    {
+        SetErrorNumber(errno);
+        bytes = -1;
+    }
+
+    return bytes;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool UdpSocket::set_option(const int level, const int name,
+                           const int value) noexcept
+{
+    bool success = false;
+    const int result =
+        setsockopt(get_socket_handle(), level, name, &value, sizeof(value));
+
+    if (result >= 0)
+    {
+        success = true;
+    }
+    else
+    {
+        SetErrorNumber(errno);
+        success = false;
+    }
+
+    return success;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool UdpSocket::membership(const int option, IpAddress& group,
+                           IpAddress& interface) noexcept
+{
+    bool success = false;
+    struct ip_mreq request;
+    request.imr_multiaddr.s_addr = htonl(group.get_ip_address());
+    request.imr_interface.s_addr = htonl(interface.get_ip_address());
+    const int result = setsockopt(get_socket_handle(), IPPROTO_IP, option,
+                                  &request, sizeof(request));
+
+    if (result >= 0)
+    {
+        success = true;
+    }
+    else
+    {
+        SetErrorNumber(errno);
+        success = false;
+    }
+
+    return success;
+}
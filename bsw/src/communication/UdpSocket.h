@@ -0,0 +1,564 @@
+/**
+ * \file      UdpSocket.h
+ * \author    dtuchscherer <daniel.tuchscherer@hs-heilbronn.de>
+ * \brief     UDP socket with multicast and batched datagrams.
+ * \details   UDP socket with multicast and batched datagrams.
+ * \copyright Copyright (c) 2015, dtuchscherer.
+ *            All rights reserved.
+ *
+ *            Redistributions and use in source and binary forms, with
+ *            or without modifications, are permitted provided that the
+ *            following conditions are met: Redistributions of source code must
+ *            retain the above copyright notice, this list of conditions and the
+ *            following disclaimer.
+ *
+ *            Redistributions in binary form must reproduce the above copyright
+ *            notice, this list of conditions and the following disclaimer in
+ *            the documentation and/or other materials provided with the
+ *            distribution.
+ *
+ *            Neither the name of the Heilbronn University nor the name of its
+ *            contributors may be used to endorse or promote products derived
+ *            from this software without specific prior written permission.
+ *
+ *            THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS “AS IS”
+ *            AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ *            TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ *            PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE REGENTS
+ *            OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *            SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *            LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *            USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *            AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *            LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *            ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *            POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef UDPSOCKET_H_
+#define UDPSOCKET_H_
+#ifndef _WIN32
+
+#include "IpAddress.h"
+#include "Packet.h"
+#include "Socket.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+/// Maximum payload of an IPv4 UDP datagram in bytes.
+constexpr std::size_t UDP_MAX_PAYLOAD{65507U};
+
+/**
+ * \brief A statically sized queue of datagrams that are transmitted together
+ * with one system call by UdpSocket::send_batch().
+ * \details Same as CanTxBatch: the datagrams are staged in place and the
+ * message headers for sendmmsg are linked to the slots once at construction.
+ * \tparam N the maximum number of datagrams to stage.
+ * \tparam Size the maximum length of one datagram in bytes.
+ */
+template < std::size_t N, std::size_t Size > class UdpTxBatch
+{
+  public:
+    /**
+     * \brief Default constructor linking the message headers to the slots.
+     */
+    UdpTxBatch() noexcept : m_staged{0U}
+    {
+        static_assert(N > 0U, "The batch must hold at least one datagram.");
+        static_assert(Size <= UDP_MAX_PAYLOAD,
+                      "The datagram exceeds the UDP maximum.");
+
+        for (std::size_t i = 0U; i < N; ++i)
+        {
+            m_iovs[i].iov_base = m_datagrams[i].data();
+            m_iovs[i].iov_len = 0U;
+            std::memset(&m_msgs[i], 0, sizeof(struct mmsghdr));
+            m_msgs[i].msg_hdr.msg_iov = &m_iovs[i];
+            m_msgs[i].msg_hdr.msg_iovlen = 1U;
+        }
+    }
+
+    /// The message headers point into this object. Copying is not allowed.
+    UdpTxBatch(const UdpTxBatch&) = delete;
+    UdpTxBatch& operator=(const UdpTxBatch&) = delete;
+
+    /**
+     * \brief Reserves the next datagram to fill in place.
+     * \param[in] len the length of the datagram, at most Size.
+     * \return the buffer to fill or nullptr if the batch is full or the
+     * datagram is too long.
+     */
+    std::uint8_t* stage(const std::size_t len) noexcept
+    {
+        std::uint8_t* datagram{nullptr};
+
+        if ((m_staged < N) && (len <= Size))
+        {
+            datagram = m_datagrams[m_staged].data();
+            m_iovs[m_staged].iov_len = len;
+            ++m_staged;
+        }
+
+        return datagram;
+    }
+
+    /**
+     * \brief Stages a datagram copying the data into the slot.
+     * \param[in] data the data to transmit.
+     * \param[in] len length in bytes to send.
+     * \return true if the datagram is staged, false if not.
+     */
+    bool push(const void* data, const std::size_t len) noexcept
+    {
+        std::uint8_t* const datagram = stage(len);
+
+        if (datagram != nullptr)
+        {
+            std::memcpy(datagram, data, len);
+        }
+
+        return (datagram != nullptr);
+    }
+
+    /**
+     * \brief Stages a packet as one datagram.
+     * \tparam PacketSize the size of the packet, at most Size.
+     */
+    template < std::size_t PacketSize >
+    bool push(const Packet< PacketSize >& packet) noexcept
+    {
+        static_assert(PacketSize <= Size, "The packet exceeds the datagram.");
+        return push(packet.get_data().data(), PacketSize);
+    }
+
+    /**
+     * \brief Number of datagrams staged and not yet sent.
+     */
+    std::size_t pending() const noexcept { return m_staged; }
+
+    /**
+     * \brief true if no datagram is waiting for transmission.
+     */
+    bool empty() const noexcept { return pending() == 0U; }
+
+    /**
+     * \brief true if no more datagrams can be staged.
+     */
+    bool full() const noexcept { return m_staged == N; }
+
+    /**
+     * \brief Drops all staged datagrams.
+     */
+    void clear() noexcept { m_staged = 0U; }
+
+    /**
+     * \brief The message headers of the datagrams not yet sent.
+     */
+    struct mmsghdr* pending_messages() noexcept { return m_msgs.data(); }
+
+    /**
+     * \brief Marks the given number of pending datagrams as sent. The
+     * datagrams not yet sent are moved to the front, so the slots of the
+     * datagrams sent can be staged again right away.
+     * \param[in] sent number of datagrams the kernel accepted.
+     */
+    void consume(const std::size_t sent) noexcept
+    {
+        const std::size_t done = std::min(sent, m_staged);
+
+        for (std::size_t i = done; i < m_staged; ++i)
+        {
+            std::memcpy(m_datagrams[i - done].data(), m_datagrams[i].data(),
+                        m_iovs[i].iov_len);
+            m_iovs[i - done].iov_len = m_iovs[i].iov_len;
+        }
+
+        m_staged -= done;
+    }
+
+  private:
+    /// the datagrams staged for transmission.
+    std::array< std::array< std::uint8_t, Size >, N > m_datagrams;
+
+    /// one io vector per datagram holding its address and length.
+    std::array< struct iovec, N > m_iovs;
+
+    /// one message header per datagram given to sendmmsg.
+    std::array< struct mmsghdr, N > m_msgs;
+
+    /// number of datagrams staged.
+    std::size_t m_staged;
+};
+
+/**
+ * \brief Statically sized buffers receiving several datagrams with one
+ * system call by UdpSocket::receive_batch().
+ * \tparam N the maximum number of datagrams received at once.
+ * \tparam Size the maximum length of one datagram. Longer datagrams are
+ * truncated.
+ */
+template < std::size_t N, std::size_t Size > class UdpRxBatch
+{
+  public:
+    /**
+     * \brief Default constructor linking the message headers to the buffers.
+     */
+    UdpRxBatch() noexcept : m_count{0U}
+    {
+        static_assert(N > 0U, "The batch must hold at least one datagram.");
+        static_assert(Size <= UDP_MAX_PAYLOAD,
+                      "The datagram exceeds the UDP maximum.");
+
+        for (std::size_t i = 0U; i < N; ++i)
+        {
+            m_iovs[i].iov_base = m_datagrams[i].data();
+            m_iovs[i].iov_len = Size;
+            std::memset(&m_msgs[i], 0, sizeof(struct mmsghdr));
+            m_msgs[i].msg_hdr.msg_iov = &m_iovs[i];
+            m_msgs[i].msg_hdr.msg_iovlen = 1U;
+            m_msgs[i].msg_hdr.msg_name = &m_sources[i];
+        }
+    }
+
+    /// The message headers point into this object. Copying is not allowed.
+    UdpRxBatch(const UdpRxBatch&) = delete;
+    UdpRxBatch& operator=(const UdpRxBatch&) = delete;
+
+    /**
+     * \brief Number of datagrams received by the last receive_batch().
+     */
+    std::size_t size() const noexcept { return m_count; }
+
+    /**
+     * \brief The data of a received datagram.
+     */
+    const std::uint8_t* data(const std::size_t index) const noexcept
+    {
+        return m_datagrams[index].data();
+    }
+
+    /**
+     * \brief The length of a received datagram, at most Size.
+     */
+    std::size_t length(const std::size_t index) const noexcept
+    {
+        return std::min(static_cast< std::size_t >(m_msgs[index].msg_len),
+                        Size);
+    }
+
+    /**
+     * \brief true if a datagram was longer than Size and is cut off.
+     */
+    bool truncated(const std::size_t index) const noexcept
+    {
+        return (m_msgs[index].msg_hdr.msg_flags & MSG_TRUNC) != 0;
+    }
+
+    /**
+     * \brief The sender of a received datagram.
+     */
+    const struct sockaddr_in& source(const std::size_t index) const noexcept
+    {
+        return m_sources[index];
+    }
+
+    /**
+     * \brief Prepares the message headers for the next receive.
+     * \return the message headers to pass to recvmmsg.
+     */
+    struct mmsghdr* prepare() noexcept
+    {
+        m_count = 0U;
+
+        for (auto& msg : m_msgs)
+        {
+            msg.msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+            msg.msg_hdr.msg_flags = 0;
+        }
+
+        return m_msgs.data();
+    }
+
+    /**
+     * \brief Sets the number of datagrams received.
+     */
+    void commit(const std::size_t count) noexcept { m_count = count; }
+
+  private:
+    /// the datagrams received.
+    std::array< std::array< std::uint8_t, Size >, N > m_datagrams;
+
+    /// the senders of the datagrams.
+    std::array< struct sockaddr_in, N > m_sources;
+
+    /// one io vector per datagram.
+    std::array< struct iovec, N > m_iovs;
+
+    /// one message header per datagram given to recvmmsg.
+    std::array< struct mmsghdr, N > m_msgs;
+
+    /// number of datagrams received.
+    std::size_t m_count;
+};
+
+/**
+ * \brief UdpSocket sends and receives datagrams, unicast or to a multicast
+ * group. One datagram sent to a group reaches every listener that joined
+ * it, thus a publisher sends its data once instead of once per client.
+ */
+class UdpSocket : public Socket< UdpSocket >
+{
+  public:
+    /**
+     * \brief Default constructor calls the base class Socket to
+     * create a socket.
+     */
+    UdpSocket() noexcept;
+
+    ~UdpSocket() noexcept = default;
+
+    /**
+     * \brief Create a UDP socket; this is called by the base class.
+     * \return true if the socket is opened or false if there was an error.
+     */
+    bool create() noexcept;
+
+    /**
+     * \brief Binds the socket to a local address and port to receive on.
+     * \param[in] ip_address the local IP4 address, "255.255.255.0" for any.
+     * Listeners of a multicast group bind to any address.
+     * \param[in] port the port to receive on.
+     * \return true if the socket is bound, false if not.
+     */
+    bool bind(IpAddress ip_address, const std::uint16_t port) noexcept;
+
+    /**
+     * \brief Allows several sockets to bind to the same port, e.g. several
+     * listeners of one multicast group on a host. Call it before bind().
+     * \return true if the option is set, false if not.
+     */
+    bool reuse_addr() noexcept;
+
+    /**
+     * \brief Sets the address send() and send_batch() transmit to.
+     * \param[in] ip_address a unicast or multicast IP4 address.
+     * \param[in] port the destination port.
+     */
+    void set_destination(IpAddress ip_address,
+                         const std::uint16_t port) noexcept;
+
+    /**
+     * \brief Sends one datagram to the destination.
+     * \param[in] message the data to send.
+     * \param[in] len the length of the datagram.
+     * \return the number of bytes sent or -1 if there was an error. Unlike
+     * TcpSocket the count is 32 bit wide, a datagram may exceed 32767 bytes.
+     */
+    std::int32_t send(const void* message, const std::uint16_t len) noexcept;
+
+    /**
+     * \brief Sends a packet as one datagram to the destination.
+     */
+    template < std::size_t Size >
+    std::int32_t send(const Packet< Size >& packet) noexcept
+    {
+        static_assert(Size <= UDP_MAX_PAYLOAD,
+                      "The packet exceeds a UDP datagram.");
+        return send(packet.get_data().data(),
+                    static_cast< std::uint16_t >(Size));
+    }
+
+    /**
+     * \brief Transmits all pending datagrams of a batch to the destination
+     * with one system call (sendmmsg).
+     * \param[in,out] batch the datagrams to send. Datagrams sent are removed
+     * from the batch, the others remain pending for the next call.
+     * \return the number of datagrams sent or -1 if there was an error.
+     */
+    template < std::size_t N, std::size_t Size >
+    std::int16_t send_batch(UdpTxBatch< N, Size >& batch) noexcept
+    {
+        std::int16_t sent{-1};
+        const auto pending = batch.pending();
+
+        if ((is_socket_initialized() == true) && (m_has_destination == true))
+        {
+            sent = 0;
+
+            if (pending > 0U)
+            {
+                struct mmsghdr* const msgs = batch.pending_messages();
+
+                for (std::size_t i = 0U; i < pending; ++i)
+                {
+                    msgs[i].msg_hdr.msg_name = &m_destination;
+                    msgs[i].msg_hdr.msg_namelen = sizeof(m_destination);
+                }
+
+                const int ndatagrams =
+                    sendmmsg(get_socket_handle(), msgs,
+                             static_cast< unsigned int >(pending), 0);
+
+                if (ndatagrams >= 0)
+                {
+                    batch.consume(static_cast< std::size_t >(ndatagrams));
+                    sent = static_cast< std::int16_t >(ndatagrams);
+                }
+                else if ((errno == ENOBUFS) || (errno == EAGAIN))
+                {
+                    // the send buffer is full. nothing sent, try again.
+                    SetErrorNumber(errno);
+                    sent = 0;
+                }
+                else
+                {
+                    SetErrorNumber(errno);
+                    sent = -1;
+                }
+            }
+        }
+
+        return sent;
+    }
+
+    /**
+     * \brief Receives one datagram (blocking read unless non-blocking).
+     * \param[out] message the buffer to store the datagram to.
+     * \param[in] len the size of the buffer. Longer datagrams are truncated.
+     * \return the number of bytes received or -1 if there was an error.
+     */
+    std::int32_t receive(void* message, const std::uint16_t len) noexcept;
+
+    /**
+     * \brief Receives one datagram into a packet.
+     */
+    template < std::size_t Size >
+    std::int32_t receive(Packet< Size >& packet) noexcept
+    {
+        static_assert(Size <= UDP_MAX_PAYLOAD,
+                      "The packet exceeds a UDP datagram.");
+        return receive(packet.get_data().data(),
+                       static_cast< std::uint16_t >(Size));
+    }
+
+    /**
+     * \brief Receives all datagrams pending on the socket with one system
+     * call (recvmmsg). On a blocking socket this waits for the first
+     * datagram only.
+     * \param[out] batch the buffers to receive to.
+     * \return the number of datagrams received or -1 if there was an error.
+     */
+    template < std::size_t N, std::size_t Size >
+    std::int16_t receive_batch(UdpRxBatch< N, Size >& batch) noexcept
+    {
+        std::int16_t received{-1};
+
+        if (is_socket_initialized() == true)
+        {
+            const int ndatagrams =
+                recvmmsg(get_socket_handle(), batch.prepare(),
+                         static_cast< unsigned int >(N), MSG_WAITFORONE,
+                         nullptr);
+
+            if (ndatagrams >= 0)
+            {
+                batch.commit(static_cast< std::size_t >(ndatagrams));
+                received = static_cast< std::int16_t >(ndatagrams);
+            }
+            else
+            {
+                // Error or nothing to receive on a non-blocking socket.
+                SetErrorNumber(errno);
+            }
+        }
+
+        return received;
+    }
+
+    /**
+     * \brief Joins a multicast group: datagrams sent to the group are
+     * received on the port this socket is bound to.
+     * \param[in] group the multicast address, e.g. "239.0.0.1".
+     * \param[in] interface the address of the local interface to join on,
+     * "255.255.255.0" lets the kernel choose.
+     * \return true if the group is joined, false if not.
+     */
+    bool join_group(IpAddress group,
+                    IpAddress interface = "255.255.255.0") noexcept;
+
+    /**
+     * \brief Leaves a multicast group joined before.
+     * \return true if the group is left, false if not.
+     */
+    bool leave_group(IpAddress group,
+                     IpAddress interface = "255.255.255.0") noexcept;
+
+    /**
+     * \brief Number of routers a multicast datagram passes (IP_MULTICAST_TTL).
+     * \param[in] ttl 1 (default) keeps the datagrams in the local network.
+     * \return true if the option is set, false if not.
+     */
+    bool set_multicast_ttl(const std::uint8_t ttl) noexcept;
+
+    /**
+     * \brief Whether multicast datagrams sent are received by listeners on
+     * the same host (IP_MULTICAST_LOOP, default on).
+     * \return true if the option is set, false if not.
+     */
+    bool set_multicast_loop(const bool loop) noexcept;
+
+    /**
+     * \brief Selects the interface multicast datagrams are sent on.
+     * \param[in] interface the address of the local interface.
+     * \return true if the option is set, false if not.
+     */
+    bool set_multicast_interface(IpAddress interface) noexcept;
+
+    /**
+     * \brief Sets the size of the send buffer (SO_SNDBUF). The kernel
+     * doubles the value for its bookkeeping and limits it to
+     * net.core.wmem_max.
+     * \param[in] bytes the requested size.
+     * \return true if the option is set, false if not.
+     */
+    bool set_send_buffer(const int bytes) noexcept;
+
+    /**
+     * \brief Sets the size of the receive buffer (SO_RCVBUF). A larger
+     * buffer absorbs bursts of datagrams before they are dropped. The limit
+     * is net.core.rmem_max.
+     * \param[in] bytes the requested size.
+     * \return true if the option is set, false if not.
+     */
+    bool set_receive_buffer(const int bytes) noexcept;
+
+    /**
+     * \brief The size of the receive buffer as set by the kernel.
+     * \return the size in bytes or -1 if there was an error.
+     */
+    int get_receive_buffer() noexcept;
+
+  private:
+    /**
+     * \brief Sets an integer socket option.
+     */
+    bool set_option(const int level, const int name, const int value) noexcept;
+
+    /**
+     * \brief Joins or leaves a multicast group.
+     */
+    bool membership(const int option, IpAddress& group,
+                    IpAddress& interface) noexcept;
+
+    /// where send() and send_batch() transmit to.
+    struct sockaddr_in m_destination;
+
+    /// true if a destination is set.
+    bool m_has_destination;
+};
+
+#endif /* _WIN32 */
+#endif /* UDPSOCKET_H_ */
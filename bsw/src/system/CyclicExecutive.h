@@ -0,0 +1,397 @@
+/**
+ * @file      CyclicExecutive.h
+ * @author    dtuchscherer <daniel.tuchscherer@gmail.com>
+ * @brief     Multi-rate cyclic executive
+ * @details   Runs several periodic jobs with different periods on one
+ *            real-time thread using a schedule table computed at compile time.
+ * @version   1.0
+ * @copyright Copyright (c) 2018, dtuchscherer.
+ *            All rights reserved.
+ *
+ *            Redistributions and use in source and binary forms, with
+ *            or without modifications, are permitted provided that the
+ *            following conditions are met: Redistributions of source code must
+ *            retain the above copyright notice, this list of conditions and the
+ *            following disclaimer.
+ *
+ *            Redistributions in binary form must reproduce the above copyright
+ *            notice, this list of conditions and the following disclaimer in
+ *            the documentation and/or other materials provided with the
+ *            distribution.
+ *
+ *            Neither the name of the Heilbronn University nor the name of its
+ *            contributors may be used to endorse or promote products derived
+ *            from this software without specific prior written permission.
+ *
+ *            THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS “AS IS”
+ *            AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ *            TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ *            PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE REGENTS
+ *            OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *            SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *            LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *            USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *            AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *            LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *            ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *            POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CYCLICEXECUTIVE_H_
+#define CYCLICEXECUTIVE_H_
+
+#include "RTTask.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <utility>
+
+/**
+ * @brief A job of the cyclic executive.
+ * @tparam Task a class with the methods pre(), update() and post() like the
+ * derived class of an RTTask.
+ * @tparam PeriodMicro period of the job in microseconds.
+ */
+template < typename Task, long int PeriodMicro > struct PeriodicJob
+{
+    static_assert(PeriodMicro > 0, "The period must be greater than zero.");
+
+    /// the class implementing the job.
+    using TaskType = Task;
+
+    /// the period in microseconds.
+    static constexpr long int period = PeriodMicro;
+};
+
+/**
+ * @brief Greatest common divisor of all periods.
+ */
+template < std::size_t N >
+constexpr long int periods_gcd(const long int (&periods)[N]) noexcept
+{
+    long int result = periods[0];
+
+    for (std::size_t i = 1U; i < N; ++i)
+    {
+        long int a = result;
+        long int b = periods[i];
+
+        while (b != 0)
+        {
+            const long int r = a % b;
+            a = b;
+            b = r;
+        }
+
+        result = a;
+    }
+
+    return result;
+}
+
+/**
+ * @brief Least common multiple of all periods, the hyperperiod.
+ */
+template < std::size_t N >
+constexpr long int periods_lcm(const long int (&periods)[N]) noexcept
+{
+    long int result = periods[0];
+
+    for (std::size_t i = 1U; i < N; ++i)
+    {
+        const long int single[2] = {result, periods[i]};
+        result = (result / periods_gcd< 2U >(single)) * periods[i];
+    }
+
+    return result;
+}
+
+/**
+ * @brief The compile-time schedule of a cyclic executive.
+ * @details The hyperperiod is divided into frames of the minor cycle, the
+ * greatest common divisor of all periods. Bit j of masks[i] is set if job j
+ * is released in frame i. order lists the jobs rate-monotonic, the shortest
+ * period first; jobs with equal periods keep their declaration order.
+ * @tparam Jobs number of jobs.
+ * @tparam Frames number of frames in the hyperperiod.
+ */
+template < std::size_t Jobs, std::size_t Frames > struct ScheduleTable
+{
+    /// released jobs per frame.
+    std::uint64_t masks[Frames];
+
+    /// execution order of the jobs within a frame.
+    std::size_t order[Jobs];
+};
+
+/**
+ * @brief Builds the schedule table of the given periods.
+ */
+template < std::size_t Jobs, std::size_t Frames >
+constexpr ScheduleTable< Jobs, Frames >
+make_schedule(const long int (&periods)[Jobs], long int minor) noexcept
+{
+    ScheduleTable< Jobs, Frames > table{};
+
+    for (std::size_t frame = 0U; frame < Frames; ++frame)
+    {
+        table.masks[frame] = 0U;
+
+        for (std::size_t job = 0U; job < Jobs; ++job)
+        {
+            if (((static_cast< long int >(frame) * minor) % periods[job]) == 0)
+            {
+                table.masks[frame] |= (std::uint64_t{1U} << job);
+            }
+        }
+    }
+
+    // insertion sort by period keeps equal periods in declaration order.
+    for (std::size_t i = 0U; i < Jobs; ++i)
+    {
+        std::size_t j = i;
+
+        while ((j > 0U) && (periods[table.order[j - 1U]] > periods[i]))
+        {
+            table.order[j] = table.order[j - 1U];
+            --j;
+        }
+
+        table.order[j] = i;
+    }
+
+    return table;
+}
+
+/**
+ * @brief Static cyclic executive running several jobs on one thread.
+ * @details Instead of one RTThread per job, all jobs share one real-time
+ * loop running at the minor cycle. Each frame the released jobs are updated
+ * in rate-monotonic order. The executive is itself an RTTask: call
+ * task_entry() from the thread that shall run it, or start() to create a
+ * thread with the given attributes.
+ * A frame overrun skips the following frames and with them the releases of
+ * the jobs within, the jobs are never called back-to-back. Jobs may be
+ * accessed with job<I>().
+ * @tparam Priority of the executive thread.
+ * @tparam Attributes scheduling policy, CPU affinity and stack of the thread.
+ * @tparam Jobs PeriodicJob entries, at most 64.
+ */
+template < int Priority, typename Attributes, typename... Jobs >
+class CyclicExecutive
+    : public RTTask< CyclicExecutive< Priority, Attributes, Jobs... >,
+                     Priority, periods_gcd< sizeof...(Jobs) >({Jobs::period...}),
+                     OverrunSkip, Attributes >
+{
+  public:
+    /// number of jobs.
+    static constexpr std::size_t JOB_COUNT = sizeof...(Jobs);
+
+    /// the minor cycle in microseconds: the period of the real-time loop.
+    static constexpr long int MINOR_CYCLE =
+        periods_gcd< JOB_COUNT >({Jobs::period...});
+
+    /// the hyperperiod in microseconds after which the schedule repeats.
+    static constexpr long int HYPERPERIOD =
+        periods_lcm< JOB_COUNT >({Jobs::period...});
+
+    /// number of frames within the hyperperiod.
+    static constexpr std::size_t FRAMES =
+        static_cast< std::size_t >(HYPERPERIOD / MINOR_CYCLE);
+
+    static_assert(JOB_COUNT > 0U, "The executive needs at least one job.");
+    static_assert(JOB_COUNT <= 64U, "The executive supports up to 64 jobs.");
+    static_assert(FRAMES <= 100000U,
+                  "The hyperperiod is too long, choose harmonic periods.");
+
+    /// the schedule table.
+    static constexpr ScheduleTable< JOB_COUNT, FRAMES > SCHEDULE =
+        make_schedule< JOB_COUNT, FRAMES >({Jobs::period...}, MINOR_CYCLE);
+
+    /**
+     * @brief Default constructor, starting with the first frame.
+     */
+    CyclicExecutive() noexcept : m_frame{0U}, m_started{false} {}
+
+    /**
+     * @brief Calls pre() of all jobs.
+     * @return true if all jobs are ready.
+     */
+    bool pre() noexcept
+    {
+        return pre_jobs(std::index_sequence_for< Jobs... >{});
+    }
+
+    /**
+     * @brief Runs all jobs released in the current frame.
+     * @return false if one of the jobs failed, the executive stops then.
+     */
+    bool update() noexcept
+    {
+        const auto mask = SCHEDULE.masks[m_frame];
+        bool update_ok = true;
+
+        for (std::size_t i = 0U; i < JOB_COUNT; ++i)
+        {
+            const auto index = SCHEDULE.order[i];
+
+            if ((mask & (std::uint64_t{1U} << index)) != 0U)
+            {
+                update_ok &= UPDATES[index](m_jobs);
+            }
+        }
+
+        advance(1U);
+        return update_ok;
+    }
+
+    /**
+     * @brief Calls post() of all jobs.
+     */
+    void post() noexcept
+    {
+        post_jobs(std::index_sequence_for< Jobs... >{});
+    }
+
+    /**
+     * @brief The frame took longer than the minor cycle. The real-time loop
+     * resumes at the next frame boundary, hence the frames in between are
+     * skipped.
+     * @param[in] late_ns how long the frame ran past its end.
+     */
+    void on_overrun(std::int64_t late_ns) noexcept
+    {
+        constexpr std::int64_t NSEC_PER_USEC{1000};
+        constexpr std::int64_t MINOR_NS = MINOR_CYCLE * NSEC_PER_USEC;
+        advance(static_cast< std::size_t >((MINOR_NS + late_ns) / MINOR_NS));
+    }
+
+    /**
+     * @brief Access to a job.
+     * @tparam I index of the job in the template parameter list.
+     */
+    template < std::size_t I >
+    typename std::tuple_element< I, std::tuple< typename Jobs::TaskType... > >::
+        type&
+        job() noexcept
+    {
+        return std::get< I >(m_jobs);
+    }
+
+    /**
+     * @brief The frame which is executed next.
+     */
+    std::size_t frame() const noexcept { return m_frame; }
+
+    /**
+     * @brief Runs the executive in its own thread.
+     * @return true if the thread was created.
+     */
+    bool start() noexcept
+    {
+        m_started = (m_started == true) || this->create_thread();
+        return m_started;
+    }
+
+    /**
+     * @brief Stops the loop after the current frame and waits for the thread.
+     * @return true if the thread was joined, false if it was not started.
+     */
+    bool stop() noexcept
+    {
+        bool stopped = false;
+        this->m_task_running = false;
+
+        if (m_started == true)
+        {
+            stopped = this->close_thread();
+            m_started = false;
+        }
+
+        return stopped;
+    }
+
+  private:
+    /// the instances of all jobs.
+    using JobTuple = std::tuple< typename Jobs::TaskType... >;
+
+    /// calls update() of one job.
+    using UpdateFn = bool (*)(JobTuple& jobs);
+
+    /**
+     * @brief Update of the job at index I.
+     */
+    template < std::size_t I > static bool update_job(JobTuple& jobs) noexcept
+    {
+        return std::get< I >(jobs).update();
+    }
+
+    /**
+     * @brief Table of the update functions, indexed like the jobs.
+     */
+    template < std::size_t... I >
+    static constexpr std::array< UpdateFn, JOB_COUNT >
+    make_updates(std::index_sequence< I... >) noexcept
+    {
+        return {{&update_job< I >...}};
+    }
+
+    /**
+     * @brief Calls pre() of all jobs, even if one of them fails.
+     */
+    template < std::size_t... I >
+    bool pre_jobs(std::index_sequence< I... >) noexcept
+    {
+        bool ready = true;
+        int expand[] = {0, (ready &= std::get< I >(m_jobs).pre(), 0)...};
+        static_cast< void >(expand);
+        return ready;
+    }
+
+    /**
+     * @brief Calls post() of all jobs.
+     */
+    template < std::size_t... I >
+    void post_jobs(std::index_sequence< I... >) noexcept
+    {
+        int expand[] = {0, (std::get< I >(m_jobs).post(), 0)...};
+        static_cast< void >(expand);
+    }
+
+    /// update functions of the jobs.
+    static constexpr std::array< UpdateFn, JOB_COUNT > UPDATES =
+        make_updates(std::index_sequence_for< Jobs... >{});
+
+    /**
+     * @brief Moves forward in the schedule.
+     */
+    void advance(std::size_t frames) noexcept
+    {
+        m_frame = (m_frame + frames) % FRAMES;
+    }
+
+    /// all jobs.
+    JobTuple m_jobs;
+
+    /// index of the next frame within the hyperperiod.
+    std::size_t m_frame;
+
+    /// true while a thread created by start() must be joined.
+    bool m_started;
+};
+
+template < int Priority, typename Attributes, typename... Jobs >
+constexpr ScheduleTable< CyclicExecutive< Priority, Attributes,
+                                          Jobs... >::JOB_COUNT,
+                         CyclicExecutive< Priority, Attributes,
+                                          Jobs... >::FRAMES >
+    CyclicExecutive< Priority, Attributes, Jobs... >::SCHEDULE;
+
+template < int Priority, typename Attributes, typename... Jobs >
+constexpr std::array<
+    typename CyclicExecutive< Priority, Attributes, Jobs... >::UpdateFn,
+    CyclicExecutive< Priority, Attributes, Jobs... >::JOB_COUNT >
+    CyclicExecutive< Priority, Attributes, Jobs... >::UPDATES;
+
+#endif /* CYCLICEXECUTIVE_H_ */
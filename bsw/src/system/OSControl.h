@@ -39,6 +39,12 @@
 #ifndef OSCONTROL_H_
 #define OSCONTROL_H_
 
+#include "OverrunPolicy.h"
+#include "TaskAttributes.h"
+#include "TaskStatistics.h"
+#include "Trace.h"
+#include <cerrno>
+#include <cstdint>
 #include <iostream>
 #include <limits>    // Check numeric limits of data types at compile-time.
 #include <pthread.h> // POSIX threads for send and receive thread.
@@ -75,17 +81,48 @@ class OSControl
     /**
      * @brief Creates a real-time task as pthread.
      * @tparam F is the function called after pthread creation.
+     * @tparam Priority the static priority the thread starts with. With 0 the
+     * scheduling is inherited from the creating thread. If the process is not
+     * privileged to set it, the thread is created with the inherited
+     * scheduling and the task reports the failure once it runs.
+     * @tparam Attributes CPU affinity, scheduling policy and stack size of the
+     * thread, see TaskAttributes.
      * @param[in] context is a pointer to an object that is used to get access
      * to class methods within the pthread context.
      * @return true if the task has been created, false if the creation was
      * not successful.
      */
-    template < void* F(void* context) >
+    template < void* F(void* context), int Priority = 0,
+               typename Attributes = TaskAttributes<> >
     bool create_rt_thread(void* context, TaskHandle& handle) noexcept
     {
         bool created = false;
-        const auto thread_running =
-            pthread_create(&handle.m_handle, nullptr, F, context);
+        pthread_attr_t attributes;
+
+        if (pthread_attr_init(&attributes) != 0)
+        {
+            return false;
+        }
+
+        auto thread_running = -1;
+
+        if (Attributes::apply(attributes, Priority))
+        {
+            thread_running =
+                pthread_create(&handle.m_handle, &attributes, F, context);
+
+            if ((thread_running == EPERM) && (Priority > 0))
+            {
+                std::cerr << "No privileges for real-time scheduling, the "
+                             "thread inherits the scheduling.\n";
+                pthread_attr_setinheritsched(&attributes,
+                                             PTHREAD_INHERIT_SCHED);
+                thread_running =
+                    pthread_create(&handle.m_handle, &attributes, F, context);
+            }
+        }
+
+        pthread_attr_destroy(&attributes);
 
         if (thread_running == 0)
         {
@@ -123,14 +160,44 @@ class OSControl
     /**
      * @brief The RT Task to call. This will enter a loop as long as the
      * running variable is set to true.
+     * @tparam Overrun the policy when update() takes longer than Period.
+     * @tparam Attributes scheduling policy, CPU affinity and pre-faulted stack.
      * @param running
      * @param callee
      */
-    template < int Priority, long int Period, typename T >
+    template < int Priority, long int Period,
+               typename Overrun = OverrunCatchUp<>,
+               typename Attributes = TaskAttributes<>, typename T >
     void rt_task(bool& running, T& callee) noexcept
+    {
+        TaskStatistics<> statistics;
+        rt_task< Priority, Period, Overrun, Attributes >(running, callee,
+                                                         statistics);
+    }
+
+    /**
+     * @brief The RT Task to call. This will enter a loop as long as the
+     * running variable is set to true. Each cycle the wakeup latency, the
+     * execution time of update() and overruns are recorded.
+     * If update() finishes after the next release, the callee's optional
+     * on_overrun(std::int64_t late_ns) is called and the policy Overrun
+     * decides when the task is released next.
+     * @tparam Overrun the policy when update() takes longer than Period.
+     * @tparam Attributes scheduling policy, CPU affinity and pre-faulted stack.
+     * They are applied again in case the task was not started by
+     * create_rt_thread().
+     * @param running
+     * @param callee
+     * @param[out] statistics where the cycles are recorded. May be read from
+     * another thread while the task is running.
+     */
+    template < int Priority, long int Period,
+               typename Overrun = OverrunCatchUp<>,
+               typename Attributes = TaskAttributes<>, typename T,
+               typename Statistics >
+    void rt_task(bool& running, T& callee, Statistics& statistics) noexcept
     {
         struct timespec t;
-        struct sched_param sched_param;
 
         // linux timespec calculates in nanoseconds. We convert the constant
         // value from microseconds into nanoseconds.
@@ -149,16 +216,13 @@ class OSControl
         static_assert(INTERVAL <= std::numeric_limits< long int >::max(),
                       "Time interval is too big to fit into a long.");
 
-        // set the scheduler's priority
-        sched_param.sched_priority = Priority;
-
-        // Set up the scheduler to round-robin algorithm.
-        // Additionally to SCHED_FIFO SCHED_RR time slices
-        const int prio_policy_set =
-            sched_setscheduler(0, SCHED_RR, &sched_param);
+        // Set up the scheduler to the configured policy (round-robin by
+        // default) and pin the thread to its cores.
+        const bool prio_policy_set =
+            Attributes::apply_to_current(Priority, Period);
 
         // check if the priority was set.
-        if (prio_policy_set == -1)
+        if (prio_policy_set == false)
         {
             // if the high priority of the real-time task could not be assigned
             // we will leave immediately. If we're not able to set high
@@ -176,7 +240,7 @@ class OSControl
         }
 
         /* Pre-fault our stack */
-        stack_prefault();
+        stack_prefault< Attributes::prefault_size() >();
 
         // Write the time struct once.
         clock_gettime(CLOCK_MONOTONIC, &t);
@@ -192,8 +256,31 @@ class OSControl
             // resolution timer.
             clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &t, NULL);
 
+            struct timespec woken;
+            clock_gettime(CLOCK_MONOTONIC, &woken);
+
             // The method must always be named like this!
-            const auto call_ok = callee.update();
+            bool call_ok = false;
+            {
+                BSW_TRACE_SCOPE("RTTask::update");
+                call_ok = callee.update();
+            }
+
+            struct timespec done;
+            clock_gettime(CLOCK_MONOTONIC, &done);
+
+            // the cycle overran if update() did not finish before the next
+            // release time.
+            const auto late = difference_ns(t, woken);
+            const auto execution = difference_ns(woken, done);
+            const auto elapsed = difference_ns(t, done);
+            const bool overrun = elapsed > INTERVAL;
+            statistics.record(late, execution, overrun);
+
+            if (overrun)
+            {
+                notify_overrun(callee, elapsed - INTERVAL, 0);
+            }
 
             // check if something bad has happened.
             if (call_ok == false)
@@ -202,8 +289,9 @@ class OSControl
                 running = false;
             }
 
-            // add for the next shot, otherwise clock_nanosleep has no effect
-            t.tv_nsec += INTERVAL;
+            // add for the next shot, otherwise clock_nanosleep has no effect.
+            // After an overrun the policy may skip or shift releases.
+            t.tv_nsec += Overrun::next_release(elapsed, INTERVAL);
 
             // if the nanoseconds field exceeds 1s...
             normalize(t);
@@ -212,14 +300,57 @@ class OSControl
 
     /**
      * @brief tries to allocate memory within a pthread.
+     * @details The writes go through a volatile pointer, the compiler may
+     * not remove them as dead stores like a memset of a local array.
+     * @tparam Size the number of stack bytes to touch.
      */
+    template < std::size_t Size = 8U * 1024U >
     void stack_prefault() noexcept
     {
-        std::uint8_t stack[8 * 1024];
-        memset(stack, 0, 8 * 1024);
+        std::uint8_t stack[Size];
+        volatile std::uint8_t* const touch = stack;
+
+        for (std::size_t i = 0U; i < Size; i += 1024U)
+        {
+            touch[i] = 0U;
+        }
     }
 
   private:
+    /**
+     * @brief Calls on_overrun() of the callee if it provides one.
+     * @param[in] late_ns how long update() ran past the next release.
+     */
+    template < typename T >
+    static auto notify_overrun(T& callee, std::int64_t late_ns, int) noexcept
+        -> decltype(callee.on_overrun(late_ns), void())
+    {
+        callee.on_overrun(late_ns);
+    }
+
+    /**
+     * @brief Fallback if the callee has no on_overrun().
+     */
+    template < typename T >
+    static void notify_overrun(T&, std::int64_t, long) noexcept
+    {
+    }
+
+    /**
+     * @brief Time between two timestamps.
+     * @param[in] from the earlier timestamp.
+     * @param[in] to the later timestamp.
+     * @return to - from in nanoseconds.
+     */
+    static std::int64_t difference_ns(const struct timespec& from,
+                                      const struct timespec& to) noexcept
+    {
+        constexpr std::int64_t NSEC_PER_SEC = 1000000000LL;
+        return ((static_cast< std::int64_t >(to.tv_sec) - from.tv_sec) *
+                NSEC_PER_SEC) +
+               (static_cast< std::int64_t >(to.tv_nsec) - from.tv_nsec);
+    }
+
     /**
      * @brief Necessary to calculate the time correctly for the next
      * nanosleep. If the field nanoseconds of structure timespec exceeds
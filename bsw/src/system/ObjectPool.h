@@ -0,0 +1,267 @@
+/**
+ * @file      ObjectPool.h
+ * @author    dtuchscherer <daniel.tuchscherer@gmail.com>
+ * @brief     Lock-free fixed-block pools
+ * @details   Preallocated and prefaulted blocks for real-time tasks which are
+ *            handed out and returned by any thread without locks.
+ * @version   1.0
+ * @copyright Copyright (c) 2018, dtuchscherer.
+ *            All rights reserved.
+ *
+ *            Redistributions and use in source and binary forms, with
+ *            or without modifications, are permitted provided that the
+ *            following conditions are met: Redistributions of source code must
+ *            retain the above copyright notice, this list of conditions and the
+ *            following disclaimer.
+ *
+ *            Redistributions in binary form must reproduce the above copyright
+ *            notice, this list of conditions and the following disclaimer in
+ *            the documentation and/or other materials provided with the
+ *            distribution.
+ *
+ *            Neither the name of the Heilbronn University nor the name of its
+ *            contributors may be used to endorse or promote products derived
+ *            from this software without specific prior written permission.
+ *
+ *            THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS “AS IS”
+ *            AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ *            TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ *            PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE REGENTS
+ *            OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *            SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *            LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *            USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *            AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *            LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *            ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *            POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OBJECTPOOL_H_
+#define OBJECTPOOL_H_
+
+#include "SpscQueue.h" // CACHE_LINE_SIZE
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @brief Fixed number of blocks for objects of type T.
+ * @details All blocks are part of the pool object and are written once at
+ * construction, so they are resident before mlockall() of a real-time task
+ * locks them. Create pools before the tasks start, e.g. as static objects.
+ * acquire() and release() never allocate or block and may be called from
+ * any number of threads: free blocks are kept on a lock-free stack whose head
+ * carries a tag against the ABA problem.
+ * Objects are passed by pointer, e.g. through a SpscQueue< T*, N >, instead
+ * of copying them by value.
+ * @tparam T the type of the objects.
+ * @tparam Count the number of blocks.
+ */
+template < typename T, std::size_t Count > class ObjectPool
+{
+    static_assert(Count > 0U, "A pool needs at least one block.");
+    static_assert(Count < std::numeric_limits< std::uint32_t >::max(),
+                  "Blocks are indexed by 32 bit.");
+
+  public:
+    /**
+     * @brief Prefaults all blocks and puts them on the free stack.
+     */
+    ObjectPool() noexcept
+        : m_head{0U}, m_in_use{0U}, m_high_water{0U}, m_failed{0U}
+    {
+        // touch every page of the storage.
+        std::memset(&m_storage, 0, sizeof(m_storage));
+
+        for (std::uint32_t i = 0U; i < Count; ++i)
+        {
+            m_next[i].store(i + 1U, std::memory_order_relaxed);
+        }
+    }
+
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+    /**
+     * @brief Takes a free block and constructs an object in it.
+     * @param[in] args the arguments of the constructor of T.
+     * @return the object or nullptr if the pool is exhausted.
+     */
+    template < typename... Args > T* acquire(Args&&... args) noexcept
+    {
+        T* object{nullptr};
+        const std::uint32_t index = pop();
+
+        if (index != END)
+        {
+            object = new (block(index)) T(std::forward< Args >(args)...);
+            update_usage();
+        }
+        else
+        {
+            m_failed.fetch_add(1U, std::memory_order_relaxed);
+        }
+
+        return object;
+    }
+
+    /**
+     * @brief Destroys the object and returns its block to the pool.
+     * @param[in] object an object of this pool or nullptr.
+     */
+    void release(T* object) noexcept
+    {
+        if (object != nullptr)
+        {
+            object->~T();
+            // count first, so in_use() never exceeds the capacity.
+            m_in_use.fetch_sub(1U, std::memory_order_relaxed);
+            push(index_of(object));
+        }
+    }
+
+    /**
+     * @brief Checks if the object is a block of this pool.
+     */
+    bool owns(const T* object) const noexcept
+    {
+        const auto address = reinterpret_cast< std::uintptr_t >(object);
+        const auto first = reinterpret_cast< std::uintptr_t >(&m_storage[0]);
+        return (address >= first) && (address < (first + sizeof(m_storage))) &&
+               (((address - first) % sizeof(Block)) == 0U);
+    }
+
+    /**
+     * @brief The number of blocks.
+     */
+    static constexpr std::size_t capacity() noexcept { return Count; }
+
+    /**
+     * @brief The number of objects currently acquired.
+     */
+    std::size_t in_use() const noexcept
+    {
+        return m_in_use.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief The maximum number of objects acquired at the same time since
+     * construction. Use it to size the pool in production.
+     */
+    std::size_t high_water() const noexcept
+    {
+        return m_high_water.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief The number of acquire() calls that failed on an exhausted pool.
+     */
+    std::size_t failed() const noexcept
+    {
+        return m_failed.load(std::memory_order_relaxed);
+    }
+
+  private:
+    /// storage of one object.
+    using Block = typename std::aligned_storage< sizeof(T), alignof(T) >::type;
+
+    /// index that marks the end of the free stack.
+    static constexpr std::uint32_t END{static_cast< std::uint32_t >(Count)};
+
+    void* block(const std::uint32_t index) noexcept
+    {
+        return &m_storage[index];
+    }
+
+    std::uint32_t index_of(const T* object) const noexcept
+    {
+        const auto offset =
+            reinterpret_cast< const Block* >(object) - &m_storage[0];
+        return static_cast< std::uint32_t >(offset);
+    }
+
+    /// the head holds the tag in the upper and the index in the lower half.
+    static std::uint64_t make_head(const std::uint64_t tag,
+                                   const std::uint32_t index) noexcept
+    {
+        return (tag << 32U) | index;
+    }
+
+    std::uint32_t pop() noexcept
+    {
+        std::uint64_t head = m_head.load(std::memory_order_acquire);
+        std::uint32_t index = static_cast< std::uint32_t >(head);
+
+        while (index != END)
+        {
+            const std::uint32_t next =
+                m_next[index].load(std::memory_order_relaxed);
+            const auto new_head = make_head((head >> 32U) + 1U, next);
+
+            if (m_head.compare_exchange_weak(head, new_head,
+                                             std::memory_order_acquire,
+                                             std::memory_order_acquire))
+            {
+                break;
+            }
+
+            index = static_cast< std::uint32_t >(head);
+        }
+
+        return index;
+    }
+
+    void push(const std::uint32_t index) noexcept
+    {
+        std::uint64_t head = m_head.load(std::memory_order_relaxed);
+        std::uint64_t new_head{0U};
+
+        do
+        {
+            m_next[index].store(static_cast< std::uint32_t >(head),
+                                std::memory_order_relaxed);
+            new_head = make_head((head >> 32U) + 1U, index);
+        } while (!m_head.compare_exchange_weak(head, new_head,
+                                               std::memory_order_release,
+                                               std::memory_order_relaxed));
+    }
+
+    void update_usage() noexcept
+    {
+        const std::size_t used =
+            m_in_use.fetch_add(1U, std::memory_order_relaxed) + 1U;
+        std::size_t high = m_high_water.load(std::memory_order_relaxed);
+
+        while ((used > high) &&
+               !m_high_water.compare_exchange_weak(high, used,
+                                                   std::memory_order_relaxed))
+        {
+        }
+    }
+
+    /// the objects.
+    std::array< Block, Count > m_storage;
+
+    /// successor of each free block on the stack.
+    std::array< std::atomic< std::uint32_t >, Count > m_next;
+
+    /// top of the free stack, contended by all threads.
+    alignas(CACHE_LINE_SIZE) std::atomic< std::uint64_t > m_head;
+
+    /// the usage counters.
+    alignas(CACHE_LINE_SIZE) std::atomic< std::size_t > m_in_use;
+    std::atomic< std::size_t > m_high_water;
+    std::atomic< std::size_t > m_failed;
+};
+
+template < typename T, std::size_t Count >
+constexpr std::uint32_t ObjectPool< T, Count >::END;
+
+#endif /* OBJECTPOOL_H_ */
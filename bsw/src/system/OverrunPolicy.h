@@ -0,0 +1,117 @@
+/**
+ * @file      OverrunPolicy.h
+ * @author    dtuchscherer <daniel.tuchscherer@gmail.com>
+ * @brief     Overrun policies of real-time tasks
+ * @details   Decide when a periodic task is released next after update()
+ *            took longer than one period.
+ * @version   1.0
+ * @copyright Copyright (c) 2018, dtuchscherer.
+ *            All rights reserved.
+ *
+ *            Redistributions and use in source and binary forms, with
+ *            or without modifications, are permitted provided that the
+ *            following conditions are met: Redistributions of source code must
+ *            retain the above copyright notice, this list of conditions and the
+ *            following disclaimer.
+ *
+ *            Redistributions in binary form must reproduce the above copyright
+ *            notice, this list of conditions and the following disclaimer in
+ *            the documentation and/or other materials provided with the
+ *            distribution.
+ *
+ *            Neither the name of the Heilbronn University nor the name of its
+ *            contributors may be used to endorse or promote products derived
+ *            from this software without specific prior written permission.
+ *
+ *            THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS “AS IS”
+ *            AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ *            TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ *            PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE REGENTS
+ *            OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *            SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *            LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *            USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *            AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *            LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *            ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *            POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OVERRUNPOLICY_H_
+#define OVERRUNPOLICY_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+/**
+ * @brief Overrun policies are given as template parameter to RTTask. Each
+ * policy provides
+ *
+ *     static std::int64_t next_release(std::int64_t now, std::int64_t period)
+ *
+ * where now is the time elapsed since the current release and the result is
+ * the time of the next release, both in nanoseconds relative to the current
+ * release. Without an overrun (now < period) every policy returns period.
+ */
+
+/**
+ * @brief Catch up missed cycles by calling update() back-to-back.
+ * @details The task stays on its original time grid. After an overrun all
+ * missed releases are executed immediately, but at most MaxBurst of them.
+ * Older releases are dropped. The default catches up every missed cycle.
+ * @tparam MaxBurst how many missed cycles are executed back-to-back.
+ */
+template < std::size_t MaxBurst = std::numeric_limits< std::size_t >::max() >
+struct OverrunCatchUp
+{
+    static_assert(MaxBurst > 0U, "At least one cycle must be caught up.");
+
+    static constexpr std::int64_t next_release(std::int64_t now,
+                                               std::int64_t period) noexcept
+    {
+        // number of releases which are already in the past.
+        const auto missed =
+            (now < period) ? 0U : static_cast< std::uint64_t >(now / period);
+        std::int64_t next = period;
+
+        if (missed > MaxBurst)
+        {
+            // drop the oldest releases so that MaxBurst remain.
+            next = static_cast< std::int64_t >(missed - MaxBurst + 1U) * period;
+        }
+
+        return next;
+    }
+};
+
+/**
+ * @brief Skip missed cycles.
+ * @details The task stays on its original time grid. After an overrun the
+ * next release is the next period boundary in the future, i.e. the task
+ * never runs twice in a row.
+ */
+struct OverrunSkip
+{
+    static constexpr std::int64_t next_release(std::int64_t now,
+                                               std::int64_t period) noexcept
+    {
+        return (now < period) ? period : ((now / period) + 1) * period;
+    }
+};
+
+/**
+ * @brief Shift the phase of the task.
+ * @details After an overrun the next release is one full period after
+ * update() finished. The task leaves its original time grid.
+ */
+struct OverrunRealign
+{
+    static constexpr std::int64_t next_release(std::int64_t now,
+                                               std::int64_t period) noexcept
+    {
+        return (now < period) ? period : now + period;
+    }
+};
+
+#endif /* OVERRUNPOLICY_H_ */
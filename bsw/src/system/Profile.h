@@ -43,6 +43,7 @@
 
 /**
  * \brief Profile for determination of time difference between two timepoints.
+ * \remark For measurements in production use the probes of Trace.h.
  */
 class Profile
 {
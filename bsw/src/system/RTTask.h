@@ -46,17 +46,25 @@
 
 /**
  * @tparam Derived A class that holds at least three methods pre(), update() and
- * post().
+ * post(). It may provide on_overrun(std::int64_t late_ns) which is called
+ * whenever update() took longer than the period.
  * @tparam Derived
  * @tparam Priority of this real-time task
  * @tparam PeriodMicro task period in microseconds
+ * @tparam Overrun policy to continue after an overrun: OverrunCatchUp<>
+ * (default), OverrunCatchUp<MaxBurst>, OverrunSkip or OverrunRealign.
+ * @tparam Attributes scheduling policy (SCHED_RR by default), CPU affinity and
+ * stack size, see TaskAttributes.
  */
-template < typename Derived, int Priority, long int PeriodMicro >
+template < typename Derived, int Priority, long int PeriodMicro,
+           typename Overrun = OverrunCatchUp<>,
+           typename Attributes = TaskAttributes<> >
 class RTTask : public OSControl
 {
   public:
     /// Get the type for giving it to the template method of OSControl.
-    using TaskType = RTTask< Derived, Priority, PeriodMicro >;
+    using TaskType =
+        RTTask< Derived, Priority, PeriodMicro, Overrun, Attributes >;
 
     /**
      * @brief Default constructor creating the real-time task.
@@ -123,11 +131,25 @@ class RTTask : public OSControl
         {
             // after the pre it will enter the periodic update.
             m_task_running = true;
-            // calls the update method cyclically at a given rate.
-            rt_task< Priority, PeriodMicro, TaskType >(m_task_running, *this);
+            // calls the update method cyclically at a given rate. The derived
+            // task is the callee so its optional on_overrun() is found.
+            rt_task< Priority, PeriodMicro, Overrun, Attributes >(
+                m_task_running, *static_cast< Derived* >(this), m_statistics);
             // post-conditions after
             post();
         }
+
+        return nullptr;
+    }
+
+    /**
+     * @brief Cycle statistics of this task: wakeup latency, execution time
+     * of update() and overruns. Safe to read from another thread while the
+     * task is running.
+     */
+    const TaskStatistics<>& statistics() const noexcept
+    {
+        return m_statistics;
     }
 
     /**
@@ -145,7 +167,7 @@ class RTTask : public OSControl
     static constexpr int m_priority = Priority;
 
     //! Static period in microseconds.
-    static constexpr int m_period = PeriodMicro;
+    static constexpr long int m_period = PeriodMicro;
 
   protected:
     /**
@@ -153,7 +175,8 @@ class RTTask : public OSControl
      */
     bool create_thread() noexcept
     {
-        return create_rt_thread< TaskType::thread_helper >(this, m_task_handle);
+        return create_rt_thread< TaskType::thread_helper, Priority,
+                                 Attributes >(this, m_task_handle);
     }
 
     /**
@@ -167,6 +190,9 @@ class RTTask : public OSControl
     /// The handle to manage this task.
     TaskHandle m_task_handle;
 
+    /// Recorded by the real-time loop.
+    TaskStatistics<> m_statistics;
+
   private:
 };
 
@@ -175,19 +201,44 @@ class RTTask : public OSControl
  * Each thread can has only one task, but may spawn other threads which also
  * have their real-time tasks.
  */
-template < typename Derived, int Priority, int PeriodMicro >
-class RTThread : public RTTask< Derived, Priority, PeriodMicro >
+template < typename Derived, int Priority, long int PeriodMicro,
+           typename Overrun = OverrunCatchUp<>,
+           typename Attributes = TaskAttributes<> >
+class RTThread
+    : public RTTask< Derived, Priority, PeriodMicro, Overrun, Attributes >
 {
   public:
     /**
      * @brief Constructor creating a real-time thread.
      */
-    RTThread() noexcept { const auto created = this->create_thread(); }
+    RTThread() noexcept : m_created{this->create_thread()}
+    {
+        if (m_created == false)
+        {
+            std::cerr << "Error on creating the real-time thread.\n";
+        }
+    }
+
+    /**
+     * @brief Destructor will close the thread if it was created.
+     */
+    ~RTThread() noexcept
+    {
+        if (m_created == true)
+        {
+            const auto closed = this->close_thread();
+            static_cast< void >(closed);
+        }
+    }
 
     /**
-     * @brief Destructor will close the thread.
+     * @brief If the thread was created.
      */
-    ~RTThread() noexcept { const auto closed = this->close_thread(); }
+    bool is_created() const noexcept { return m_created; }
+
+  private:
+    /// true if the thread was created and must be joined.
+    bool m_created;
 };
 
 #endif /* RTTASK_H_ */
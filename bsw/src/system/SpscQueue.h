@@ -0,0 +1,225 @@
+/**
+ * @file      SpscQueue.h
+ * @author    dtuchscherer <daniel.tuchscherer@gmail.com>
+ * @brief     Lock-free queue between two threads
+ * @details   A wait-free single-producer/single-consumer ring buffer of fixed
+ *            capacity to hand over data between a real-time task and an I/O
+ *            thread.
+ * @version   1.0
+ * @copyright Copyright (c) 2018, dtuchscherer.
+ *            All rights reserved.
+ *
+ *            Redistributions and use in source and binary forms, with
+ *            or without modifications, are permitted provided that the
+ *            following conditions are met: Redistributions of source code must
+ *            retain the above copyright notice, this list of conditions and the
+ *            following disclaimer.
+ *
+ *            Redistributions in binary form must reproduce the above copyright
+ *            notice, this list of conditions and the following disclaimer in
+ *            the documentation and/or other materials provided with the
+ *            distribution.
+ *
+ *            Neither the name of the Heilbronn University nor the name of its
+ *            contributors may be used to endorse or promote products derived
+ *            from this software without specific prior written permission.
+ *
+ *            THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS “AS IS”
+ *            AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ *            TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ *            PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE REGENTS
+ *            OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *            SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *            LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *            USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *            AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *            LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *            ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *            POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SPSCQUEUE_H_
+#define SPSCQUEUE_H_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/// Size of a cache line. Indices written by different threads are kept on
+/// separate cache lines to avoid false sharing.
+constexpr std::size_t CACHE_LINE_SIZE{64U};
+
+/**
+ * @brief Wait-free single-producer/single-consumer queue.
+ * @details The queue hands over elements between exactly one producer
+ * thread and exactly one consumer thread, e.g. from a receive thread to a
+ * real-time task, without locks. No call blocks or allocates memory, thus it
+ * is safe to use within RTTask::update(). The elements are stored in a
+ * statically sized array like the data of a Packet.
+ * @tparam T the element type.
+ * @tparam Capacity the maximum number of elements. Must be a power of two.
+ */
+template < typename T, std::size_t Capacity > class SpscQueue
+{
+  public:
+    /**
+     * @brief Default constructor creating an empty queue.
+     */
+    SpscQueue() noexcept
+        : m_head{0U}, m_tail_cache{0U}, m_tail{0U}, m_head_cache{0U}
+    {
+        static_assert((Capacity > 0U) && ((Capacity & (Capacity - 1U)) == 0U),
+                      "The capacity must be a power of two.");
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    /**
+     * @brief Producer: appends a copy of the element.
+     * @param[in] value the element to append.
+     * @return true if appended, false if the queue is full.
+     */
+    bool try_push(const T& value) noexcept
+    {
+        T* slot = prepare();
+
+        if (slot != nullptr)
+        {
+            *slot = value;
+            commit();
+        }
+
+        return (slot != nullptr);
+    }
+
+    /**
+     * @brief Producer: reserves the next slot to fill in place. The element
+     * is visible to the consumer after commit().
+     * @return the slot to fill or nullptr if the queue is full.
+     */
+    T* prepare() noexcept
+    {
+        T* slot{nullptr};
+        const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+
+        if ((tail - m_head_cache) == Capacity)
+        {
+            // only touch the consumer's cache line if the queue seems full.
+            m_head_cache = m_head.load(std::memory_order_acquire);
+        }
+
+        if ((tail - m_head_cache) < Capacity)
+        {
+            slot = &m_slots[tail & MASK];
+        }
+
+        return slot;
+    }
+
+    /**
+     * @brief Producer: publishes the slot filled after prepare().
+     */
+    void commit() noexcept
+    {
+        const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+        m_tail.store(tail + 1U, std::memory_order_release);
+    }
+
+    /**
+     * @brief Consumer: takes out the oldest element.
+     * @param[out] value the element taken out.
+     * @return true if an element was taken, false if the queue is empty.
+     */
+    bool try_pop(T& value) noexcept
+    {
+        const T* slot = front();
+
+        if (slot != nullptr)
+        {
+            value = *slot;
+            pop();
+        }
+
+        return (slot != nullptr);
+    }
+
+    /**
+     * @brief Consumer: accesses the oldest element in place.
+     * @return the oldest element or nullptr if the queue is empty.
+     */
+    const T* front() noexcept
+    {
+        const T* slot{nullptr};
+        const std::size_t head = m_head.load(std::memory_order_relaxed);
+
+        if (head == m_tail_cache)
+        {
+            // only touch the producer's cache line if the queue seems empty.
+            m_tail_cache = m_tail.load(std::memory_order_acquire);
+        }
+
+        if (head != m_tail_cache)
+        {
+            slot = &m_slots[head & MASK];
+        }
+
+        return slot;
+    }
+
+    /**
+     * @brief Consumer: releases the element accessed by front().
+     */
+    void pop() noexcept
+    {
+        const std::size_t head = m_head.load(std::memory_order_relaxed);
+        m_head.store(head + 1U, std::memory_order_release);
+    }
+
+    /**
+     * @brief The number of elements queued. Exact if called by the producer
+     * or consumer while the other side is idle, an estimate otherwise.
+     * @details Safe on any thread: the head is loaded first and never passes
+     * the tail loaded afterwards. Both sides may move in between, so the
+     * estimate is clamped to the capacity.
+     */
+    std::size_t size() const noexcept
+    {
+        const std::size_t head = m_head.load(std::memory_order_acquire);
+        const std::size_t tail = m_tail.load(std::memory_order_acquire);
+        const std::size_t queued = tail - head;
+        return (queued < Capacity) ? queued : Capacity;
+    }
+
+    /**
+     * @brief true if no element is queued.
+     */
+    bool empty() const noexcept { return size() == 0U; }
+
+    /**
+     * @brief The maximum number of elements.
+     */
+    static constexpr std::size_t capacity() noexcept { return Capacity; }
+
+  private:
+    /// wraps the free running indices into the array.
+    static constexpr std::size_t MASK{Capacity - 1U};
+
+    /// index of the next element to take out, written by the consumer.
+    alignas(CACHE_LINE_SIZE) std::atomic< std::size_t > m_head;
+
+    /// the consumer's copy of the producer's index.
+    std::size_t m_tail_cache;
+
+    /// index of the next slot to fill, written by the producer.
+    alignas(CACHE_LINE_SIZE) std::atomic< std::size_t > m_tail;
+
+    /// the producer's copy of the consumer's index.
+    std::size_t m_head_cache;
+
+    /// the elements.
+    alignas(CACHE_LINE_SIZE) std::array< T, Capacity > m_slots;
+};
+
+#endif /* SPSCQUEUE_H_ */
@@ -0,0 +1,244 @@
+/**
+ * @file      TaskAttributes.h
+ * @author    dtuchscherer <daniel.tuchscherer@gmail.com>
+ * @brief     Scheduling attributes of real-time tasks
+ * @details   Compile-time configuration of the scheduling policy, the CPU
+ *            affinity and the stack of a real-time thread.
+ * @version   1.0
+ * @copyright Copyright (c) 2018, dtuchscherer.
+ *            All rights reserved.
+ *
+ *            Redistributions and use in source and binary forms, with
+ *            or without modifications, are permitted provided that the
+ *            following conditions are met: Redistributions of source code must
+ *            retain the above copyright notice, this list of conditions and the
+ *            following disclaimer.
+ *
+ *            Redistributions in binary form must reproduce the above copyright
+ *            notice, this list of conditions and the following disclaimer in
+ *            the documentation and/or other materials provided with the
+ *            distribution.
+ *
+ *            Neither the name of the Heilbronn University nor the name of its
+ *            contributors may be used to endorse or promote products derived
+ *            from this software without specific prior written permission.
+ *
+ *            THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS “AS IS”
+ *            AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ *            TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ *            PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE REGENTS
+ *            OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *            SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *            LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *            USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *            AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *            LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *            ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *            POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef TASKATTRIBUTES_H_
+#define TASKATTRIBUTES_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#ifndef SCHED_DEADLINE
+#define SCHED_DEADLINE 6
+#endif
+
+/**
+ * @brief The scheduling policies for real-time tasks.
+ */
+enum class SchedPolicy
+{
+    /// static priority, runs until it blocks or a higher priority is ready.
+    FIFO,
+    /// like FIFO, but tasks of the same priority share time slices.
+    RR,
+    /// earliest deadline first with a guaranteed runtime per period.
+    DEADLINE
+};
+
+/**
+ * @brief Layout of the kernel's struct sched_attr for sched_setattr(2).
+ * @remark glibc does not provide a wrapper for all versions, so the system
+ * call is used directly.
+ */
+struct SchedAttributes
+{
+    std::uint32_t size;
+    std::uint32_t sched_policy;
+    std::uint64_t sched_flags;
+    std::int32_t sched_nice;
+    std::uint32_t sched_priority;
+    std::uint64_t sched_runtime;
+    std::uint64_t sched_deadline;
+    std::uint64_t sched_period;
+};
+
+/**
+ * @brief Attributes a real-time thread is created with.
+ * @details The attributes are applied when the thread is created, so the
+ * thread runs with its policy and on its cores from the first instruction.
+ * SCHED_DEADLINE can not be set by pthread attributes and is set at the
+ * beginning of the real-time loop instead. Without root privileges or
+ * CAP_SYS_NICE the thread creation fails.
+ * @tparam Policy the scheduling policy.
+ * @tparam CpuMask bit n pins the thread to CPU n, e.g. 1U << 3 for an isolated
+ * core 3. 0 keeps the affinity of the creating thread. Must be 0 with
+ * SCHED_DEADLINE: the kernel refuses a deadline task whose affinity is
+ * narrower than its root domain (EPERM/EBUSY); isolate deadline tasks with
+ * an exclusive cpuset instead.
+ * @tparam StackSize stack size in bytes. 0 keeps the default.
+ * @tparam PrefaultSize bytes of the stack touched before the real-time loop
+ * so no page fault occurs later on.
+ * @tparam RuntimeMicro SCHED_DEADLINE only: CPU time per period in
+ * microseconds.
+ * @tparam DeadlineMicro SCHED_DEADLINE only: relative deadline within the
+ * period in microseconds. 0 uses the period of the task.
+ */
+template < SchedPolicy Policy = SchedPolicy::RR, std::uint64_t CpuMask = 0U,
+           std::size_t StackSize = 0U, std::size_t PrefaultSize = 8U * 1024U,
+           long int RuntimeMicro = 0, long int DeadlineMicro = 0 >
+struct TaskAttributes
+{
+    // PTHREAD_STACK_MIN is no constant expression on recent glibc versions.
+    static_assert((StackSize == 0U) || (StackSize >= 16U * 1024U),
+                  "The stack size is smaller than PTHREAD_STACK_MIN.");
+
+    static_assert((StackSize == 0U) || (PrefaultSize < StackSize),
+                  "Can not pre-fault more than the stack size.");
+
+    static_assert((Policy != SchedPolicy::DEADLINE) || (RuntimeMicro > 0),
+                  "SCHED_DEADLINE needs a runtime greater than zero.");
+
+    static_assert((DeadlineMicro == 0) || (RuntimeMicro <= DeadlineMicro),
+                  "The runtime must not exceed the deadline.");
+
+    static_assert((Policy != SchedPolicy::DEADLINE) || (CpuMask == 0U),
+                  "SCHED_DEADLINE can not be pinned, use an exclusive cpuset.");
+
+    /// the policy as used by the scheduler API.
+    static constexpr int policy() noexcept
+    {
+        return (Policy == SchedPolicy::FIFO)
+                   ? SCHED_FIFO
+                   : ((Policy == SchedPolicy::RR) ? SCHED_RR : SCHED_DEADLINE);
+    }
+
+    /// bytes of the stack to pre-fault.
+    static constexpr std::size_t prefault_size() noexcept
+    {
+        return PrefaultSize;
+    }
+
+    /**
+     * @brief Writes the attributes into pthread attributes before the thread
+     * is created.
+     * @param[out] attributes initialized pthread attributes.
+     * @param[in] priority the static priority. With 0 the scheduling is
+     * inherited from the creating thread.
+     * @return true if all attributes were accepted.
+     */
+    static bool apply(pthread_attr_t& attributes, int priority) noexcept
+    {
+        bool applied = true;
+
+        if (StackSize > 0U)
+        {
+            applied &= (pthread_attr_setstacksize(&attributes, StackSize) == 0);
+        }
+
+        if (CpuMask != 0U)
+        {
+            cpu_set_t cpus;
+            fill(cpus);
+            applied &= (pthread_attr_setaffinity_np(&attributes, sizeof(cpus),
+                                                    &cpus) == 0);
+        }
+
+        if ((Policy != SchedPolicy::DEADLINE) && (priority > 0))
+        {
+            struct sched_param param;
+            param.sched_priority = priority;
+            applied &= (pthread_attr_setinheritsched(
+                            &attributes, PTHREAD_EXPLICIT_SCHED) == 0);
+            applied &=
+                (pthread_attr_setschedpolicy(&attributes, policy()) == 0);
+            applied &= (pthread_attr_setschedparam(&attributes, &param) == 0);
+        }
+
+        return applied;
+    }
+
+    /**
+     * @brief Applies the attributes to the calling thread.
+     * @param[in] priority the static priority for FIFO and RR.
+     * @param[in] period_micro the period of the task, used by DEADLINE.
+     * @return true if the policy and affinity were set.
+     */
+    static bool apply_to_current(int priority, long int period_micro) noexcept
+    {
+        bool applied = true;
+
+        if (CpuMask != 0U)
+        {
+            cpu_set_t cpus;
+            fill(cpus);
+            applied &= (sched_setaffinity(0, sizeof(cpus), &cpus) == 0);
+        }
+
+        if (Policy == SchedPolicy::DEADLINE)
+        {
+            constexpr std::uint64_t NSEC_PER_USEC{1000U};
+            const auto period = static_cast< std::uint64_t >(period_micro);
+            const auto deadline = (DeadlineMicro == 0)
+                                      ? period
+                                      : static_cast< std::uint64_t >(
+                                            DeadlineMicro);
+
+            SchedAttributes attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.sched_policy = SCHED_DEADLINE;
+            attr.sched_runtime =
+                static_cast< std::uint64_t >(RuntimeMicro) * NSEC_PER_USEC;
+            attr.sched_deadline = deadline * NSEC_PER_USEC;
+            attr.sched_period = period * NSEC_PER_USEC;
+            applied &= (syscall(SYS_sched_setattr, 0, &attr, 0U) == 0);
+        }
+        else
+        {
+            struct sched_param param;
+            param.sched_priority = priority;
+            applied &= (sched_setscheduler(0, policy(), &param) == 0);
+        }
+
+        return applied;
+    }
+
+  private:
+    /**
+     * @brief Converts the mask into a CPU set.
+     */
+    static void fill(cpu_set_t& cpus) noexcept
+    {
+        CPU_ZERO(&cpus);
+
+        for (std::size_t cpu = 0U; cpu < 64U; ++cpu)
+        {
+            if (((CpuMask >> cpu) & 1U) != 0U)
+            {
+                CPU_SET(cpu, &cpus);
+            }
+        }
+    }
+};
+
+#endif /* TASKATTRIBUTES_H_ */
@@ -0,0 +1,325 @@
+/**
+ * @file      TaskStatistics.h
+ * @author    dtuchscherer <daniel.tuchscherer@gmail.com>
+ * @brief     Cycle statistics of real-time tasks
+ * @details   Lock-free histograms of the wakeup latency and the execution
+ *            time of periodic tasks which can be read from another thread.
+ * @version   1.0
+ * @copyright Copyright (c) 2018, dtuchscherer.
+ *            All rights reserved.
+ *
+ *            Redistributions and use in source and binary forms, with
+ *            or without modifications, are permitted provided that the
+ *            following conditions are met: Redistributions of source code must
+ *            retain the above copyright notice, this list of conditions and the
+ *            following disclaimer.
+ *
+ *            Redistributions in binary form must reproduce the above copyright
+ *            notice, this list of conditions and the following disclaimer in
+ *            the documentation and/or other materials provided with the
+ *            distribution.
+ *
+ *            Neither the name of the Heilbronn University nor the name of its
+ *            contributors may be used to endorse or promote products derived
+ *            from this software without specific prior written permission.
+ *
+ *            THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS “AS IS”
+ *            AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ *            TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ *            PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE REGENTS
+ *            OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *            SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *            LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *            USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *            AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *            LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *            ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *            POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef TASKSTATISTICS_H_
+#define TASKSTATISTICS_H_
+
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+/**
+ * @brief Histogram of durations in nanoseconds with linear buckets.
+ * @details All buckets are preallocated. Samples are recorded by exactly one
+ * thread (the real-time task) without locks or read-modify-write operations.
+ * Any other thread may read the counters at any time. The values of a reader
+ * are consistent per counter, but not across counters.
+ * @tparam Buckets number of buckets. Durations beyond the last bucket are
+ * counted in an additional overflow bucket.
+ * @tparam ResolutionNs width of one bucket in nanoseconds.
+ */
+template < std::size_t Buckets, std::int64_t ResolutionNs >
+class LatencyHistogram
+{
+  public:
+    /**
+     * @brief Default constructor creating an empty histogram.
+     */
+    LatencyHistogram() noexcept
+        : m_count{0U}, m_sum{0U},
+          m_min{std::numeric_limits< std::int64_t >::max()}, m_max{0}
+    {
+        static_assert(Buckets > 0U, "The histogram needs at least one bucket.");
+        static_assert(ResolutionNs > 0, "The resolution must be positive.");
+        reset();
+    }
+
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    /**
+     * @brief Writer: removes all samples.
+     */
+    void reset() noexcept
+    {
+        m_count.store(0U, std::memory_order_release);
+        m_sum.store(0U, std::memory_order_relaxed);
+        m_min.store(std::numeric_limits< std::int64_t >::max(),
+                    std::memory_order_relaxed);
+        m_max.store(0, std::memory_order_relaxed);
+
+        for (auto& bucket : m_buckets)
+        {
+            bucket.store(0U, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Writer: adds one sample. Negative durations are counted as 0.
+     * @param[in] duration_ns the sample in nanoseconds.
+     */
+    void record(std::int64_t duration_ns) noexcept
+    {
+        if (duration_ns < 0)
+        {
+            duration_ns = 0;
+        }
+
+        auto index = static_cast< std::size_t >(duration_ns / ResolutionNs);
+
+        if (index > Buckets)
+        {
+            index = Buckets;
+        }
+
+        // there is only one writer, a plain load and store is enough.
+        increment(m_buckets[index]);
+
+        if (duration_ns < m_min.load(std::memory_order_relaxed))
+        {
+            m_min.store(duration_ns, std::memory_order_relaxed);
+        }
+
+        if (duration_ns > m_max.load(std::memory_order_relaxed))
+        {
+            m_max.store(duration_ns, std::memory_order_relaxed);
+        }
+
+        const auto sum = m_sum.load(std::memory_order_relaxed);
+        m_sum.store(sum + static_cast< std::uint64_t >(duration_ns),
+                    std::memory_order_relaxed);
+
+        // published last so a reader never sees more samples than buckets.
+        const auto count = m_count.load(std::memory_order_relaxed);
+        m_count.store(count + 1U, std::memory_order_release);
+    }
+
+    /**
+     * @brief Number of recorded samples.
+     */
+    std::uint64_t count() const noexcept
+    {
+        return m_count.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Smallest sample in nanoseconds, 0 if nothing was recorded.
+     */
+    std::int64_t min() const noexcept
+    {
+        return (count() == 0U) ? 0 : m_min.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Largest sample in nanoseconds.
+     */
+    std::int64_t max() const noexcept
+    {
+        return m_max.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Average of all samples in nanoseconds.
+     */
+    std::int64_t mean() const noexcept
+    {
+        const auto samples = count();
+        const auto sum = m_sum.load(std::memory_order_relaxed);
+        return (samples == 0U) ? 0 : static_cast< std::int64_t >(sum / samples);
+    }
+
+    /**
+     * @brief Upper bound of the bucket containing the given percentile.
+     * @param[in] percent the percentile between 0 and 100, e.g. 99.9.
+     * @return the duration in nanoseconds that percent of all samples did
+     * not exceed, accurate to the resolution. The largest sample is returned
+     * if the percentile falls into the overflow bucket.
+     */
+    std::int64_t percentile(double percent) const noexcept
+    {
+        const auto samples = count();
+        auto rank = static_cast< std::uint64_t >(
+            std::ceil((static_cast< double >(samples) * percent) / 100.0));
+
+        if (rank == 0U)
+        {
+            rank = 1U;
+        }
+
+        std::uint64_t seen{0U};
+
+        for (std::size_t i = 0U; (i < Buckets) && (samples > 0U); ++i)
+        {
+            seen += m_buckets[i].load(std::memory_order_relaxed);
+
+            if (seen >= rank)
+            {
+                return static_cast< std::int64_t >(i + 1U) * ResolutionNs;
+            }
+        }
+
+        return max();
+    }
+
+    /**
+     * @brief Number of samples in a bucket. Index Buckets is the overflow.
+     */
+    std::uint32_t bucket(std::size_t index) const noexcept
+    {
+        return m_buckets[index].load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Number of buckets without the overflow bucket.
+     */
+    static constexpr std::size_t bucket_count() noexcept { return Buckets; }
+
+    /**
+     * @brief Width of one bucket in nanoseconds.
+     */
+    static constexpr std::int64_t resolution() noexcept
+    {
+        return ResolutionNs;
+    }
+
+  private:
+    /**
+     * @brief Single-writer increment of a bucket.
+     */
+    static void increment(std::atomic< std::uint32_t >& counter) noexcept
+    {
+        const auto value = counter.load(std::memory_order_relaxed);
+        counter.store(value + 1U, std::memory_order_relaxed);
+    }
+
+    /// the buckets, the last one counts all samples beyond the range.
+    std::array< std::atomic< std::uint32_t >, Buckets + 1U > m_buckets;
+
+    /// number of samples.
+    std::atomic< std::uint64_t > m_count;
+
+    /// sum of all samples to calculate the mean.
+    std::atomic< std::uint64_t > m_sum;
+
+    /// smallest sample.
+    std::atomic< std::int64_t > m_min;
+
+    /// largest sample.
+    std::atomic< std::int64_t > m_max;
+};
+
+/**
+ * @brief Statistics of a periodic real-time task.
+ * @details The wakeup latency is the time between the planned release of a
+ * cycle and the moment the task actually runs. The execution time is the
+ * time update() takes. A cycle overruns if update() does not finish before
+ * the next release. Recorded by OSControl::rt_task(), read by anyone.
+ * @tparam Buckets number of histogram buckets.
+ * @tparam ResolutionNs width of one bucket in nanoseconds. The default of
+ * 1000 buckets of 1 us covers a 1 ms loop.
+ */
+template < std::size_t Buckets = 1000U, std::int64_t ResolutionNs = 1000 >
+class TaskStatistics
+{
+  public:
+    /// The histogram type used for latency and execution time.
+    using Histogram = LatencyHistogram< Buckets, ResolutionNs >;
+
+    /**
+     * @brief Default constructor with all counters at zero.
+     */
+    TaskStatistics() noexcept : m_overruns{0U} {}
+
+    /**
+     * @brief Writer: records one cycle of the task.
+     * @param[in] wakeup_ns wakeup latency of this cycle in nanoseconds.
+     * @param[in] execution_ns execution time of update() in nanoseconds.
+     * @param[in] overrun true if update() finished after the next release.
+     */
+    void record(std::int64_t wakeup_ns, std::int64_t execution_ns,
+                bool overrun) noexcept
+    {
+        if (overrun)
+        {
+            const auto overruns = m_overruns.load(std::memory_order_relaxed);
+            m_overruns.store(overruns + 1U, std::memory_order_relaxed);
+        }
+
+        m_wakeup.record(wakeup_ns);
+        m_execution.record(execution_ns);
+    }
+
+    /**
+     * @brief Histogram of the wakeup latencies.
+     */
+    const Histogram& wakeup_latency() const noexcept { return m_wakeup; }
+
+    /**
+     * @brief Histogram of the execution times of update().
+     */
+    const Histogram& execution_time() const noexcept { return m_execution; }
+
+    /**
+     * @brief Number of recorded cycles.
+     */
+    std::uint64_t cycles() const noexcept { return m_execution.count(); }
+
+    /**
+     * @brief Number of cycles where update() exceeded the period.
+     */
+    std::uint64_t overruns() const noexcept
+    {
+        return m_overruns.load(std::memory_order_relaxed);
+    }
+
+  private:
+    /// wakeup latency per cycle.
+    Histogram m_wakeup;
+
+    /// execution time of update() per cycle.
+    Histogram m_execution;
+
+    /// number of overruns.
+    std::atomic< std::uint64_t > m_overruns;
+};
+
+#endif /* TASKSTATISTICS_H_ */
@@ -0,0 +1,430 @@
+/**
+ * @file      Trace.h
+ * @author    dtuchscherer <daniel.tuchscherer@gmail.com>
+ * @brief     Scoped tracing probes
+ * @details   Per-thread lock-free rings of timed events which are exported
+ *            to the Chrome trace format for offline analysis.
+ * @version   1.0
+ * @copyright Copyright (c) 2018, dtuchscherer.
+ *            All rights reserved.
+ *
+ *            Redistributions and use in source and binary forms, with
+ *            or without modifications, are permitted provided that the
+ *            following conditions are met: Redistributions of source code must
+ *            retain the above copyright notice, this list of conditions and the
+ *            following disclaimer.
+ *
+ *            Redistributions in binary form must reproduce the above copyright
+ *            notice, this list of conditions and the following disclaimer in
+ *            the documentation and/or other materials provided with the
+ *            distribution.
+ *
+ *            Neither the name of the Heilbronn University nor the name of its
+ *            contributors may be used to endorse or promote products derived
+ *            from this software without specific prior written permission.
+ *
+ *            THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS “AS IS”
+ *            AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ *            TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ *            PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE REGENTS
+ *            OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *            SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *            LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *            USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *            AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *            LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *            ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *            POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#ifdef __unix__
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <sys/syscall.h> // thread id of the trace viewer
+#include <time.h>
+#include <unistd.h>
+
+// Read the time stamp counter on x86, it takes a few cycles only. Define
+// BSW_TRACE_MONOTONIC_CLOCK on CPUs without an invariant TSC.
+#if (defined(__x86_64__) || defined(__i386__)) &&                             \
+    !defined(BSW_TRACE_MONOTONIC_CLOCK)
+#include <x86intrin.h>
+#define BSW_TRACE_TSC
+#endif
+
+/// maximum number of threads that record events.
+#ifndef BSW_TRACE_THREADS
+#define BSW_TRACE_THREADS 16
+#endif
+
+/// events kept per thread, the oldest ones are overwritten.
+#ifndef BSW_TRACE_EVENTS
+#define BSW_TRACE_EVENTS 4096
+#endif
+
+/**
+ * @brief A completed scope: the name and the clock ticks of entry and exit.
+ * @remark The name must be a string literal, only the pointer is stored.
+ */
+struct TraceEvent
+{
+    const char* name;
+    std::uint64_t begin;
+    std::uint64_t end;
+};
+
+/**
+ * @brief Cheap timestamps for the probes.
+ * @details Ticks are TSC cycles on x86 and nanoseconds of CLOCK_MONOTONIC_RAW
+ * otherwise. The dumper translates them to nanoseconds.
+ */
+class TraceClock
+{
+  public:
+    /**
+     * @brief Reads the trace clock.
+     * @return the current ticks.
+     */
+    static std::uint64_t now() noexcept
+    {
+#ifdef BSW_TRACE_TSC
+        return __rdtsc();
+#else
+        return monotonic_ns();
+#endif
+    }
+
+    /**
+     * @brief Reads the raw monotonic clock.
+     * @return nanoseconds since an arbitrary point in time.
+     */
+    static std::uint64_t monotonic_ns() noexcept
+    {
+        struct timespec t;
+#ifdef CLOCK_MONOTONIC_RAW
+        clock_gettime(CLOCK_MONOTONIC_RAW, &t);
+#else
+        clock_gettime(CLOCK_MONOTONIC, &t);
+#endif
+        return (static_cast< std::uint64_t >(t.tv_sec) * 1000000000ULL) +
+               static_cast< std::uint64_t >(t.tv_nsec);
+    }
+};
+
+/**
+ * @brief Ring of the latest events of one thread.
+ * @details Only the owning thread records, without locks or read-modify-write
+ * operations. A dumper may read concurrently: every slot carries a sequence
+ * which is odd while the slot is written, events that were written or
+ * overwritten while reading are detected by it and left out.
+ * @tparam Capacity number of events, a power of two.
+ */
+template < std::size_t Capacity > class TraceRing
+{
+    static_assert((Capacity > 0U) && ((Capacity & (Capacity - 1U)) == 0U),
+                  "The capacity must be a power of two.");
+
+  public:
+    TraceRing() noexcept = default;
+
+    /**
+     * @brief Stores an event, overwriting the oldest if the ring is full.
+     * @param[in] name the name of the scope, a string literal.
+     * @param[in] begin ticks at entry.
+     * @param[in] end ticks at exit.
+     */
+    void record(const char* name, const std::uint64_t begin,
+                const std::uint64_t end) noexcept
+    {
+        const auto head = m_head.load(std::memory_order_relaxed);
+        Slot& slot = m_slots[head & (Capacity - 1U)];
+        slot.sequence.store((2U * head) + 1U, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.name.store(name, std::memory_order_relaxed);
+        slot.begin.store(begin, std::memory_order_relaxed);
+        slot.end.store(end, std::memory_order_relaxed);
+        slot.sequence.store(complete(head), std::memory_order_release);
+        m_head.store(head + 1U, std::memory_order_release);
+    }
+
+    /**
+     * @brief Calls f(const TraceEvent&) for the retained events, oldest first.
+     */
+    template < typename F > void for_each(F&& f) const noexcept
+    {
+        const auto head = m_head.load(std::memory_order_acquire);
+        const auto first = (head > Capacity) ? (head - Capacity) : 0U;
+
+        for (auto i = first; i < head; ++i)
+        {
+            const Slot& slot = m_slots[i & (Capacity - 1U)];
+            const auto before = slot.sequence.load(std::memory_order_acquire);
+            const TraceEvent event{slot.name.load(std::memory_order_relaxed),
+                                   slot.begin.load(std::memory_order_relaxed),
+                                   slot.end.load(std::memory_order_relaxed)};
+            std::atomic_thread_fence(std::memory_order_acquire);
+            const auto after = slot.sequence.load(std::memory_order_relaxed);
+
+            // the writer may have started to overwrite this slot before or
+            // while it was read.
+            if ((before == complete(i)) && (after == before))
+            {
+                f(event);
+            }
+        }
+    }
+
+    /**
+     * @brief The number of events recorded since the start, including the
+     * overwritten ones.
+     */
+    std::uint64_t recorded() const noexcept
+    {
+        return m_head.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief The id of the thread that owns this ring.
+     */
+    long thread_id() const noexcept { return m_thread_id; }
+
+    void set_thread_id(const long id) noexcept { m_thread_id = id; }
+
+  private:
+    /**
+     * @brief The sequence of a slot once the event with the given index is
+     * written completely, odd values mark a slot being written.
+     */
+    static constexpr std::uint64_t complete(const std::uint64_t index) noexcept
+    {
+        return (2U * index) + 2U;
+    }
+
+    struct Slot
+    {
+        std::atomic< std::uint64_t > sequence{0U};
+        std::atomic< const char* > name{nullptr};
+        std::atomic< std::uint64_t > begin{0U};
+        std::atomic< std::uint64_t > end{0U};
+    };
+
+    /// the events, indexed by the head modulo the capacity.
+    std::array< Slot, Capacity > m_slots;
+
+    /// index of the next event to write.
+    std::atomic< std::uint64_t > m_head{0U};
+
+    /// kernel thread id of the owner.
+    long m_thread_id{0};
+};
+
+/**
+ * @brief Global access to the per-thread rings and the Chrome trace dumper.
+ * @details Each thread claims one of BSW_TRACE_THREADS preallocated rings at
+ * its first event. Rings are never released, thus events of finished threads
+ * remain available for the dump. Threads beyond the limit are not traced.
+ */
+class Trace
+{
+  public:
+    using Ring = TraceRing< BSW_TRACE_EVENTS >;
+
+    /**
+     * @brief Records an event into the ring of the calling thread.
+     * @param[in] name the name of the scope, a string literal.
+     * @param[in] begin ticks at entry.
+     * @param[in] end ticks at exit.
+     */
+    static void record(const char* name, const std::uint64_t begin,
+                       const std::uint64_t end) noexcept
+    {
+        Ring* ring = thread_ring();
+
+        if (ring != nullptr)
+        {
+            ring->record(name, begin, end);
+        }
+    }
+
+    /**
+     * @brief The ring of the calling thread, claimed at the first call.
+     * @return the ring or nullptr if all rings are taken.
+     */
+    static Ring* thread_ring() noexcept
+    {
+        static thread_local Ring* ring = claim_ring();
+        return ring;
+    }
+
+    /**
+     * @brief The number of threads that recorded events so far.
+     */
+    static std::size_t thread_count() noexcept
+    {
+        const auto used = registry().used.load(std::memory_order_acquire);
+        return (used < BSW_TRACE_THREADS) ? used : BSW_TRACE_THREADS;
+    }
+
+    /**
+     * @brief Writes all retained events as JSON in the Chrome trace event
+     * format, which is read by chrome://tracing and ui.perfetto.dev.
+     * @details May be called at any time from any thread, e.g. on shutdown or
+     * after an outlier was detected. The probes are not stopped meanwhile.
+     * @param[in] path the file to write.
+     * @return true if the file was written completely.
+     */
+    static bool dump_chrome(const char* path) noexcept
+    {
+        std::FILE* file = std::fopen(path, "w");
+        bool written = false;
+
+        if (file != nullptr)
+        {
+            write_chrome(file);
+            written = (std::ferror(file) == 0);
+            written = (std::fclose(file) == 0) && written;
+        }
+
+        return written;
+    }
+
+  private:
+    /**
+     * @brief Writes the JSON document of dump_chrome().
+     */
+    static void write_chrome(std::FILE* file) noexcept
+    {
+        Registry& reg = registry();
+        const double ns_per_tick = reg.ns_per_tick();
+        const long pid = static_cast< long >(getpid());
+        bool first = true;
+        std::fputs("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", file);
+
+        for (std::size_t i = 0U; i < thread_count(); ++i)
+        {
+            const Ring& ring = reg.rings[i];
+            ring.for_each([&](const TraceEvent& event) {
+                const double ts = reg.to_us(event.begin, ns_per_tick);
+                const double dur =
+                    (static_cast< double >(event.end - event.begin) *
+                     ns_per_tick) /
+                    1000.0;
+                std::fprintf(file,
+                             "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,"
+                             "\"dur\":%.3f,\"pid\":%ld,\"tid\":%ld}",
+                             first ? "" : ",", event.name, ts, dur, pid,
+                             ring.thread_id());
+                first = false;
+            });
+        }
+
+        std::fputs("\n]}\n", file);
+    }
+
+    /**
+     * @brief The rings and the reference point to convert ticks.
+     */
+    struct Registry
+    {
+        Registry() noexcept
+            : used{0U}, tick0{TraceClock::now()},
+              ns0{TraceClock::monotonic_ns()}
+        {
+        }
+
+        /// the slope between the trace clock and the monotonic clock.
+        double ns_per_tick() const noexcept
+        {
+#ifdef BSW_TRACE_TSC
+            const auto ticks = TraceClock::now() - tick0;
+            const auto ns = TraceClock::monotonic_ns() - ns0;
+            return (ticks > 0U) ? (static_cast< double >(ns) /
+                                   static_cast< double >(ticks))
+                                : 1.0;
+#else
+            return 1.0;
+#endif
+        }
+
+        /// ticks to microseconds of the monotonic clock.
+        double to_us(const std::uint64_t ticks, const double ns_per_tick) const
+            noexcept
+        {
+            const double delta =
+                (ticks >= tick0) ? static_cast< double >(ticks - tick0)
+                                 : -static_cast< double >(tick0 - ticks);
+            return (static_cast< double >(ns0) + (delta * ns_per_tick)) /
+                   1000.0;
+        }
+
+        std::array< Ring, BSW_TRACE_THREADS > rings;
+        std::atomic< std::size_t > used;
+        std::uint64_t tick0;
+        std::uint64_t ns0;
+    };
+
+    static Registry& registry() noexcept
+    {
+        static Registry reg;
+        return reg;
+    }
+
+    static Ring* claim_ring() noexcept
+    {
+        Registry& reg = registry();
+        const auto index = reg.used.fetch_add(1U, std::memory_order_acq_rel);
+        Ring* ring = nullptr;
+
+        if (index < BSW_TRACE_THREADS)
+        {
+            ring = &reg.rings[index];
+            ring->set_thread_id(static_cast< long >(syscall(SYS_gettid)));
+        }
+
+        return ring;
+    }
+};
+
+/**
+ * @brief Records the time from construction to destruction as one event.
+ * @details Use BSW_TRACE_SCOPE, which compiles to nothing unless
+ * BSW_ENABLE_TRACING is defined.
+ */
+class TraceScope
+{
+  public:
+    explicit TraceScope(const char* name) noexcept
+        : m_name{name}, m_begin{TraceClock::now()}
+    {
+    }
+
+    ~TraceScope() noexcept { Trace::record(m_name, m_begin, TraceClock::now()); }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+  private:
+    const char* m_name;
+    std::uint64_t m_begin;
+};
+
+#endif /* __unix__ */
+
+#define BSW_TRACE_CONCAT_(a, b) a##b
+#define BSW_TRACE_CONCAT(a, b) BSW_TRACE_CONCAT_(a, b)
+
+#if defined(BSW_ENABLE_TRACING) && defined(__unix__)
+/// traces the enclosing scope under the given name (a string literal).
+#define BSW_TRACE_SCOPE(name)                                                  \
+    const TraceScope BSW_TRACE_CONCAT(bsw_trace_scope_, __LINE__) { name }
+#else
+#define BSW_TRACE_SCOPE(name) static_cast< void >(0)
+#endif
+
+#endif /* TRACE_H_ */
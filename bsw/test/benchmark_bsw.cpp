@@ -0,0 +1,337 @@
+#include "CanSocket.h"
+#include "Endianness.h"
+#include "Packet.h"
+#include "ShmChannel.h"
+#include "TcpClient.h"
+#include "TcpServer.h"
+#include <benchmark/benchmark.h>
+#include <net/if.h>
+#include <thread>
+#include <vector>
+
+// Run with --benchmark_format=json or --benchmark_out=<file> to get a
+// machine-readable report that can be compared between builds.
+
+/// CanSocket asserts on a missing interface, so check it up front.
+static bool has_vcan() noexcept { return if_nametoindex("vcan0") != 0U; }
+
+/// ports of the TCP benchmarks, apart from the functional tests.
+static constexpr std::uint16_t TCP_THROUGHPUT_PORT{5600U};
+static constexpr std::uint16_t TCP_LATENCY_PORT{5601U};
+
+template < typename T > static T bench_value() noexcept
+{
+    return static_cast< T >(0x5A);
+}
+
+template <> inline float bench_value< float >() noexcept { return 1.5F; }
+
+template <> inline double bench_value< double >() noexcept { return 2.5; }
+
+static void BM_PacketStreamOperators(benchmark::State& state)
+{
+    Packet< 15 > packet;
+    std::uint8_t u8{0x12U};
+    std::uint16_t u16{0x1234U};
+    std::uint32_t u32{0x12345678UL};
+    double f64{1.25};
+
+    for (auto _ : state)
+    {
+        packet.clear();
+        packet << u8 << u16 << u32 << f64;
+        packet >> u8 >> u16 >> u32 >> f64;
+        benchmark::DoNotOptimize(packet.get_data().data());
+        benchmark::ClobberMemory();
+    }
+
+    state.SetBytesProcessed(state.iterations() * 15);
+}
+BENCHMARK(BM_PacketStreamOperators);
+
+static void BM_PacketStorePeek(benchmark::State& state)
+{
+    Packet< 15 > packet;
+    std::uint8_t u8{0x12U};
+    std::uint16_t u16{0x1234U};
+    std::uint32_t u32{0x12345678UL};
+    double f64{1.25};
+
+    for (auto _ : state)
+    {
+        packet.store< std::uint8_t, 0 >(u8);
+        packet.store< std::uint16_t, 1 >(u16);
+        packet.store< std::uint32_t, 3 >(u32);
+        packet.store< double, 7 >(f64);
+        u8 = packet.peek< std::uint8_t, 0 >();
+        u16 = packet.peek< std::uint16_t, 1 >();
+        u32 = packet.peek< std::uint32_t, 3 >();
+        f64 = packet.peek< double, 7 >();
+        benchmark::DoNotOptimize(packet.get_data().data());
+        benchmark::ClobberMemory();
+    }
+
+    state.SetBytesProcessed(state.iterations() * 15);
+}
+BENCHMARK(BM_PacketStorePeek);
+
+static void BM_PacketStringField(benchmark::State& state)
+{
+    Packet< 64 > packet;
+    ByteSpan name{nullptr, 0U};
+
+    for (auto _ : state)
+    {
+        packet.clear();
+        packet.append_string("engine speed sensor front left", 30U);
+        packet.read_bytes(name);
+        benchmark::DoNotOptimize(name.data);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetBytesProcessed(state.iterations() * 34);
+}
+BENCHMARK(BM_PacketStringField);
+
+template < typename T > static void BM_SwapBytes(benchmark::State& state)
+{
+    T value = bench_value< T >();
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(value);
+        value = to_network(value);
+    }
+
+    benchmark::DoNotOptimize(value);
+    state.SetBytesProcessed(state.iterations() *
+                            static_cast< std::int64_t >(sizeof(T)));
+}
+BENCHMARK_TEMPLATE(BM_SwapBytes, std::uint16_t);
+BENCHMARK_TEMPLATE(BM_SwapBytes, std::int16_t);
+BENCHMARK_TEMPLATE(BM_SwapBytes, std::uint32_t);
+BENCHMARK_TEMPLATE(BM_SwapBytes, std::int32_t);
+BENCHMARK_TEMPLATE(BM_SwapBytes, std::uint64_t);
+BENCHMARK_TEMPLATE(BM_SwapBytes, std::int64_t);
+BENCHMARK_TEMPLATE(BM_SwapBytes, float);
+BENCHMARK_TEMPLATE(BM_SwapBytes, double);
+
+template < typename T > static void BM_SwapBytesBulk(benchmark::State& state)
+{
+    const auto count = static_cast< std::size_t >(state.range(0));
+    std::vector< T > values(count, bench_value< T >());
+    std::vector< std::uint8_t > bytes(count * sizeof(T));
+
+    for (auto _ : state)
+    {
+        to_network(values.data(), count, bytes.data());
+        benchmark::DoNotOptimize(bytes.data());
+        benchmark::ClobberMemory();
+    }
+
+    state.SetBytesProcessed(state.iterations() *
+                            static_cast< std::int64_t >(bytes.size()));
+}
+BENCHMARK_TEMPLATE(BM_SwapBytesBulk, std::uint16_t)->Arg(64)->Arg(4096);
+BENCHMARK_TEMPLATE(BM_SwapBytesBulk, std::uint32_t)->Arg(64)->Arg(4096);
+BENCHMARK_TEMPLATE(BM_SwapBytesBulk, double)->Arg(64)->Arg(4096);
+
+static void BM_CanRoundTrip(benchmark::State& state)
+{
+    if (!has_vcan())
+    {
+        state.SkipWithError("CAN interface vcan0 is not available.");
+        return;
+    }
+
+    CanSocket tx{"vcan0"};
+    CanSocket rx{"vcan0"};
+
+    const CanFDData data{{0x01U, 0x02U, 0x03U, 0x04U}};
+    CanFDData received{};
+    CanIDType can_id{0U};
+
+    for (auto _ : state)
+    {
+        if ((tx.send(0x100U, data, 8U) <= 0) ||
+            (rx.receive(can_id, received) <= 0))
+        {
+            state.SkipWithError("CAN frame lost.");
+            break;
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_CanRoundTrip)->UseRealTime();
+
+static void BM_CanThroughput(benchmark::State& state)
+{
+    if (!has_vcan())
+    {
+        state.SkipWithError("CAN interface vcan0 is not available.");
+        return;
+    }
+
+    CanSocket tx{"vcan0"};
+
+    const CanFDData data{{0x01U, 0x02U, 0x03U, 0x04U}};
+
+    for (auto _ : state)
+    {
+        if (tx.send(0x100U, data, 64U) <= 0)
+        {
+            state.SkipWithError("CAN send failed.");
+            break;
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * 64);
+}
+BENCHMARK(BM_CanThroughput)->UseRealTime();
+
+static void BM_TcpThroughput(benchmark::State& state)
+{
+    TcpServer server;
+    server.reuse_addr();
+    TcpClient client;
+
+    if (!server.listen("127.0.0.1", TCP_THROUGHPUT_PORT) ||
+        !client.connect("127.0.0.1", TCP_THROUGHPUT_PORT) || !server.accept())
+    {
+        state.SkipWithError("TCP loopback connection failed.");
+        return;
+    }
+
+    const auto len = static_cast< std::uint16_t >(state.range(0));
+    std::vector< std::uint8_t > message(len, 0xA5U);
+    std::vector< std::uint8_t > buffer(len);
+
+    for (auto _ : state)
+    {
+        if (client.send(message.data(), len) != len)
+        {
+            state.SkipWithError("TCP send failed.");
+            break;
+        }
+
+        std::uint16_t received{0U};
+
+        while (received < len)
+        {
+            const auto nbytes =
+                server.m_data.receive(&buffer[received], len - received);
+
+            if (nbytes <= 0)
+            {
+                break;
+            }
+
+            received += static_cast< std::uint16_t >(nbytes);
+        }
+    }
+
+    state.SetBytesProcessed(state.iterations() * len);
+}
+BENCHMARK(BM_TcpThroughput)->Arg(64)->Arg(1024)->Arg(16384)->UseRealTime();
+
+static void BM_TcpLatency(benchmark::State& state)
+{
+    TcpServer server;
+    server.reuse_addr();
+    TcpClient client;
+
+    if (!server.listen("127.0.0.1", TCP_LATENCY_PORT) ||
+        !client.connect("127.0.0.1", TCP_LATENCY_PORT) || !server.accept())
+    {
+        state.SkipWithError("TCP loopback connection failed.");
+        return;
+    }
+
+    client.set_nodelay(true);
+    server.m_data.set_nodelay(true);
+
+    // the server echoes every message back to the client.
+    std::thread echo{[&server]() {
+        std::uint32_t message{0U};
+
+        while (server.m_data.receive(&message, sizeof(message)) > 0)
+        {
+            server.m_data.send(&message, sizeof(message));
+        }
+    }};
+
+    std::uint32_t message{0x12345678UL};
+
+    for (auto _ : state)
+    {
+        if ((client.send(&message, sizeof(message)) <= 0) ||
+            (client.receive(&message, sizeof(message)) <= 0))
+        {
+            state.SkipWithError("TCP echo lost.");
+            break;
+        }
+    }
+
+    client.disconnect();
+    echo.join();
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TcpLatency)->UseRealTime();
+
+static void BM_ShmChannelRoundTrip(benchmark::State& state)
+{
+    static constexpr char ping_name[] = "/bsw_bench_ping";
+    static constexpr char pong_name[] = "/bsw_bench_pong";
+    ShmPublisher< 64, 64 > ping{ping_name};
+    ShmPublisher< 64, 64 > pong{pong_name};
+    ShmSubscriber< 64, 64 > ping_rx{ping_name};
+    ShmSubscriber< 64, 64 > pong_rx{pong_name};
+
+    if (!ping_rx.is_open() || !pong_rx.is_open())
+    {
+        state.SkipWithError("Shared memory is not available.");
+        return;
+    }
+
+    // the peer echoes every message back, both sides sleep on the futex.
+    bool running{true};
+    std::thread echo{[&ping_rx, &pong, &running]() {
+        std::uint64_t message{0U};
+
+        while (__atomic_load_n(&running, __ATOMIC_RELAXED))
+        {
+            if (ping_rx.receive(&message, sizeof(message),
+                                std::chrono::milliseconds{10}) > 0)
+            {
+                pong.send(&message, sizeof(message));
+            }
+        }
+    }};
+
+    std::uint64_t message{0U};
+
+    for (auto _ : state)
+    {
+        ping.send(&message, sizeof(message));
+
+        if (pong_rx.receive(&message, sizeof(message),
+                            std::chrono::milliseconds{100}) <= 0)
+        {
+            state.SkipWithError("Shared memory echo lost.");
+            break;
+        }
+
+        ++message;
+    }
+
+    __atomic_store_n(&running, false, __ATOMIC_RELAXED);
+    echo.join();
+    ShmRegion::remove(ping_name);
+    ShmRegion::remove(pong_name);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ShmChannelRoundTrip)->UseRealTime();
+
+BENCHMARK_MAIN();
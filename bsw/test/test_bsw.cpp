@@ -1,6 +1,36 @@
+#include "CanBcmSocket.h"
+#include "CanGateway.h"
+#include "CanLogFile.h"
+#include "CanLogger.h"
+#include "CanReplay.h"
+#include "CanRxRing.h"
+#include "CanSignal.h"
 #include "CanSocket.h"
+#include "CyclicExecutive.h"
+#include "EventLoop.h"
+#include "FramedStream.h"
+#include "IsoTp.h"
+#include "IsoTpSocket.h"
+#include "ObjectPool.h"
+#include "OverrunPolicy.h"
+#include "PacketLayout.h"
+#include "PacketPool.h"
+#include "PacketView.h"
+#include "ShmChannel.h"
 #include "Socket.h"
+#include "SpscQueue.h"
+#include "TaskAttributes.h"
+#include "TaskStatistics.h"
+#include "TcpClient.h"
+#include "TcpMultiServer.h"
+#include "TcpServer.h"
+#include "UdpSocket.h"
+#include "Trace.h"
+#include <cstdio>
 #include <gtest/gtest.h>
+#include <sys/eventfd.h>
+#include <thread>
+#include <vector>
 
 TEST(Sockets, CreateSocket)
 {
@@ -52,6 +82,1818 @@ TEST(Sockets, SocketCanSendAndReceive)
     EXPECT_TRUE(can1.set_blocking(true));
 }
 
+TEST(Sockets, SocketCanReceiveBatch)
+{
+    CanSocket can{"vcan0"};
+    CanSocket can1{"vcan0"};
+    EXPECT_TRUE(can1.set_blocking(false));
+
+    for (std::uint8_t i = 0U; i < 3U; ++i)
+    {
+        const auto sent = can.send(0x10U + i, CanFDData{i}, 1U);
+        EXPECT_EQ(sent, 72);
+    }
+
+    {
+        std::array< CanFrame, 8U > frames;
+        const auto nframes = can1.receive_batch(frames);
+        EXPECT_EQ(nframes, 3);
+        EXPECT_EQ(frames[0].can_id, 0x10U);
+        EXPECT_EQ(frames[2].can_id, 0x12U);
+        EXPECT_EQ(frames[2].data[0], 2U);
+    }
+    {
+        std::array< CanFrame, 8U > frames;
+        const auto nframes = can1.receive_batch(frames);
+        EXPECT_EQ(nframes, -1);
+        EXPECT_EQ(can1.get_last_error(), EAGAIN);
+    }
+    {
+        using namespace std::chrono_literals;
+        std::array< CanFrame, 8U > frames;
+        const auto nframes = can1.receive_batch(frames, 10ms);
+        EXPECT_EQ(nframes, 0);
+    }
+
+    EXPECT_TRUE(can1.set_blocking(true));
+}
+
+TEST(Sockets, SocketCanSendBatch)
+{
+    CanSocket can{"vcan0"};
+    CanSocket can1{"vcan0"};
+    EXPECT_TRUE(can1.set_blocking(false));
+
+    CanTxBatch< 4U > batch;
+    EXPECT_TRUE(batch.push(0x20U, CanStdData{0x01U}, 1U));
+    EXPECT_TRUE(batch.push(0x21U, CanFDData{0x02U, 0x03U}, 2U));
+    CanFrame* frame = batch.stage(false);
+    ASSERT_NE(frame, nullptr);
+    frame->can_id = 0x22U;
+    frame->len = 0U;
+    EXPECT_EQ(batch.pending(), 3U);
+
+    const auto sent = can.send_batch(batch);
+    EXPECT_EQ(sent, 3);
+    EXPECT_TRUE(batch.empty());
+
+    std::array< CanFrame, 8U > frames;
+    const auto nframes = can1.receive_batch(frames);
+    EXPECT_EQ(nframes, 3);
+    EXPECT_EQ(frames[1].can_id, 0x21U);
+    EXPECT_EQ(frames[1].len, 2U);
+
+    EXPECT_TRUE(can1.set_blocking(true));
+}
+
+TEST(Sockets, CanTxBatchPartialSend)
+{
+    CanTxBatch< 3U > batch;
+    EXPECT_TRUE(batch.push(0x20U, CanStdData{0x01U}, 1U));
+    EXPECT_TRUE(batch.push(0x21U, CanFDData{0x02U}, 1U));
+    EXPECT_TRUE(batch.push(0x22U, CanStdData{0x03U}, 1U));
+    EXPECT_TRUE(batch.full());
+
+    // the kernel accepted one frame, its slot is free again
+    batch.consume(1U);
+    EXPECT_EQ(batch.pending(), 2U);
+    EXPECT_FALSE(batch.full());
+    EXPECT_EQ(batch.pending_messages()[0].msg_hdr.msg_iov->iov_len, CANFD_MTU);
+    EXPECT_EQ(static_cast< CanFrame* >(
+                  batch.pending_messages()[0].msg_hdr.msg_iov->iov_base)
+                  ->can_id,
+              0x21U);
+    EXPECT_TRUE(batch.push(0x23U, CanStdData{0x04U}, 1U));
+    EXPECT_TRUE(batch.full());
+    batch.consume(3U);
+    EXPECT_TRUE(batch.empty());
+}
+
+TEST(Sockets, SocketCanFilter)
+{
+    CanSocket can{"vcan0"};
+    CanSocket can1{"vcan0"};
+    static constexpr std::array< CanFilter, 2U > filters{
+        {make_can_filter(0x30U, CAN_SFF_MASK),
+         make_can_filter(0x40U, CAN_SFF_MASK)}};
+    EXPECT_TRUE(can1.set_filters(filters));
+    EXPECT_TRUE(can1.set_error_filter(CAN_ERR_MASK));
+    EXPECT_TRUE(can1.set_blocking(false));
+
+    can.send(0x30U, CanStdData{0x00U}, 1U);
+    can.send(0x31U, CanStdData{0x00U}, 1U);
+    can.send(0x40U, CanStdData{0x00U}, 1U);
+
+    std::array< CanFrame, 8U > frames;
+    const auto nframes = can1.receive_batch(frames);
+    EXPECT_EQ(nframes, 2);
+    EXPECT_EQ(frames[0].can_id, 0x30U);
+    EXPECT_EQ(frames[1].can_id, 0x40U);
+
+    EXPECT_TRUE(can1.reject_all());
+    can.send(0x30U, CanStdData{0x00U}, 1U);
+    EXPECT_EQ(can1.receive_batch(frames), -1);
+    EXPECT_TRUE(can1.set_blocking(true));
+}
+
+TEST(Sockets, SocketCanTimestamps)
+{
+    CanSocket can{"vcan0"};
+    CanSocket can1{"vcan0"};
+    EXPECT_TRUE(can1.enable_timestamps());
+    EXPECT_TRUE(can1.set_blocking(false));
+
+    struct timespec before;
+    clock_gettime(CLOCK_REALTIME, &before);
+
+    for (std::uint8_t i = 0U; i < 2U; ++i)
+    {
+        EXPECT_EQ(can.send(0x20U + i, CanFDData{i}, 1U), 72);
+    }
+
+    CanIDType can_id{0U};
+    CanFDData data{};
+    RxTimestamp stamp;
+    EXPECT_EQ(can1.receive(can_id, data, stamp), 1);
+    EXPECT_EQ(can_id, 0x20U);
+    EXPECT_GE(stamp.tv_sec, before.tv_sec);
+
+    std::array< CanFrame, 4U > frames;
+    std::array< RxTimestamp, 4U > stamps{};
+    EXPECT_EQ(can1.receive_batch(frames, stamps), 1);
+    EXPECT_EQ(frames[0].can_id, 0x21U);
+    EXPECT_GE(stamps[0].tv_sec, stamp.tv_sec);
+}
+
+TEST(Sockets, IsoTpSocketTransfer)
+{
+    IsoTpSocket tester{"vcan0", make_isotp_config(0x7E0U, 0x7E8U)};
+    IsoTpSocket ecu{"vcan0", make_isotp_config(0x7E8U, 0x7E0U, 8U, 0U)};
+    ASSERT_TRUE(tester.is_isotp_initialized());
+    ASSERT_TRUE(ecu.is_isotp_initialized());
+
+    Packet< 1024U > tx;
+    Packet< 1024U > rx;
+    tx.get_data().fill(0x5AU);
+    EXPECT_EQ(tester.send(tx, 1000U), 1000);
+
+    using namespace std::chrono_literals;
+    EXPECT_EQ(ecu.receive(rx, 1000ms), 1000);
+    EXPECT_EQ(rx.get_data()[999], 0x5AU);
+}
+
+TEST(Sockets, CanBcmCyclicAndChanges)
+{
+    using namespace std::chrono_literals;
+    CanBcmSocket sender{"vcan0"};
+    CanBcmSocket receiver{"vcan0"};
+    ASSERT_TRUE(sender.is_bcm_initialized());
+    ASSERT_TRUE(receiver.is_bcm_initialized());
+
+    // only the first byte is relevant for the receiver.
+    ASSERT_TRUE(receiver.watch(0x300U, CanStdData{0xFFU}, 8U));
+    ASSERT_TRUE(sender.start_cyclic(0x300U, CanStdData{0x01U, 0x02U}, 8U, 5ms));
+
+    CanIDType can_id{0U};
+    CanFDData data{};
+    BcmEvent event{BcmEvent::OTHER};
+    EXPECT_EQ(receiver.receive(can_id, data, event, 100ms), 8);
+    EXPECT_EQ(event, BcmEvent::CHANGED);
+    EXPECT_EQ(can_id, 0x300U);
+    EXPECT_EQ(data[0], 0x01U);
+
+    // repetitions and changes of irrelevant bits wake nobody up.
+    EXPECT_TRUE(sender.update_cyclic(0x300U, CanStdData{0x01U, 0x03U}, 8U));
+    EXPECT_EQ(receiver.receive(can_id, data, event, 30ms), 0);
+
+    EXPECT_TRUE(sender.update_cyclic(0x300U, CanStdData{0x04U}, 8U));
+    EXPECT_EQ(receiver.receive(can_id, data, event, 100ms), 8);
+    EXPECT_EQ(data[0], 0x04U);
+
+    EXPECT_TRUE(sender.stop_cyclic(0x300U));
+    EXPECT_TRUE(receiver.unwatch(0x300U));
+
+    // the sender is told when a counted transmission has finished.
+    ASSERT_TRUE(sender.start_counted(0x301U, CanStdData{0x05U}, 1U, 3U, 1ms));
+    event = BcmEvent::OTHER;
+    EXPECT_EQ(sender.receive(can_id, data, event, 100ms), 0);
+    EXPECT_EQ(event, BcmEvent::EXPIRED);
+    EXPECT_EQ(can_id, 0x301U);
+}
+
+TEST(Sockets, CanRxRingZeroCopy)
+{
+    CanRxRing ring{"vcan0", 4U, 1U};
+    ASSERT_TRUE(ring.is_ring_initialized());
+    CanSocket can{"vcan0"};
+
+    for (std::uint8_t i = 0U; i < 3U; ++i)
+    {
+        EXPECT_EQ(can.send(0x123U, CanFDData{{i}}, 8U), 72);
+    }
+
+    using namespace std::chrono_literals;
+    ASSERT_TRUE(ring.wait_for(1000ms));
+    std::vector< std::uint8_t > first_bytes;
+    const auto frames = ring.for_each([&first_bytes](const CanRxFrame& rx) {
+        EXPECT_EQ(rx.can_id(), 0x123U);
+        EXPECT_TRUE(rx.is_fd());
+        EXPECT_NE(rx.stamp.tv_sec, 0);
+        first_bytes.push_back(rx.data()[0]);
+    });
+    EXPECT_EQ(frames, 3U);
+    ASSERT_EQ(first_bytes.size(), 3U);
+    EXPECT_EQ(first_bytes[2], 2U);
+    EXPECT_EQ(ring.drops(), 0U);
+}
+
+TEST(CanLog, FileRotationAndReader)
+{
+    const char* prefix = "/tmp/bsw_canlog_test";
+    {
+        // 5 records into files of 2 records, rotating through 2 files.
+        CanLogFile file{prefix, 2U, 2U};
+        ASSERT_TRUE(file.is_open());
+        CanLogRecord record{};
+
+        for (std::uint32_t i = 0U; i < 5U; ++i)
+        {
+            record.timestamp_ns = 1000U + i;
+            record.can_id = 0x100U + i;
+            record.len = 1U;
+            record.data[0] = static_cast< std::uint8_t >(i);
+            EXPECT_TRUE(file.append(record));
+            file.flush();
+        }
+
+        EXPECT_EQ(file.records(), 5U);
+        EXPECT_EQ(file.sequence(), 2U);
+    }
+
+    std::array< char, 64U > path;
+    // file 0 was overwritten by file 2 holding the last record.
+    ASSERT_TRUE(CanLogFile::file_name(path.data(), path.size(), prefix, 0U));
+    {
+        CanLogReader reader{path.data()};
+        ASSERT_TRUE(reader.is_open());
+        EXPECT_EQ(reader.header()->sequence, 2U);
+        ASSERT_EQ(reader.size(), 1U);
+        EXPECT_EQ(reader.begin()->can_id, 0x104U);
+    }
+    std::remove(path.data());
+
+    ASSERT_TRUE(CanLogFile::file_name(path.data(), path.size(), prefix, 1U));
+    {
+        CanLogReader reader{path.data()};
+        ASSERT_EQ(reader.size(), 2U);
+        std::uint8_t expected{2U};
+        for (const auto& record : reader)
+        {
+            EXPECT_EQ(record.data[0], expected++);
+        }
+    }
+    std::remove(path.data());
+
+    CanLogReader missing{"/tmp/bsw_canlog_missing.canlog"};
+    EXPECT_FALSE(missing.is_open());
+    EXPECT_EQ(missing.size(), 0U);
+}
+
+TEST(CanLog, LoggerPipeline)
+{
+    const char* prefix = "/tmp/bsw_canlogger_test";
+    CanSocket rx{"vcan0"};
+    CanSocket tx{"vcan0"};
+    EXPECT_TRUE(rx.enable_timestamps());
+    CanLogFile file{prefix, 1024U};
+    CanLogger< 1U, 64U > logger{file};
+
+    for (std::uint8_t i = 0U; i < 10U; ++i)
+    {
+        tx.send(0x200U + i, CanStdData{{i}}, 1U);
+    }
+
+    using namespace std::chrono_literals;
+    std::int16_t received{0};
+    while (received < 10)
+    {
+        const auto frames = logger.receive(0U, rx, 100ms);
+        ASSERT_GT(frames, 0);
+        received += frames;
+    }
+
+    EXPECT_EQ(logger.write(), 10U);
+    EXPECT_EQ(logger.dropped(0U), 0U);
+    EXPECT_EQ(file.records(), 10U);
+
+    std::array< char, 64U > path;
+    ASSERT_TRUE(CanLogFile::file_name(path.data(), path.size(), prefix, 0U));
+    CanLogReader reader{path.data()};
+    ASSERT_EQ(reader.size(), 10U);
+    EXPECT_EQ(reader.begin()[9].can_id, 0x209U);
+    EXPECT_EQ(reader.begin()[9].flags & CAN_LOG_FD, 0U);
+    EXPECT_GT(reader.begin()[0].timestamp_ns, 0U);
+    std::remove(path.data());
+}
+
+TEST(CanLog, ReplayTiming)
+{
+    // 20 frames recorded 1 ms apart, every second pair shares a timestamp.
+    std::array< CanLogRecord, 20U > records{};
+    for (std::uint32_t i = 0U; i < records.size(); ++i)
+    {
+        records[i].timestamp_ns = 5000000000ULL + ((i / 2U) * 1000000ULL);
+        records[i].can_id = 0x300U + i;
+        records[i].len = 8U;
+        records[i].data[0] = static_cast< std::uint8_t >(i);
+    }
+
+    CanSocket tx{"vcan0"};
+    CanSocket rx{"vcan0"};
+    CanReplay replay{tx};
+    replay.set_speed(10.0);
+
+    const auto start = std::chrono::steady_clock::now();
+    ASSERT_TRUE(replay.play(records.data(), records.data() + records.size()));
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    // 9 ms recorded are replayed in 0.9 ms after a lead of 1 ms.
+    EXPECT_LT(elapsed, std::chrono::milliseconds{20});
+    EXPECT_EQ(replay.frames_sent(), 20U);
+    EXPECT_EQ(replay.batches_sent(), 10U);
+    EXPECT_EQ(replay.lateness().count(), 20U);
+
+    std::array< CanFrame, 32U > frames;
+    using namespace std::chrono_literals;
+    EXPECT_EQ(rx.receive_batch(frames, 100ms), 20);
+    EXPECT_EQ(frames[19].can_id, 0x313U);
+
+    replay.set_speed(CanReplay::AS_FAST_AS_POSSIBLE);
+    replay.set_channel(1);
+    EXPECT_TRUE(replay.play(records.data(), records.data() + records.size()));
+    EXPECT_EQ(replay.frames_sent(), 0U);
+}
+
+TEST(CanLog, ReplayZeroBucket)
+{
+    std::array< CanLogRecord, 4U > records{};
+    for (std::uint32_t i = 0U; i < records.size(); ++i)
+    {
+        records[i].timestamp_ns = 5000000000ULL + ((i / 2U) * 100000ULL);
+        records[i].can_id = 0x400U + i;
+        records[i].len = 1U;
+    }
+
+    CanSocket tx{"vcan0"};
+    CanSocket rx{"vcan0"};
+    // a bucket of 0 still sends the frames of each release time together.
+    CanReplay replay{tx, 0};
+    ASSERT_TRUE(replay.play(records.data(), records.data() + records.size()));
+    EXPECT_EQ(replay.frames_sent(), 4U);
+    EXPECT_EQ(replay.batches_sent(), 2U);
+
+    std::array< CanFrame, 8U > frames;
+    using namespace std::chrono_literals;
+    EXPECT_EQ(rx.receive_batch(frames, 100ms), 4);
+}
+
+TEST(CanGateway, RoutingTableLookup)
+{
+    static constexpr std::array< CanRoute, 5 > routes{{
+        make_route(0U, 1U, 0x100U), make_route(0U, 2U, 0x100U).remap(0x180U),
+        make_route(0U, 1U, 0x200U, 0x700U),
+        make_route(1U, 0U, 0x12345678U | CAN_EFF_FLAG)
+            .remap(0x00000078U, 0xFFU),
+        make_route(2U, 0U, 0x300U).offload()}};
+    CanRoutingTable< 3, 5 > table{routes};
+
+    // 0x100 fans out to bus 1 unchanged and to bus 2 remapped.
+    std::array< CanIDType, 2 > sent{};
+    std::size_t count{0U};
+    EXPECT_EQ(table.for_each(0U, 0x100U,
+                             [&sent, &count](const CanRoute& route) {
+                                 sent[count++] = route.apply(0x100U);
+                             }),
+              2U);
+    EXPECT_EQ(sent[0], 0x100U);
+    EXPECT_EQ(sent[1], 0x180U);
+
+    const auto none = [](const CanRoute&) {};
+    // a masked route matches the whole range, only on its bus.
+    EXPECT_EQ(table.for_each(0U, 0x2FFU, none), 1U);
+    EXPECT_EQ(table.for_each(1U, 0x2FFU, none), 0U);
+    // the format and the remote request flag are part of an exact match.
+    EXPECT_EQ(table.for_each(0U, 0x100U | CAN_RTR_FLAG, none), 0U);
+    EXPECT_EQ(table.for_each(1U, 0x12345678U, none), 0U);
+
+    CanIDType rewritten{0U};
+    EXPECT_EQ(table.for_each(1U, 0x12345678U | CAN_EFF_FLAG,
+                             [&rewritten](const CanRoute& route) {
+                                 rewritten = route.apply(0x12345699U |
+                                                         CAN_EFF_FLAG);
+                             }),
+              1U);
+    EXPECT_EQ(rewritten, 0x12345678U | CAN_EFF_FLAG);
+
+    // offloaded routes are left to the kernel.
+    EXPECT_EQ(table.for_each(2U, 0x300U, none), 0U);
+    EXPECT_EQ(table.for_each(3U, 0x100U, none), 0U);
+}
+
+TEST(CanGateway, ForwardBatch)
+{
+    // bus 0 and bus 1 share vcan0: forwarded frames are seen by the reader.
+    static constexpr std::array< CanRoute, 1 > routes{
+        {make_route(0U, 1U, 0x400U, 0x7F0U).remap(0x500U, 0x700U)}};
+    CanSocket bus0{"vcan0"};
+    CanSocket bus1{"vcan0"};
+    CanSocket tx{"vcan0"};
+    CanSocket rx{"vcan0"};
+    CanGateway< 2, 1 > gateway{routes, {{&bus0, &bus1}}};
+    EventLoop< 2 > loop;
+    ASSERT_TRUE(gateway.attach(loop));
+
+    const CanStdData data{{0x01U, 0x02U}};
+    for (CanIDType id = 0x400U; id < 0x410U; ++id)
+    {
+        ASSERT_EQ(tx.send(id, data, 2U), 2);
+    }
+
+    ASSERT_EQ(tx.send(0x600U, data, 2U), 2);
+
+    using namespace std::chrono_literals;
+    gateway.run_once(loop, 100ms);
+    EXPECT_EQ(gateway.forwarded(), 16U);
+    EXPECT_EQ(gateway.dropped(), 0U);
+    // bus 1 also reads what the gateway itself sends on vcan0.
+    EXPECT_GE(gateway.unrouted(), 1U);
+
+    std::array< CanFrame, 64U > frames;
+    const auto received = rx.receive_batch(frames, 100ms);
+    ASSERT_GE(received, 33);
+    EXPECT_EQ(frames[17].can_id, 0x500U);
+    EXPECT_EQ(frames[32].can_id, 0x50FU);
+}
+
+TEST(Packet, ViewOverExternalBuffer)
+{
+    CanFrame frame{};
+    PacketView< 16 > writer{frame.data};
+    const std::uint16_t counter{0x1234U};
+    const float speed{2.5F};
+    writer << counter << speed << true;
+    writer.store< std::uint32_t, 8 >(0xDEADBEEFU);
+    // the bytes land directly in the frame in network-byte-order.
+    EXPECT_EQ(frame.data[0], 0x12U);
+    EXPECT_EQ(frame.data[1], 0x34U);
+    EXPECT_EQ(frame.data[6], 0x01U);
+    EXPECT_EQ(frame.data[8], 0xDEU);
+
+    const CanFrame& received = frame;
+    ConstPacketView< 16 > reader{received.data};
+    std::uint16_t counter_out{0U};
+    float speed_out{0.0F};
+    bool flag{false};
+    reader >> counter_out >> speed_out >> flag;
+    EXPECT_EQ(counter_out, counter);
+    EXPECT_FLOAT_EQ(speed_out, speed);
+    EXPECT_TRUE(flag);
+    EXPECT_EQ((reader.peek< std::uint32_t, 8 >()), 0xDEADBEEFU);
+    EXPECT_EQ(reader.data(), &frame.data[0]);
+    EXPECT_FALSE(reader.skip(10U));
+
+    // a view renders the same bytes as a Packet.
+    Packet< 16 > packet;
+    std::uint16_t counter_in{counter};
+    float speed_in{speed};
+    packet << counter_in << speed_in;
+    EXPECT_EQ(std::memcmp(packet.get_data().data(), frame.data, 6U), 0);
+
+    ConstPacketView< 16 > from_packet{packet};
+    EXPECT_EQ((from_packet.peek< std::uint16_t, 0 >()), counter);
+    ConstPacketView< 16 > from_writer{writer};
+    EXPECT_EQ(from_writer.data(), &frame.data[0]);
+}
+
+TEST(Packet, LayoutOverView)
+{
+    using Telemetry =
+        Layout< Field< std::uint16_t, 0 >, Field< float, 2 >,
+                Field< std::int8_t, 6 > >;
+    std::array< std::uint8_t, 64 > slot{};
+    Telemetry::encode(PacketView< 8 >{slot}, 0xBEEFU, 1.25F, -7);
+    EXPECT_EQ(slot[0], 0xBEU);
+
+    std::uint16_t id{0U};
+    float value{0.0F};
+    std::int8_t offset{0};
+    Telemetry::decode(ConstPacketView< 8 >{slot}, id, value, offset);
+    EXPECT_EQ(id, 0xBEEFU);
+    EXPECT_FLOAT_EQ(value, 1.25F);
+    EXPECT_EQ(offset, -7);
+
+    const auto values = Telemetry::decode(ConstPacketView< 7 >{slot.data()});
+    EXPECT_EQ(std::get< 0 >(values), 0xBEEFU);
+}
+
+TEST(Packet, LengthPrefixedFields)
+{
+    Packet< 32 > packet;
+    const std::array< std::uint8_t, 3 > blob{{0x01U, 0x00U, 0xFFU}};
+    EXPECT_TRUE(packet.append_string("hello", 5U));
+    EXPECT_TRUE(packet.append_bytes(blob));
+    EXPECT_TRUE(packet.append_string("", 0U));
+    EXPECT_EQ(packet.get_data()[3], 5U);
+    EXPECT_EQ(packet.get_data()[4], 'h');
+    EXPECT_EQ(packet.get_data()[9], 0U);
+    EXPECT_EQ(packet.get_data()[12], 3U);
+
+    // 4 + 5 + 4 + 3 + 4 bytes are used, a 10 byte blob exceeds the packet
+    const char large[] = "0123456789";
+    EXPECT_FALSE(packet.append_bytes(large, 10U));
+
+    ByteSpan text{nullptr, 0U};
+    ASSERT_TRUE(packet.read_bytes(text));
+    EXPECT_EQ(text.data, &packet.get_data()[4]);
+    EXPECT_EQ(std::string(text.chars(), text.size), "hello");
+
+    char small[3];
+    EXPECT_FALSE(packet.read_string(small));
+    char buffer[4];
+    EXPECT_TRUE(packet.read_string(buffer));
+    EXPECT_EQ(std::memcmp(buffer, blob.data(), 3U), 0);
+    EXPECT_EQ(buffer[3], '\0');
+    ASSERT_TRUE(packet.read_bytes(text));
+    EXPECT_EQ(text.size, 0U);
+
+    // the stream operators share the format
+    Packet< 16 > stream;
+    stream << "abc";
+    ConstPacketView< 16 > view{stream};
+    ASSERT_TRUE(view.read_bytes(text));
+    EXPECT_EQ(text.data, &stream.get_data()[4]);
+    EXPECT_EQ(std::string(text.chars(), text.size), "abc");
+    // the view writes from the start of the buffer
+    PacketView< 16 > writer{stream};
+    EXPECT_TRUE(writer.append_string("de", 2U));
+    stream >> buffer;
+    EXPECT_STREQ(buffer, "de");
+}
+
+TEST(Packet, LengthPrefixFromWireDoesNotWrap)
+{
+    // a prefix near the 32 bit maximum must not wrap the bounds check
+    std::array< std::uint8_t, 8 > raw{{0xFFU, 0xFFU, 0xFFU, 0xFDU}};
+    ConstPacketView< 8 > view{raw.data()};
+    ByteSpan span{nullptr, 0U};
+    EXPECT_FALSE(view.read_bytes(span));
+    char buffer[8];
+    EXPECT_FALSE(view.read_string(buffer));
+
+    // the prefix alone does not fit behind the last bytes
+    PacketView< 8 > writer{raw.data()};
+    EXPECT_TRUE(writer.append_bytes(nullptr, 0U));
+    EXPECT_FALSE(writer.append_bytes(raw.data(), 1U));
+    EXPECT_TRUE(writer.append_bytes(nullptr, 0U));
+    EXPECT_FALSE(writer.append_bytes(nullptr, 0U));
+}
+
+TEST(Packet, LayoutEncodeDecode)
+{
+    using Telemetry =
+        Layout< Field< std::uint16_t, 0 >, Field< float, 2 >,
+                Field< std::int8_t, 6 >, Field< std::uint32_t, 7 > >;
+    static_assert(Telemetry::size == 11U, "Layout size mismatch.");
+
+    Packet< 16 > packet;
+    Telemetry::encode(packet, 0x1234U, 1.5F, -3, 0xDEADBEEFU);
+    EXPECT_EQ(packet.get_data()[0], 0x12U);
+    EXPECT_EQ(packet.get_data()[1], 0x34U);
+    EXPECT_EQ(packet.get_data()[7], 0xDEU);
+
+    std::uint16_t counter{0U};
+    float speed{0.0F};
+    std::int8_t offset{0};
+    std::uint32_t flags{0U};
+    Telemetry::decode(packet, std::tie(counter, speed, offset, flags));
+    EXPECT_EQ(counter, 0x1234U);
+    EXPECT_FLOAT_EQ(speed, 1.5F);
+    EXPECT_EQ(offset, -3);
+    EXPECT_EQ(flags, 0xDEADBEEFU);
+
+    const auto values = Telemetry::decode(packet);
+    EXPECT_EQ(std::get< 0 >(values), 0x1234U);
+    EXPECT_EQ(std::get< 3 >(values), 0xDEADBEEFU);
+}
+
+TEST(Packet, BulkEndianness)
+{
+    // odd counts leave a scalar tail behind the vector loops
+    std::array< std::uint16_t, 37 > words{};
+    std::array< std::uint32_t, 19 > dwords{};
+    std::array< double, 11 > doubles{};
+    for (std::size_t i = 0U; i < words.size(); ++i)
+    {
+        words[i] = static_cast< std::uint16_t >(0x0102U * (i + 1U));
+    }
+    for (std::size_t i = 0U; i < dwords.size(); ++i)
+    {
+        dwords[i] = static_cast< std::uint32_t >(0x01020304UL * (i + 1U));
+    }
+    for (std::size_t i = 0U; i < doubles.size(); ++i)
+    {
+        doubles[i] = 0.25 * static_cast< double >(i) - 1.0;
+    }
+
+    std::uint8_t bytes[sizeof(words)] = {};
+    to_network(words.data(), words.size(), bytes);
+    for (std::size_t i = 0U; i < words.size(); ++i)
+    {
+        std::uint16_t expected{0U};
+        std::memcpy(&expected, &bytes[i * 2U], 2U);
+        EXPECT_EQ(expected, to_network(words[i]));
+    }
+
+    std::array< std::uint32_t, 19 > dwords_back{};
+    to_network(dwords.data(), dwords.size(), bytes);
+    EXPECT_EQ(bytes[0], 0x01U);
+    EXPECT_EQ(bytes[3], 0x04U);
+    from_network(bytes, dwords.size(), dwords_back.data());
+    EXPECT_EQ(dwords, dwords_back);
+
+    Packet< sizeof(doubles) + 10U > packet;
+    EXPECT_TRUE(packet.append_array(doubles));
+    EXPECT_TRUE(packet.append_array(words.data(), 5U));
+    std::array< double, 11 > doubles_back{};
+    std::uint16_t words_back[5] = {};
+    EXPECT_TRUE(packet.read_array(doubles_back));
+    EXPECT_TRUE(packet.read_array(words_back, 5U));
+    EXPECT_EQ(doubles, doubles_back);
+    EXPECT_EQ(words_back[4], words[4]);
+    EXPECT_FALSE(packet.read_array(words_back, 1U));
+    EXPECT_FALSE(packet.append_array(dwords.data(), 64U));
+
+    // count * sizeof(T) wraps around to 4 bytes, nothing is copied.
+    const std::size_t wrapping = (SIZE_MAX / sizeof(std::uint32_t)) + 2U;
+    Packet< 8U > small;
+    EXPECT_FALSE(small.append_array(dwords.data(), wrapping));
+    EXPECT_FALSE(small.read_array(dwords_back.data(), wrapping));
+    PacketView< 8U > view{small};
+    EXPECT_FALSE(view.append_array(dwords.data(), wrapping));
+    EXPECT_FALSE(view.read_array(dwords_back.data(), wrapping));
+}
+
+TEST(CanSignal, IntelPackUnpack)
+{
+    // 12 bit unsigned starting at bit 4, factor 0.5, offset -10
+    using Speed = CanSignal< 4, 12, ByteOrder::INTEL, false, std::ratio< 1, 2 >,
+                             std::ratio< -10 > >;
+    CanStdData data{0x0FU, 0x00U, 0xFFU};
+    Speed::pack(data.data(), 0xABCU);
+    EXPECT_EQ(data[0], 0xCFU);
+    EXPECT_EQ(data[1], 0xABU);
+    EXPECT_EQ(data[2], 0xFFU);
+    EXPECT_EQ(Speed::unpack(data.data()), 0xABCU);
+    EXPECT_DOUBLE_EQ(Speed::decode(data), (0xABC * 0.5) - 10.0);
+
+    Speed::encode(data, 100.0);
+    EXPECT_EQ(Speed::unpack(data.data()), 220U);
+    EXPECT_EQ(data[0] & 0x0FU, 0x0FU);
+}
+
+TEST(CanSignal, MotorolaSigned)
+{
+    // 16 bit signed big endian, MSB at bit 7 of byte 1
+    using Torque = CanSignal< 15, 16, ByteOrder::MOTOROLA, true >;
+    static_assert(Torque::first_byte == 1U, "first byte mismatch");
+    static_assert(Torque::byte_count == 2U, "byte count mismatch");
+    CanStdData data{};
+    Torque::pack(data.data(), -2);
+    EXPECT_EQ(data[1], 0xFFU);
+    EXPECT_EQ(data[2], 0xFEU);
+    EXPECT_EQ(Torque::unpack(data.data()), -2);
+
+    // 10 bit unaligned big endian, MSB at bit 3 of byte 0
+    using Level = CanSignal< 3, 10, ByteOrder::MOTOROLA >;
+    data.fill(0U);
+    Level::pack(data.data(), 0x3FFU);
+    EXPECT_EQ(data[0], 0x0FU);
+    EXPECT_EQ(data[1], 0xFCU);
+    EXPECT_EQ(Level::unpack(data.data()), 0x3FFU);
+}
+
+TEST(CanSignal, DecoderTableDispatch)
+{
+    using Msg1 = CanMessage< 0x100U, 2U, CanSignal< 0, 8 >, CanSignal< 8, 8 > >;
+    using Msg2 = CanMessage< 0x080U, 1U, CanSignal< 0, 4 > >;
+    Msg1::Physical values1{};
+    Msg2::Physical values2{};
+    CanDecoderTable< 4U > table;
+    EXPECT_TRUE(table.add< Msg1 >(values1));
+    EXPECT_TRUE(table.add< Msg2 >(values2));
+    EXPECT_FALSE(table.add< Msg2 >(values2));
+    EXPECT_EQ(table.size(), 2U);
+
+    CanFrame frame;
+    Msg1::encode(frame, Msg1::Physical{{3.0, 7.0}});
+    EXPECT_TRUE(table.dispatch(frame));
+    EXPECT_DOUBLE_EQ(values1[0], 3.0);
+    EXPECT_DOUBLE_EQ(values1[1], 7.0);
+
+    frame.can_id = 0x200U;
+    EXPECT_FALSE(table.dispatch(frame));
+}
+
+/// CAN link for the ISO-TP tests: sent frames end up in the peer's inbox.
+struct LoopbackCanLink
+{
+    std::int8_t send(const CanIDType can_id, const CanStdData& data,
+                     const std::uint8_t len) noexcept
+    {
+        CanFrame frame{};
+        frame.can_id = can_id;
+        frame.len = len;
+        std::copy(data.begin(), data.begin() + len, frame.data);
+        peer_inbox->push_back(frame);
+        ++frames_sent;
+        return 16;
+    }
+
+    std::vector< CanFrame >* peer_inbox;
+    std::vector< CanFrame > inbox;
+    std::size_t frames_sent{0U};
+};
+
+/// delivers all frames of the inbox to the transport.
+static void deliver(LoopbackCanLink& link,
+                    IsoTpTransport< LoopbackCanLink >& transport)
+{
+    std::vector< CanFrame > frames;
+    frames.swap(link.inbox);
+
+    for (const auto& frame : frames)
+    {
+        transport.on_frame(frame);
+    }
+}
+
+TEST(IsoTp, SegmentedTransfer)
+{
+    LoopbackCanLink link_a;
+    LoopbackCanLink link_b;
+    link_a.peer_inbox = &link_b.inbox;
+    link_b.peer_inbox = &link_a.inbox;
+    IsoTpTransport< LoopbackCanLink > sender{
+        link_a, make_isotp_config(0x7E0U, 0x7E8U)};
+    IsoTpTransport< LoopbackCanLink > receiver{
+        link_b, make_isotp_config(0x7E8U, 0x7E0U, 8U, 0U)};
+
+    // 4 KiB needs the 32 bit length of the first frame.
+    static Packet< 4096U > tx;
+    static Packet< 4096U > rx;
+
+    for (std::size_t i = 0U; i < tx.get_data().size(); ++i)
+    {
+        tx.get_data()[i] = static_cast< std::uint8_t >(i * 7U);
+    }
+
+    receiver.set_rx_buffer(rx);
+    ASSERT_TRUE(sender.send(tx, 4096U));
+    std::size_t len{0U};
+
+    for (int i = 0; (i < 1000) && sender.tx_busy(); ++i)
+    {
+        deliver(link_b, receiver);
+        deliver(link_a, sender);
+        sender.poll();
+    }
+
+    deliver(link_b, receiver);
+    EXPECT_FALSE(sender.tx_busy());
+    EXPECT_EQ(sender.get_last_error(), IsoTpError::NONE);
+    ASSERT_TRUE(receiver.rx_complete(len));
+    EXPECT_EQ(len, 4096U);
+    EXPECT_EQ(tx.get_data(), rx.get_data());
+    // first frame, 585 consecutive frames, one flow control every 8 frames.
+    EXPECT_EQ(link_a.frames_sent, 586U);
+    EXPECT_EQ(link_b.frames_sent, 74U);
+    EXPECT_FALSE(receiver.rx_complete(len));
+}
+
+TEST(IsoTp, SingleFrameAndOverflow)
+{
+    LoopbackCanLink link_a;
+    LoopbackCanLink link_b;
+    link_a.peer_inbox = &link_b.inbox;
+    link_b.peer_inbox = &link_a.inbox;
+    IsoTpTransport< LoopbackCanLink > sender{
+        link_a, make_isotp_config(0x7E0U, 0x7E8U)};
+    IsoTpTransport< LoopbackCanLink > receiver{
+        link_b, make_isotp_config(0x7E8U, 0x7E0U)};
+
+    Packet< 16U > rx;
+    receiver.set_rx_buffer(rx);
+    const std::uint8_t request[3]{0x22U, 0xF1U, 0x90U};
+    ASSERT_TRUE(sender.send(request, sizeof(request)));
+    EXPECT_FALSE(sender.tx_busy());
+    deliver(link_b, receiver);
+
+    std::size_t len{0U};
+    ASSERT_TRUE(receiver.rx_complete(len));
+    EXPECT_EQ(len, 3U);
+    EXPECT_EQ(rx.get_data()[2], 0x90U);
+
+    // 20 bytes do not fit: the receiver answers with an overflow.
+    const std::array< std::uint8_t, 20U > large{};
+    ASSERT_TRUE(sender.send(large.data(), large.size()));
+    deliver(link_b, receiver);
+    deliver(link_a, sender);
+    EXPECT_EQ(receiver.get_last_error(), IsoTpError::OVERFLOW);
+    EXPECT_EQ(sender.get_last_error(), IsoTpError::OVERFLOW);
+    EXPECT_FALSE(sender.tx_busy());
+}
+
+TEST(IsoTp, MalformedFirstFrame)
+{
+    LoopbackCanLink link;
+    std::vector< CanFrame > peer;
+    link.peer_inbox = &peer;
+    IsoTpTransport< LoopbackCanLink > receiver{
+        link, make_isotp_config(0x7E8U, 0x7E0U)};
+    struct
+    {
+        Packet< 8U > rx;
+        std::array< std::uint8_t, 16U > guard;
+    } memory{};
+    receiver.set_rx_buffer(memory.rx);
+
+    // FF_DL 2 fits into a single frame, FF_DL 1 does not need the escape.
+    CanFrame first{};
+    first.can_id = 0x7E0U;
+    first.len = 8U;
+    first.data[0] = 0x10U;
+    first.data[1] = 0x02U;
+    std::fill(&first.data[2], &first.data[8], 0xEEU);
+    receiver.on_frame(first);
+    EXPECT_EQ(receiver.get_last_error(), IsoTpError::UNEXPECTED_FRAME);
+
+    std::fill(&first.data[1], &first.data[5], 0x00U);
+    first.data[5] = 0x01U;
+    receiver.on_frame(first);
+    EXPECT_EQ(receiver.get_last_error(), IsoTpError::UNEXPECTED_FRAME);
+    EXPECT_TRUE(peer.empty());
+
+    // no reception is in progress, consecutive frames are ignored.
+    CanFrame consecutive{};
+    consecutive.can_id = 0x7E0U;
+    consecutive.len = 8U;
+    consecutive.data[0] = 0x21U;
+    std::fill(&consecutive.data[1], &consecutive.data[8], 0xEEU);
+    receiver.on_frame(consecutive);
+
+    std::size_t len{0U};
+    EXPECT_FALSE(receiver.rx_complete(len));
+    EXPECT_EQ(memory.rx.get_data()[0], 0U);
+    EXPECT_EQ(memory.guard[0], 0U);
+}
+
+TEST(IsoTp, SeparationTime)
+{
+    using std::chrono::microseconds;
+    EXPECT_EQ(isotp_st_min(0x00U), microseconds{0});
+    EXPECT_EQ(isotp_st_min(0x7FU), microseconds{127000});
+    EXPECT_EQ(isotp_st_min(0xF3U), microseconds{300});
+    EXPECT_EQ(isotp_st_min(0xFAU), microseconds{127000});
+}
+
+TEST(Sockets, EventLoopDispatch)
+{
+    TcpServer server;
+    server.reuse_addr();
+    ASSERT_TRUE(server.listen("127.0.0.1", 5556U));
+    TcpClient client;
+    ASSERT_TRUE(client.connect("127.0.0.1", 5556U));
+    ASSERT_TRUE(server.accept());
+
+    struct Context
+    {
+        TcpSocket* socket;
+        std::uint16_t received;
+    } context{&server.m_data, 0U};
+
+    EventLoop< 4U > loop;
+    ASSERT_TRUE(loop.is_initialized());
+    const bool added = loop.add(
+        server.m_data,
+        [](std::uint32_t events, void* ctx) {
+            auto* c = static_cast< Context* >(ctx);
+            std::array< std::uint8_t, 16U > data;
+
+            if ((events & EPOLLIN) != 0U)
+            {
+                // edge-triggered: read until the socket is drained.
+                std::int16_t received = 0;
+                while ((received = c->socket->receive(&data, data.size())) > 0)
+                {
+                    c->received += static_cast< std::uint16_t >(received);
+                }
+            }
+        },
+        &context);
+    EXPECT_TRUE(added);
+    EXPECT_FALSE(loop.add(server.m_data, [](std::uint32_t, void*) {}, nullptr));
+
+    using namespace std::chrono_literals;
+    EXPECT_EQ(loop.run_once(10ms), 0);
+
+    const std::array< std::uint8_t, 4U > data{{1U, 2U, 3U, 4U}};
+    EXPECT_EQ(client.send(&data, data.size()), 4);
+    EXPECT_EQ(loop.run_once(1000ms), 1);
+    EXPECT_EQ(context.received, 4U);
+
+    EXPECT_TRUE(loop.remove(server.m_data));
+    EXPECT_FALSE(loop.remove(server.m_data));
+}
+
+TEST(Sockets, EventLoopReplacedInBatch)
+{
+    struct Shared
+    {
+        EventLoop< 4U > loop;
+        int spare;
+        bool replaced;
+        int spare_calls;
+    } shared{{}, eventfd(0U, EFD_NONBLOCK), false, 0};
+
+    struct Entry
+    {
+        Shared* shared;
+        int other;
+    };
+
+    const int first = eventfd(1U, EFD_NONBLOCK);
+    const int second = eventfd(1U, EFD_NONBLOCK);
+    Entry entries[2] = {{&shared, second}, {&shared, first}};
+
+    // whichever ready descriptor runs first replaces the other one, the
+    // event of the removed descriptor must not reach its successor.
+    const EventCallback replace = [](std::uint32_t, void* ctx) {
+        auto* entry = static_cast< Entry* >(ctx);
+        Shared* s = entry->shared;
+
+        if ((s->replaced == false) && s->loop.remove(entry->other))
+        {
+            s->replaced = s->loop.add(
+                s->spare,
+                [](std::uint32_t, void* ctx2) {
+                    ++static_cast< Shared* >(ctx2)->spare_calls;
+                },
+                s);
+        }
+    };
+    ASSERT_TRUE(shared.loop.add(first, replace, &entries[0]));
+    ASSERT_TRUE(shared.loop.add(second, replace, &entries[1]));
+
+    EXPECT_EQ(shared.loop.run_once(std::chrono::milliseconds{100}), 2);
+    EXPECT_TRUE(shared.replaced);
+    EXPECT_EQ(shared.spare_calls, 0);
+
+    // a deadline below one millisecond still waits
+    const auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(shared.loop.run_once(std::chrono::microseconds{500}), 0);
+    EXPECT_GE(std::chrono::steady_clock::now() - start,
+              std::chrono::microseconds{500});
+
+    ::close(first);
+    ::close(second);
+    ::close(shared.spare);
+}
+
+TEST(Sockets, TcpMultiServerConnections)
+{
+    struct ClientState
+    {
+        std::uint16_t received;
+    };
+    using Server = TcpMultiServer< 2U, ClientState >;
+
+    // the loop must outlive the server attached to it
+    EventLoop< 3U > loop;
+    Server server;
+    EXPECT_TRUE(server.reuse_addr());
+    EXPECT_TRUE(server.reuse_port());
+    ASSERT_TRUE(server.listen("127.0.0.1", 5557U, 32));
+    std::uint16_t total{0U};
+    const auto on_data = [](Server::Connection& connection,
+                            std::uint32_t events, void* context) {
+        std::array< std::uint8_t, 16U > data;
+        std::int16_t received = 0;
+
+        while ((received = connection.socket.receive(&data, data.size())) > 0)
+        {
+            connection.state.received += received;
+            *static_cast< std::uint16_t* >(context) += received;
+        }
+
+        if ((received == 0) || ((events & EPOLLRDHUP) != 0U))
+        {
+            connection.server->close(connection);
+        }
+    };
+    ASSERT_TRUE(server.attach(loop, on_data, &total));
+
+    TcpClient client1;
+    TcpClient client2;
+    TcpClient client3;
+    ASSERT_TRUE(client1.connect("127.0.0.1", 5557U));
+    ASSERT_TRUE(client2.connect("127.0.0.1", 5557U));
+
+    using namespace std::chrono_literals;
+    loop.run_once(100ms);
+    EXPECT_EQ(server.connection_count(), 2U);
+
+    // all slots are occupied, the third client is refused.
+    ASSERT_TRUE(client3.connect("127.0.0.1", 5557U));
+    loop.run_once(100ms);
+    EXPECT_EQ(server.connection_count(), 2U);
+
+    const std::array< std::uint8_t, 3U > data{{1U, 2U, 3U}};
+    EXPECT_EQ(client1.send(&data, data.size()), 3);
+    EXPECT_EQ(client2.send(&data, 2U), 2);
+
+    for (auto i = 0; (i < 10) && (total < 5U); ++i)
+    {
+        loop.run_once(100ms);
+    }
+
+    EXPECT_EQ(total, 5U);
+    EXPECT_EQ(server.connection(0U).state.received +
+                  server.connection(1U).state.received,
+              5U);
+
+    client1.disconnect();
+
+    for (auto i = 0; (i < 10) && (server.connection_count() > 1U); ++i)
+    {
+        loop.run_once(100ms);
+    }
+
+    EXPECT_EQ(server.connection_count(), 1U);
+
+    // closing a free slot again keeps the count
+    const std::size_t closed = server.is_connected(0U) ? 1U : 0U;
+    server.close(server.connection(closed));
+    EXPECT_EQ(server.connection_count(), 1U);
+
+    server.detach();
+    EXPECT_FALSE(loop.remove(server.connection(1U - closed).socket));
+}
+
+TEST(Sockets, TcpMultiServerStandAlone)
+{
+    struct ClientState
+    {
+        std::uint16_t received;
+    };
+    TcpMultiServer< 1U, ClientState > server;
+    EXPECT_TRUE(server.reuse_addr());
+    ASSERT_TRUE(server.listen("127.0.0.1", 5564U, 4));
+
+    TcpClient client;
+    ASSERT_TRUE(client.connect("127.0.0.1", 5564U));
+    std::int16_t accepted{0};
+
+    for (auto i = 0; (i < 10) && (accepted == 0); ++i)
+    {
+        accepted = server.accept_pending();
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+
+    // without a loop the slot reports the mode it was accepted with.
+    ASSERT_EQ(accepted, 1);
+    ASSERT_TRUE(server.is_connected(0U));
+    EXPECT_FALSE(server.connection(0U).socket.is_blocking());
+}
+
+TEST(Sockets, FramedStreamCoalescedFrames)
+{
+    TcpServer server;
+    server.reuse_addr();
+    ASSERT_TRUE(server.listen("127.0.0.1", 5558U));
+    TcpClient client;
+    ASSERT_TRUE(client.connect("127.0.0.1", 5558U));
+    ASSERT_TRUE(server.accept());
+
+    Packet< 8 > tx;
+    for (std::uint8_t i = 0U; i < 3U; ++i)
+    {
+        tx.get_data().fill(i);
+        const auto sent = FramedStream< 64U >::send(client, tx, i + 4U);
+        EXPECT_EQ(sent, 2 + i + 4);
+    }
+
+    FramedStream< 64U > stream;
+    using namespace std::chrono_literals;
+    ASSERT_TRUE(server.m_data.wait_for(1000ms));
+    std::this_thread::sleep_for(10ms);
+    EXPECT_EQ(stream.fill(server.m_data), 2 + 4 + 2 + 5 + 2 + 6);
+
+    Packet< 8 > rx;
+    std::uint16_t length{0U};
+
+    for (std::uint8_t i = 0U; i < 3U; ++i)
+    {
+        ASSERT_TRUE(stream.next(rx, length));
+        EXPECT_EQ(length, i + 4U);
+        EXPECT_EQ(rx.get_data()[length - 1U], i);
+    }
+
+    EXPECT_FALSE(stream.next(rx, length));
+    EXPECT_EQ(stream.available(), 0U);
+    EXPECT_FALSE(stream.has_protocol_error());
+}
+
+TEST(Sockets, FramedStreamPartialSend)
+{
+    TcpServer server;
+    server.reuse_addr();
+    ASSERT_TRUE(server.listen("127.0.0.1", 5563U));
+    TcpClient client;
+    ASSERT_TRUE(client.connect("127.0.0.1", 5563U));
+    ASSERT_TRUE(server.accept());
+
+    // frames larger than the socket buffers are taken in parts by the kernel
+    static constexpr std::uint16_t FRAME_LEN{60000U};
+    static constexpr int FRAMES{8};
+    int small_buffer{4096};
+    setsockopt(client.get_socket(), SOL_SOCKET, SO_SNDBUF, &small_buffer,
+               sizeof(small_buffer));
+    ASSERT_TRUE(client.set_blocking(false));
+    // a reader out of sync gives up instead of blocking the test
+    struct timeval timeout{2, 0};
+    setsockopt(server.m_data.get_socket(), SOL_SOCKET, SO_RCVTIMEO, &timeout,
+               sizeof(timeout));
+
+    int frames_ok{0};
+    std::thread reader{[&server, &frames_ok]() {
+        static FramedStream< 65536U > stream;
+        static Packet< FRAME_LEN > rx;
+        std::uint16_t length{0U};
+
+        while ((frames_ok < FRAMES) && (stream.fill(server.m_data) > 0))
+        {
+            while (stream.next(rx, length))
+            {
+                if ((length == FRAME_LEN) &&
+                    (rx.get_data()[0] == rx.get_data()[FRAME_LEN - 1U]))
+                {
+                    ++frames_ok;
+                }
+            }
+        }
+    }};
+
+    static Packet< FRAME_LEN > tx;
+
+    for (int i = 0; i < FRAMES; ++i)
+    {
+        tx.get_data().fill(static_cast< std::uint8_t >(i));
+        std::int32_t sent{-1};
+
+        // nothing sent yet: the frame may be sent again
+        while ((sent = FramedStream< 65536U >::send(client, tx, FRAME_LEN)) < 0)
+        {
+            ASSERT_EQ(client.get_last_error(), EAGAIN);
+            std::this_thread::sleep_for(std::chrono::milliseconds{1});
+        }
+
+        EXPECT_EQ(sent, 2 + FRAME_LEN);
+    }
+
+    reader.join();
+    EXPECT_EQ(frames_ok, FRAMES);
+}
+
+TEST(Sockets, TcpSendVectored)
+{
+    TcpServer server;
+    server.reuse_addr();
+    ASSERT_TRUE(server.listen("127.0.0.1", 5559U));
+    TcpClient client;
+    ASSERT_TRUE(client.connect("127.0.0.1", 5559U));
+    ASSERT_TRUE(server.accept());
+
+    Packet< 4 > header;
+    Packet< 8 > payload;
+    header.get_data().fill(0xAAU);
+    payload.get_data().fill(0x55U);
+
+    EXPECT_TRUE(client.set_cork(true));
+    EXPECT_EQ(client.send_packets(header, payload), 12);
+    const std::uint8_t trailer{0x11U};
+    EXPECT_EQ(client.send_more(&trailer, 1U), 1);
+    EXPECT_TRUE(client.set_cork(false));
+    EXPECT_EQ(client.send(&trailer, 1U), 1);
+
+    std::array< std::uint8_t, 14U > data{};
+    std::size_t received{0U};
+    using namespace std::chrono_literals;
+
+    while ((received < data.size()) && server.m_data.wait_for(1000ms))
+    {
+        const auto left = data.size() - received;
+        const auto nbytes = server.m_data.receive(
+            &data[received], static_cast< std::uint16_t >(left));
+        ASSERT_GT(nbytes, 0);
+        received += static_cast< std::size_t >(nbytes);
+    }
+
+    EXPECT_EQ(received, 14U);
+    EXPECT_EQ(data[3], 0xAAU);
+    EXPECT_EQ(data[4], 0x55U);
+    EXPECT_EQ(data[12], 0x11U);
+}
+
+TEST(Sockets, TcpReceiveTimestamp)
+{
+    TcpServer server;
+    server.reuse_addr();
+    ASSERT_TRUE(server.listen("127.0.0.1", 5560U));
+    TcpClient client;
+    ASSERT_TRUE(client.connect("127.0.0.1", 5560U));
+    ASSERT_TRUE(server.accept());
+    EXPECT_TRUE(server.m_data.enable_timestamps());
+
+    struct timespec before;
+    clock_gettime(CLOCK_REALTIME, &before);
+    const std::uint32_t message{0x12345678U};
+    EXPECT_EQ(client.send(&message, sizeof(message)), 4);
+
+    std::uint32_t received{0U};
+    RxTimestamp stamp;
+    EXPECT_EQ(server.m_data.receive(&received, sizeof(received), stamp), 4);
+    EXPECT_EQ(received, message);
+    EXPECT_GE(stamp.tv_sec, before.tv_sec);
+    EXPECT_LE(stamp.tv_sec, before.tv_sec + 1);
+}
+
+TEST(Sockets, TcpConnectBackoffAndReconnect)
+{
+    using namespace std::chrono_literals;
+    TcpClient client;
+    EXPECT_TRUE(client.set_keepalive(TcpKeepalive{10s, 2s, 3, 5000ms}));
+
+    // nobody listens: refused right away instead of blocking.
+    const auto start = std::chrono::steady_clock::now();
+    EXPECT_FALSE(client.connect("127.0.0.1", 5561U, 500ms));
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 500ms);
+    EXPECT_EQ(client.get_last_error(), ECONNREFUSED);
+
+    client.set_reconnect("127.0.0.1", 5561U, TcpReconnect{50ms, 100ms, 100ms});
+    auto deadline = std::chrono::steady_clock::now() + 1s;
+    while ((client.maintain() != TcpConnectState::DISCONNECTED) &&
+           (std::chrono::steady_clock::now() < deadline))
+    {
+    }
+
+    EXPECT_EQ(client.get_connect_attempts(), 2U);
+    // the next attempt waits for the backoff.
+    EXPECT_EQ(client.maintain(), TcpConnectState::DISCONNECTED);
+    EXPECT_EQ(client.get_connect_attempts(), 2U);
+
+    TcpServer server;
+    server.reuse_addr();
+    ASSERT_TRUE(server.listen("127.0.0.1", 5561U));
+
+    deadline = std::chrono::steady_clock::now() + 1s;
+    while ((client.maintain() != TcpConnectState::CONNECTED) &&
+           (std::chrono::steady_clock::now() < deadline))
+    {
+        std::this_thread::sleep_for(1ms);
+    }
+
+    ASSERT_EQ(client.get_connect_state(), TcpConnectState::CONNECTED);
+    EXPECT_EQ(client.get_connect_attempts(), 0U);
+    EXPECT_TRUE(client.is_blocking());
+    ASSERT_TRUE(server.accept());
+    const std::uint32_t message{0x12345678U};
+    EXPECT_EQ(client.send(&message, sizeof(message)), 4);
+
+    // the application noticed a broken connection: connect again.
+    client.connection_lost();
+    EXPECT_EQ(client.get_connect_state(), TcpConnectState::DISCONNECTED);
+    EXPECT_NE(client.maintain(), TcpConnectState::DISCONNECTED);
+}
+
+TEST(Sockets, UdpBatchAndMulticast)
+{
+    UdpSocket listener;
+    ASSERT_TRUE(listener.reuse_addr());
+    ASSERT_TRUE(listener.set_receive_buffer(256 * 1024));
+    EXPECT_GT(listener.get_receive_buffer(), 0);
+    ASSERT_TRUE(listener.bind("255.255.255.0", 5562U));
+
+    UdpSocket publisher;
+    EXPECT_TRUE(publisher.set_send_buffer(256 * 1024));
+    publisher.set_destination("127.0.0.1", 5562U);
+
+    Packet< 4 > packet;
+    packet.store< std::uint32_t, 0 >(0x12345678U);
+    EXPECT_EQ(publisher.send(packet), 4);
+    Packet< 4 > received;
+    EXPECT_EQ(listener.receive(received), 4);
+    EXPECT_EQ((received.peek< std::uint32_t, 0 >()), 0x12345678U);
+
+    // a datagram beyond 32767 bytes reports its full length.
+    static Packet< 40000 > large;
+    EXPECT_EQ(publisher.send(large), 40000);
+    static Packet< 40000 > large_received;
+    EXPECT_EQ(listener.receive(large_received), 40000);
+
+    // 8 datagrams with one sendmmsg and one recvmmsg.
+    UdpTxBatch< 8, 16 > tx;
+    for (std::uint8_t i = 0U; i < 8U; ++i)
+    {
+        std::uint8_t* datagram = tx.stage(i + 1U);
+        ASSERT_NE(datagram, nullptr);
+        datagram[0] = i;
+    }
+
+    EXPECT_EQ(tx.stage(17U), nullptr);
+    EXPECT_TRUE(tx.full());
+    EXPECT_EQ(publisher.send_batch(tx), 8);
+    EXPECT_TRUE(tx.empty());
+
+    using namespace std::chrono_literals;
+    ASSERT_TRUE(listener.wait_for(100ms));
+    UdpRxBatch< 16, 16 > rx;
+    ASSERT_EQ(listener.receive_batch(rx), 8);
+    EXPECT_EQ(rx.length(7), 8U);
+    EXPECT_EQ(rx.data(7)[0], 7U);
+    EXPECT_NE(rx.source(0).sin_port, 0U);
+
+    // multicast on the loopback interface.
+    if (listener.join_group("239.1.2.3", "127.0.0.1"))
+    {
+        EXPECT_TRUE(publisher.set_multicast_interface("127.0.0.1"));
+        EXPECT_TRUE(publisher.set_multicast_ttl(1U));
+        EXPECT_TRUE(publisher.set_multicast_loop(true));
+        publisher.set_destination("239.1.2.3", 5562U);
+        EXPECT_EQ(publisher.send(packet), 4);
+        ASSERT_TRUE(listener.wait_for(100ms));
+        EXPECT_EQ(listener.receive(received), 4);
+        EXPECT_TRUE(listener.leave_group("239.1.2.3", "127.0.0.1"));
+    }
+}
+
+TEST(System, ShmChannelPublishSubscribe)
+{
+    static constexpr char name[] = "/bsw_test_channel";
+    ShmRegion::remove(name);
+    ShmSubscriber< 16, 8 > early{name};
+    EXPECT_FALSE(early.is_open());
+
+    ShmPublisher< 16, 8 > publisher{name};
+    ASSERT_TRUE(publisher.is_open());
+    ShmSubscriber< 16, 8 > fast{name};
+    ShmSubscriber< 16, 8 > slow{name};
+    ASSERT_TRUE(fast.is_open());
+    EXPECT_TRUE(early.open(name));
+    // a subscriber of another layout is refused.
+    ShmSubscriber< 16, 4 > other{name};
+    EXPECT_FALSE(other.is_open());
+
+    Packet< 8 > packet;
+    packet.store< std::uint64_t, 0 >(1U);
+    EXPECT_EQ(publisher.send(packet), 8);
+    Packet< 8 > received;
+    EXPECT_EQ(fast.receive(received), 8);
+    EXPECT_EQ((received.peek< std::uint64_t, 0 >()), 1U);
+    EXPECT_EQ(fast.receive(received), 0);
+
+    // the slow subscriber falls behind by more than the ring.
+    for (std::uint64_t i = 2U; i <= 20U; ++i)
+    {
+        packet.store< std::uint64_t, 0 >(i);
+        EXPECT_EQ(publisher.send(packet), 8);
+    }
+
+    EXPECT_EQ(slow.pending(), 20U);
+    EXPECT_EQ(slow.receive(received), 8);
+    EXPECT_EQ((received.peek< std::uint64_t, 0 >()), 14U);
+    EXPECT_EQ(slow.lost(), 13U);
+
+    // a sleeping subscriber is woken up by the publisher.
+    using namespace std::chrono_literals;
+    while (fast.receive(received) > 0)
+    {
+    }
+
+    EXPECT_FALSE(fast.wait_for(1ms));
+    std::thread writer{[&publisher]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds{5});
+        const std::uint32_t value{0xCAFEU};
+        publisher.send(&value, sizeof(value));
+    }};
+
+    std::uint32_t value{0U};
+    EXPECT_EQ(fast.receive(&value, sizeof(value), 1000ms), 4);
+    EXPECT_EQ(value, 0xCAFEU);
+    writer.join();
+    EXPECT_TRUE(ShmRegion::remove(name));
+
+    // a message beyond 32767 bytes reports its full length.
+    static constexpr char large_name[] = "/bsw_test_channel_large";
+    ShmRegion::remove(large_name);
+    ShmPublisher< 40000, 2 > large_publisher{large_name};
+    ShmSubscriber< 40000, 2 > large_subscriber{large_name};
+    ASSERT_TRUE(large_subscriber.is_open());
+    static Packet< 40000 > large;
+    EXPECT_EQ(large_publisher.send(large), 40000);
+    EXPECT_EQ(large_subscriber.receive(large), 40000);
+    EXPECT_TRUE(ShmRegion::remove(large_name));
+}
+
+TEST(System, SpscQueueFifo)
+{
+    SpscQueue< std::uint32_t, 4U > queue;
+    std::uint32_t value{0U};
+    EXPECT_TRUE(queue.empty());
+    EXPECT_FALSE(queue.try_pop(value));
+
+    for (std::uint32_t i = 0U; i < 4U; ++i)
+    {
+        EXPECT_TRUE(queue.try_push(i));
+    }
+
+    EXPECT_FALSE(queue.try_push(4U));
+    EXPECT_EQ(queue.size(), 4U);
+    EXPECT_TRUE(queue.try_pop(value));
+    EXPECT_EQ(value, 0U);
+
+    std::uint32_t* slot = queue.prepare();
+    ASSERT_NE(slot, nullptr);
+    *slot = 42U;
+    queue.commit();
+
+    for (std::uint32_t i = 1U; i < 4U; ++i)
+    {
+        EXPECT_TRUE(queue.try_pop(value));
+        EXPECT_EQ(value, i);
+    }
+
+    const std::uint32_t* front = queue.front();
+    ASSERT_NE(front, nullptr);
+    EXPECT_EQ(*front, 42U);
+    queue.pop();
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(System, SpscQueueThreads)
+{
+    static SpscQueue< std::uint64_t, 256U > queue;
+    static constexpr std::uint64_t COUNT{10000U};
+
+    std::thread producer([]() {
+        for (std::uint64_t i = 0U; i < COUNT; ++i)
+        {
+            while (queue.try_push(i) == false)
+            {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    // a third thread observes the size while both sides move.
+    std::atomic< bool > done{false};
+    std::atomic< std::size_t > largest{0U};
+    std::thread observer([&done, &largest]() {
+        while (done.load() == false)
+        {
+            const std::size_t size = queue.size();
+            if (size > largest.load())
+            {
+                largest.store(size);
+            }
+        }
+    });
+
+    std::uint64_t expected{0U};
+    std::uint64_t value{0U};
+
+    while (expected < COUNT)
+    {
+        if (queue.try_pop(value))
+        {
+            ASSERT_EQ(value, expected);
+            ++expected;
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    producer.join();
+    done.store(true);
+    observer.join();
+    EXPECT_TRUE(queue.empty());
+    EXPECT_LE(largest.load(), queue.capacity());
+}
+
+TEST(System, TaskStatisticsHistogram)
+{
+    TaskStatistics< 10U, 100 > statistics;
+    EXPECT_EQ(statistics.cycles(), 0U);
+    EXPECT_EQ(statistics.wakeup_latency().min(), 0);
+
+    for (std::int64_t i = 0; i < 100; ++i)
+    {
+        // wakeup latencies 0..990 ns, one overrun beyond the last bucket.
+        statistics.record(i * 10, (i == 99) ? 5000 : 50, i == 99);
+    }
+
+    const auto& wakeup = statistics.wakeup_latency();
+    EXPECT_EQ(statistics.cycles(), 100U);
+    EXPECT_EQ(statistics.overruns(), 1U);
+    EXPECT_EQ(wakeup.min(), 0);
+    EXPECT_EQ(wakeup.max(), 990);
+    EXPECT_EQ(wakeup.mean(), 495);
+    EXPECT_EQ(wakeup.bucket(0U), 10U);
+    EXPECT_EQ(wakeup.percentile(50.0), 500);
+    EXPECT_EQ(wakeup.percentile(100.0), 1000);
+
+    const auto& execution = statistics.execution_time();
+    EXPECT_EQ(execution.bucket(0U), 99U);
+    EXPECT_EQ(execution.bucket(10U), 1U);
+    EXPECT_EQ(execution.percentile(99.0), 100);
+    EXPECT_EQ(execution.percentile(100.0), 5000);
+}
+
+TEST(System, OverrunPolicies)
+{
+    constexpr std::int64_t PERIOD{1000};
+
+    // no overrun: every policy keeps the period.
+    EXPECT_EQ(OverrunCatchUp<>::next_release(400, PERIOD), PERIOD);
+    EXPECT_EQ(OverrunSkip::next_release(400, PERIOD), PERIOD);
+    EXPECT_EQ(OverrunRealign::next_release(400, PERIOD), PERIOD);
+
+    // update() finished 3.5 periods after its release.
+    EXPECT_EQ(OverrunCatchUp<>::next_release(3500, PERIOD), PERIOD);
+    EXPECT_EQ(OverrunCatchUp< 2U >::next_release(3500, PERIOD), 2000);
+    EXPECT_EQ(OverrunCatchUp< 1U >::next_release(3500, PERIOD), 3000);
+    EXPECT_EQ(OverrunSkip::next_release(3500, PERIOD), 4000);
+    EXPECT_EQ(OverrunRealign::next_release(3500, PERIOD), 4500);
+}
+
+TEST(System, TaskAttributesPthread)
+{
+    using Attributes =
+        TaskAttributes< SchedPolicy::FIFO, 1U, 256U * 1024U, 64U * 1024U >;
+    pthread_attr_t attributes;
+    ASSERT_EQ(pthread_attr_init(&attributes), 0);
+    EXPECT_TRUE(Attributes::apply(attributes, 42));
+
+    std::size_t stack_size{0U};
+    int policy{0};
+    int inherit{0};
+    struct sched_param param;
+    cpu_set_t cpus;
+    pthread_attr_getstacksize(&attributes, &stack_size);
+    pthread_attr_getschedpolicy(&attributes, &policy);
+    pthread_attr_getinheritsched(&attributes, &inherit);
+    pthread_attr_getschedparam(&attributes, &param);
+    pthread_attr_getaffinity_np(&attributes, sizeof(cpus), &cpus);
+    pthread_attr_destroy(&attributes);
+
+    EXPECT_EQ(stack_size, 256U * 1024U);
+    EXPECT_EQ(policy, SCHED_FIFO);
+    EXPECT_EQ(inherit, PTHREAD_EXPLICIT_SCHED);
+    EXPECT_EQ(param.sched_priority, 42);
+    EXPECT_EQ(CPU_COUNT(&cpus), 1);
+    EXPECT_TRUE(CPU_ISSET(0, &cpus));
+    EXPECT_EQ(Attributes::prefault_size(), 64U * 1024U);
+}
+
+/// a job of the executive counting its updates.
+template < int Id > struct CountingJob
+{
+    bool pre() noexcept { return true; }
+    bool update() noexcept
+    {
+        ++updates;
+        return true;
+    }
+    void post() noexcept {}
+    int updates{0};
+};
+
+TEST(System, RTThreadCreatedWithoutPrivileges)
+{
+    // pre() fails, the thread returns right away. Without the privileges for
+    // SCHED_FIFO the thread is created with the inherited scheduling.
+    struct Task
+        : RTThread< Task, 50, 1000, OverrunCatchUp<>,
+                    TaskAttributes< SchedPolicy::FIFO > >
+    {
+        bool pre() noexcept { return false; }
+        bool update() noexcept { return false; }
+        void post() noexcept {}
+    };
+
+    Task task;
+    EXPECT_TRUE(task.is_created());
+}
+
+TEST(System, CyclicExecutiveSchedule)
+{
+    using Executive =
+        CyclicExecutive< 50, TaskAttributes<>,
+                         PeriodicJob< CountingJob< 10 >, 10000 >,
+                         PeriodicJob< CountingJob< 1 >, 1000 >,
+                         PeriodicJob< CountingJob< 2 >, 2000 >,
+                         PeriodicJob< CountingJob< 5 >, 5000 > >;
+
+    static_assert(Executive::MINOR_CYCLE == 1000, "minor cycle");
+    static_assert(Executive::HYPERPERIOD == 10000, "hyperperiod");
+    static_assert(Executive::FRAMES == 10U, "frames");
+
+    // rate-monotonic: the 1 ms job first, the 10 ms job last.
+    EXPECT_EQ(Executive::SCHEDULE.order[0], 1U);
+    EXPECT_EQ(Executive::SCHEDULE.order[3], 0U);
+    EXPECT_EQ(Executive::SCHEDULE.masks[0], 0xFU);
+    EXPECT_EQ(Executive::SCHEDULE.masks[5], 0xAU);
+
+    Executive executive;
+    EXPECT_TRUE(executive.pre());
+
+    for (int i = 0; i < 20; ++i)
+    {
+        EXPECT_TRUE(executive.update());
+    }
+
+    EXPECT_EQ(executive.job< 0 >().updates, 2);
+    EXPECT_EQ(executive.job< 1 >().updates, 20);
+    EXPECT_EQ(executive.job< 2 >().updates, 10);
+    EXPECT_EQ(executive.job< 3 >().updates, 4);
+
+    // an overrun of 1.5 frames skips the next two frames.
+    executive.on_overrun(1500000);
+    EXPECT_EQ(executive.frame(), 2U);
+}
+
+TEST(System, ObjectPoolAcquireRelease)
+{
+    PacketPool< 64U, 2U > pool;
+    EXPECT_EQ(pool.capacity(), 2U);
+
+    Packet< 64U >* first = pool.acquire();
+    Packet< 64U >* second = pool.acquire();
+    ASSERT_NE(first, nullptr);
+    ASSERT_NE(second, nullptr);
+    EXPECT_NE(first, second);
+    EXPECT_TRUE(pool.owns(first));
+    Packet< 64U > outside;
+    EXPECT_FALSE(pool.owns(&outside));
+    EXPECT_EQ(pool.acquire(), nullptr);
+    EXPECT_EQ(pool.failed(), 1U);
+
+    // packets are passed by pointer, not copied.
+    SpscQueue< Packet< 64U >*, 2U > queue;
+    std::uint32_t value{0xCAFEU};
+    *first << value;
+    EXPECT_TRUE(queue.try_push(first));
+    Packet< 64U >* received{nullptr};
+    ASSERT_TRUE(queue.try_pop(received));
+    EXPECT_EQ(received, first);
+    EXPECT_EQ((received->peek< std::uint32_t, 0 >()), 0xCAFEU);
+
+    pool.release(received);
+    pool.release(second);
+    EXPECT_EQ(pool.in_use(), 0U);
+    EXPECT_EQ(pool.high_water(), 2U);
+
+    // a released block is handed out again.
+    Packet< 64U >* again = pool.acquire();
+    EXPECT_TRUE((again == first) || (again == second));
+    pool.release(again);
+}
+
+TEST(System, ObjectPoolThreads)
+{
+    static ObjectPool< std::uint64_t, 8U > pool;
+    constexpr int ROUNDS{20000};
+    std::atomic< int > errors{0};
+
+    const auto worker = [&errors](const std::uint64_t id) {
+        for (int i = 0; i < ROUNDS; ++i)
+        {
+            std::uint64_t* value = pool.acquire(id);
+
+            if (value != nullptr)
+            {
+                // nobody else may hold the same block meanwhile.
+                if (*value != id)
+                {
+                    ++errors;
+                }
+                pool.release(value);
+            }
+        }
+    };
+
+    std::thread t1{worker, 1U};
+    std::thread t2{worker, 2U};
+    std::thread t3{worker, 3U};
+    t1.join();
+    t2.join();
+    t3.join();
+
+    EXPECT_EQ(errors.load(), 0);
+    EXPECT_EQ(pool.in_use(), 0U);
+    EXPECT_LE(pool.high_water(), 3U);
+}
+
+TEST(System, TraceRingConcurrentReader)
+{
+    // a small ring is lapped all the time, the reader must never see an
+    // event mixed of two writes.
+    static TraceRing< 8U > ring;
+    static constexpr char name[] = "probe";
+    std::atomic< bool > running{true};
+    std::thread writer{[&running]() {
+        std::uint64_t tick{0U};
+
+        while (running.load(std::memory_order_relaxed))
+        {
+            ring.record(name, tick, tick + 1U);
+            ++tick;
+        }
+    }};
+
+    std::size_t torn{0U};
+    std::size_t seen{0U};
+    const auto until =
+        std::chrono::steady_clock::now() + std::chrono::milliseconds{200};
+
+    while (std::chrono::steady_clock::now() < until)
+    {
+        ring.for_each([&torn, &seen](const TraceEvent& event) {
+            ++seen;
+            torn += ((event.end != (event.begin + 1U)) ||
+                     (event.name != name))
+                        ? 1U
+                        : 0U;
+        });
+    }
+
+    running.store(false);
+    writer.join();
+    EXPECT_GT(seen, 0U);
+    EXPECT_EQ(torn, 0U);
+}
+
+TEST(System, TraceRingAndChromeDump)
+{
+    TraceRing< 4U > ring;
+    for (std::uint64_t i = 0U; i < 6U; ++i)
+    {
+        ring.record("event", i, i + 1U);
+    }
+    EXPECT_EQ(ring.recorded(), 6U);
+
+    // the two oldest events were overwritten.
+    std::vector< std::uint64_t > begins;
+    ring.for_each(
+        [&begins](const TraceEvent& event) { begins.push_back(event.begin); });
+    ASSERT_EQ(begins.size(), 4U);
+    EXPECT_EQ(begins.front(), 2U);
+    EXPECT_EQ(begins.back(), 5U);
+
+    {
+        const TraceScope scope{"TraceTest::scope"};
+    }
+    std::thread other{[]() { const TraceScope scope{"TraceTest::thread"}; }};
+    other.join();
+    EXPECT_GE(Trace::thread_count(), 2U);
+
+    const char* path = "/tmp/bsw_trace_test.json";
+    ASSERT_TRUE(Trace::dump_chrome(path));
+    std::FILE* file = std::fopen(path, "r");
+    ASSERT_NE(file, nullptr);
+    std::array< char, 4096U > json{};
+    const auto length = std::fread(json.data(), 1U, json.size() - 1U, file);
+    std::fclose(file);
+    std::remove(path);
+    const std::string content{json.data(), length};
+    EXPECT_EQ(content.find("{\"displayTimeUnit\""), 0U);
+    EXPECT_NE(content.find("\"name\":\"TraceTest::scope\",\"ph\":\"X\""),
+              std::string::npos);
+    EXPECT_NE(content.find("TraceTest::thread"), std::string::npos);
+    EXPECT_NE(content.rfind("]}"), std::string::npos);
+}
+
 int main(int argc, char** argv)
 {
     testing::InitGoogleTest(&argc, argv);
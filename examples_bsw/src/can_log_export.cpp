@@ -0,0 +1,69 @@
+/// \brief This example exports a binary CAN log file written by CanLogFile to
+/// the log format of candump, which can be replayed by canplayer or converted
+/// by other tools, e.g.
+/// rosrun examples_bsw can_log_export /tmp/can.0.canlog > can.log
+
+#include "CanLogFile.h"
+#include <cstdio>
+
+////////////////////////////////////////////////////////////////////////////////
+static void print_record(const CanLogRecord& record) noexcept
+{
+    const bool eff = (record.can_id & CAN_EFF_FLAG) != 0U;
+    const auto can_id =
+        record.can_id & (eff ? CAN_EFF_MASK : static_cast< canid_t >(CAN_SFF_MASK));
+    std::printf("(%llu.%06llu) can%u ",
+                static_cast< unsigned long long >(record.timestamp_ns /
+                                                  1000000000ULL),
+                static_cast< unsigned long long >(
+                    (record.timestamp_ns % 1000000000ULL) / 1000ULL),
+                static_cast< unsigned >(record.channel));
+    std::printf(eff ? "%08X" : "%03X", static_cast< unsigned >(can_id));
+
+    if ((record.flags & CAN_LOG_FD) != 0U)
+    {
+        // CAN FD frames have a second '#' followed by the flags.
+        std::printf("##%X", static_cast< unsigned >(record.flags & 0x0FU));
+    }
+    else if ((record.can_id & CAN_RTR_FLAG) != 0U)
+    {
+        std::printf("#R");
+    }
+    else
+    {
+        std::printf("#");
+    }
+
+    for (std::uint8_t i = 0U; i < record.len; ++i)
+    {
+        std::printf("%02X", static_cast< unsigned >(record.data[i]));
+    }
+
+    std::printf("\n");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int main(int argc, char** argv) noexcept
+{
+    int result{0};
+
+    for (int i = 1; i < argc; ++i)
+    {
+        CanLogReader reader{argv[i]};
+
+        if (reader.is_open())
+        {
+            for (const auto& record : reader)
+            {
+                print_record(record);
+            }
+        }
+        else
+        {
+            std::fprintf(stderr, "%s is not a CAN log file.\n", argv[i]);
+            result = 1;
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,82 @@
+/// \brief This example logs all frames of vcan0 and vcan1 for 10 seconds into
+/// the binary files /tmp/can.<n>.canlog, each holding one million frames, and
+/// prints how many frames were written and dropped. Export a file to candump
+/// format with: rosrun examples_bsw can_log_export /tmp/can.0.canlog
+/// Both interfaces must exist, see the vcan example for their setup.
+
+#include "CanLogger.h"
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+//! number of busses logged.
+static constexpr std::size_t BUSSES{2U};
+
+//! receive and writer threads run while this is true.
+static std::atomic< bool > running{true};
+
+//! the file all busses are logged to.
+static CanLogFile file{"/tmp/can", 1000000U, 8U};
+
+//! the pipeline from the receive threads to the writer.
+static CanLogger< BUSSES > logger{file};
+
+////////////////////////////////////////////////////////////////////////////////
+void receive_thread(const std::uint8_t channel, CanSocket& can) noexcept
+{
+    using namespace std::chrono_literals;
+    can.enable_timestamps();
+
+    while (running)
+    {
+        // the timeout lets the thread check for the end of the example.
+        logger.receive(channel, can, 100ms);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void writer_thread() noexcept
+{
+    using namespace std::chrono_literals;
+
+    while (running)
+    {
+        if (logger.write() == 0U)
+        {
+            // nothing queued: let the busses fill the queues again.
+            std::this_thread::sleep_for(1ms);
+        }
+    }
+
+    logger.write();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int main() noexcept
+{
+    if (file.is_open() == false)
+    {
+        std::cerr << "Opening the log file failed: " << file.get_last_error()
+                  << "\n";
+        return 1;
+    }
+
+    CanSocket can0{"vcan0"};
+    CanSocket can1{"vcan1"};
+    std::thread rx0{receive_thread, 0U, std::ref(can0)};
+    std::thread rx1{receive_thread, 1U, std::ref(can1)};
+    std::thread writer{writer_thread};
+
+    std::this_thread::sleep_for(std::chrono::seconds{10});
+    running = false;
+    rx0.join();
+    rx1.join();
+    writer.join();
+
+    std::cout << "frames written: " << file.records()
+              << ", files: " << (file.sequence() + 1U)
+              << ", dropped vcan0: " << logger.dropped(0U)
+              << ", dropped vcan1: " << logger.dropped(1U) << "\n";
+    return 0;
+}
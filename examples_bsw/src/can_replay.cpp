@@ -0,0 +1,48 @@
+/// \brief This example replays a CAN log file written by CanLogFile on vcan0
+/// with its recorded timing and prints how late the frames were sent, e.g.
+/// rosrun examples_bsw can_replay /tmp/can.0.canlog 1.0
+/// A speed of 10 replays ten times faster, 0 as fast as possible.
+
+#include "CanReplay.h"
+#include "TaskAttributes.h"
+#include <cstdlib>
+#include <iostream>
+#include <sys/mman.h>
+
+////////////////////////////////////////////////////////////////////////////////
+int main(int argc, char** argv) noexcept
+{
+    if (argc < 2)
+    {
+        std::cerr << "usage: can_replay <file.canlog> [speed]\n";
+        return 1;
+    }
+
+    CanLogReader reader{argv[1]};
+
+    if (reader.is_open() == false)
+    {
+        std::cerr << argv[1] << " is not a CAN log file.\n";
+        return 1;
+    }
+
+    CanSocket can{"vcan0"};
+    CanReplay replay{can};
+    replay.set_speed((argc > 2) ? std::atof(argv[2]) : 1.0);
+
+    // timing is only accurate without page faults and with a real-time
+    // priority.
+    mlockall(MCL_CURRENT | MCL_FUTURE);
+    TaskAttributes< SchedPolicy::FIFO >::apply_to_current(80, 0);
+
+    const bool complete = replay.play(reader);
+    const auto& lateness = replay.lateness();
+    std::cout << "frames: " << replay.frames_sent()
+              << ", batches: " << replay.batches_sent()
+              << (complete ? "" : " (incomplete)") << "\n"
+              << "lateness [ns] min: " << lateness.min()
+              << ", mean: " << lateness.mean()
+              << ", 99.9%: " << lateness.percentile(99.9)
+              << ", max: " << lateness.max() << "\n";
+    return complete ? 0 : 1;
+}
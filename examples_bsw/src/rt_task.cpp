@@ -51,7 +51,21 @@ bool MyRTTask::update() noexcept
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-void MyRTTask::post() noexcept {}
+void MyRTTask::post() noexcept
+{
+    // called once the task stops. The statistics may also be read from
+    // another thread while running.
+    const auto& wakeup = statistics().wakeup_latency();
+    const auto& execution = statistics().execution_time();
+    std::cout << "cycles: " << statistics().cycles() << "\n";
+    std::cout << "overruns: " << statistics().overruns() << "\n";
+    std::cout << "wakeup latency [ns] min: " << wakeup.min()
+              << " max: " << wakeup.max()
+              << " p99: " << wakeup.percentile(99.0) << "\n";
+    std::cout << "execution time [ns] min: " << execution.min()
+              << " max: " << execution.max()
+              << " p99: " << execution.percentile(99.0) << "\n";
+}
 
 ////////////////////////////////////////////////////////////////////////////////
 int main() noexcept
@@ -0,0 +1,82 @@
+/// \brief This example measures the latency of handing over timestamps from a
+/// producer to a consumer thread through the SpscQueue and prints min, median,
+/// percentiles and max. Pin it to two isolated cores for meaningful values,
+/// e.g. taskset -c 2,3 rosrun examples_bsw spsc_latency
+
+#include "SpscQueue.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+//! number of elements handed over.
+static constexpr std::size_t SAMPLES{1000000U};
+
+//! the queue between both threads.
+static SpscQueue< std::int64_t, 1024U > queue;
+
+//! the consumer is spinning and ready to receive.
+static std::atomic< bool > consumer_ready{false};
+
+////////////////////////////////////////////////////////////////////////////////
+static std::int64_t now_ns() noexcept
+{
+    using namespace std::chrono;
+    const auto now = steady_clock::now().time_since_epoch();
+    return duration_cast< nanoseconds >(now).count();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void consumer_thread(std::vector< std::int64_t >& latencies) noexcept
+{
+    consumer_ready = true;
+    std::int64_t sent_at{0};
+
+    for (std::size_t i = 0U; i < SAMPLES; ++i)
+    {
+        // busy waiting: the lowest latency possible.
+        while (queue.try_pop(sent_at) == false)
+        {
+        }
+
+        latencies[i] = now_ns() - sent_at;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int main() noexcept
+{
+    std::vector< std::int64_t > latencies(SAMPLES);
+    std::thread consumer(consumer_thread, std::ref(latencies));
+
+    while (consumer_ready == false)
+    {
+    }
+
+    for (std::size_t i = 0U; i < SAMPLES; ++i)
+    {
+        while (queue.try_push(now_ns()) == false)
+        {
+        }
+
+        // pace the producer a little, otherwise we measure a full queue.
+        const auto until = now_ns() + 200;
+        while (now_ns() < until)
+        {
+        }
+    }
+
+    consumer.join();
+    std::sort(latencies.begin(), latencies.end());
+
+    std::cout << "SpscQueue latency over " << SAMPLES << " samples [ns]\n";
+    std::cout << "min: " << latencies.front() << "\n";
+    std::cout << "median: " << latencies[SAMPLES / 2U] << "\n";
+    std::cout << "p99: " << latencies[(SAMPLES * 99U) / 100U] << "\n";
+    std::cout << "p99.99: " << latencies[(SAMPLES * 9999U) / 10000U] << "\n";
+    std::cout << "max: " << latencies.back() << "\n";
+    return EXIT_SUCCESS;
+}
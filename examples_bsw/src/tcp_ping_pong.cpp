@@ -6,6 +6,7 @@
 // It may contain bugs and unresolved connection errors, but it shows how one
 // can use the TCP client and server.
 
+#include "FramedStream.h" // Splits the TCP byte stream into messages.
 #include "TcpClient.h" // We need the header to create one TCP client object.
 #include "TcpServer.h" // We need the header to create the TCP server object.
 #include <array>
@@ -37,6 +38,8 @@ void server_thread() noexcept
         {
             // print the message layout how the received data is interpreted.
             std::cout << "Byte received | msg counter | user data\n";
+            // splits the byte stream into the messages sent.
+            FramedStream< 64U > stream;
 
             for (;;)
             {
@@ -47,15 +50,24 @@ void server_thread() noexcept
                     break;
                 }
 
-                std::array< std::uint8_t, 4U > data;
-                // Receive the messages from the client by using the data
-                // socket.
-                const std::uint16_t received =
-                    server.m_data.receive(&data, data.size());
+                // Receive as many bytes as available from the client by
+                // using the data socket. One receive may contain a part of a
+                // message or several messages.
+                const auto received = stream.fill(server.m_data);
 
-                if (received > 0U)
+                if ((received < 0) || stream.is_closed())
                 {
-                    std::cout << received << " | ";
+                    break;
+                }
+
+                Packet< 4U > packet;
+                std::uint16_t length{0U};
+
+                // take out all complete messages
+                while (stream.next(packet, length))
+                {
+                    const auto& data = packet.get_data();
+                    std::cout << length << " | ";
                     // print on the screen what has been received
                     std::uint16_t ctr = static_cast< std::uint16_t >(data[0]);
                     std::cout << std::hex << ctr << " | ";
@@ -99,7 +111,8 @@ int main(int argc, char** argv) noexcept
         for (auto i = 0U; i < 10U; ++i)
         {
             // we will send some test data to the server
-            std::array< std::uint8_t, 4U > data;
+            Packet< 4U > packet;
+            auto& data = packet.get_data();
             // a counter for all messages that have been sent
             data[0] = ctr;
             // user data means we need help at client side
@@ -108,7 +121,9 @@ int main(int argc, char** argv) noexcept
             data[3] = 'S';
 
             // send out some sample data that is going to be displayed.
-            const auto sent = client.send(&data, data.size());
+            // every message is prefixed with its length.
+            const auto sent =
+                FramedStream< 64U >::send(client, packet, data.size());
 
             if (sent < 0)
             {